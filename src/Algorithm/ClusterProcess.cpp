@@ -33,13 +33,10 @@ ClusterResult ClusterProcess::process(const SequenceWorkItem& item)
     ClusterNode node = cluster.addSeed(item.read.seq.toString(), true);
     assert(node.interval.isValid());
     // Check if this read is already part of a cluster. If so, return an empty result
-    for(int64_t i = node.interval.lower; i <= node.interval.upper; ++i)
+    if((int64_t)m_parameters.pMarkedReads->findNextSet(node.interval.lower) <= node.interval.upper)
     {
-        if(m_parameters.pMarkedReads->test(i))
-        {
-            ClusterResult result;
-            return result; // already part of a cluster, return nothing
-        }
+        ClusterResult result;
+        return result; // already part of a cluster, return nothing
     }
     
     // Add sequences to be used to stop extension, if requested
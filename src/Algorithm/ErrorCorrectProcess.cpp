@@ -13,6 +13,7 @@
 #include "multiple_alignment.h"
 #include "KmerOverlaps.h"
 #include "StringThreader.h"
+#include "Profiler.h"
 
 //#define KMER_TESTING 1
 //#define OVERLAPCORRECTION_VERBOSE 1
@@ -34,7 +35,10 @@ ErrorCorrectProcess::~ErrorCorrectProcess()
 //
 ErrorCorrectResult ErrorCorrectProcess::process(const SequenceWorkItem& workItem)
 {
+    PROFILE_FUNC("ErrorCorrectProcess::process")
     ErrorCorrectResult result = correct(workItem);
+    PROFILE_COUNT("ErrorCorrectProcess::kmerQCPassed", result.kmerQC ? 1 : 0);
+    PROFILE_COUNT("ErrorCorrectProcess::overlapQCPassed", result.overlapQC ? 1 : 0);
     if(!result.kmerQC && !result.overlapQC && m_params.printOverlaps)
         std::cout << workItem.read.id << " failed error correction QC\n";
     return result;
@@ -461,7 +465,7 @@ ErrorCorrectResult ErrorCorrectProcess::threadingCorrection(const SequenceWorkIt
     int seed_endpoint = k + right_index;
     printf("Correcting %s [%d %d]\n", query.c_str(), right_index, seed_endpoint);
     StringThreaderResultVector thread_results;
-    StringThreader threader(query.substr(0, seed_endpoint), &query, seed_endpoint, k, m_params.indices.pBWT);
+    StringThreader threader(query.substr(0, seed_endpoint), &query, seed_endpoint, k, m_params.indices.pBWT, &m_threaderArena);
     threader.run(thread_results);
 
     printf("Found %zu correction threads\n", thread_results.size());
@@ -19,6 +19,7 @@
 #include "BWTIndexSet.h"
 #include "SampledSuffixArray.h"
 #include "multiple_alignment.h"
+#include "Arena.h"
 
 enum ErrorCorrectAlgorithm
 {
@@ -99,6 +100,10 @@ class ErrorCorrectProcess
 
         OverlapBlockList m_blockList;
         ErrorCorrectParameters m_params;
+
+        // The nodes of the threading trees. Each tree returns its nodes
+        // when it is destroyed so the chunks are reused by the next read
+        Arena m_threaderArena;
 };
 
 // Write the results from the overlap step to an ASQG file
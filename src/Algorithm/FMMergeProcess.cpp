@@ -43,15 +43,7 @@ FMMergeResult FMMergeProcess::process(const SequenceWorkItem& item)
     assert(readInterval.isValid());
 
     // Check if this read has been used yet
-    bool used = false;
-    for(int64_t i = readInterval.lower; i <= readInterval.upper; ++i)
-    {
-        if(m_pMarkedReads->test(i))
-        {
-            used = true;
-            break;
-        }
-    }
+    bool used = (int64_t)m_pMarkedReads->findNextSet(readInterval.lower) <= readInterval.upper;
 
     FMMergeResult result;
 
@@ -9,6 +9,7 @@
 //
 #include "HaplotypeBuilder.h"
 #include "BWTAlgorithms.h"
+#include "DBGNavigator.h"
 #include "SGSearch.h"
 #include "SGAlgorithms.h"
 #include "Profiler.h"
@@ -77,6 +78,9 @@ HaplotypeBuilderReturnCode HaplotypeBuilder::run()
     size_t total_branches = 0;
     size_t iterations = 0;
 
+    // The reverse index is optional
+    DBGNavigator navigator(m_pBWT, m_pRevBWT);
+
     while(!m_queue.empty())
     {
         if(iterations > MAX_ITERATIONS || m_queue.size() > MAX_SIMULTANEOUS_BRANCHES || total_branches > MAX_TOTAL_BRANCHES)
@@ -88,11 +92,7 @@ HaplotypeBuilderReturnCode HaplotypeBuilder::run()
 
         // Calculate de Bruijn extensions for this node
         std::string vertStr = curr.pVertex->getSeq().toString();
-        AlphaCount64 extensionCounts;
-        if(m_pRevBWT != NULL)
-            extensionCounts = BWTAlgorithms::calculateDeBruijnExtensions(vertStr, m_pBWT, m_pRevBWT, curr.direction);
-        else
-            extensionCounts = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, m_pBWT, curr.direction);
+        AlphaCount64 extensionCounts = navigator.getExtensions(vertStr, curr.direction);
         
         size_t num_added = 0;
         for(size_t i = 0; i < DNA_ALPHABET::size; ++i)
@@ -88,18 +88,10 @@ SequenceOverlapPairVector KmerOverlaps::retrieveMatches(const std::string& query
                                                         int min_overlap, double min_identity,
                                                         int bandwidth, const BWTIndexSet& indices)
 {
-    PROFILE_FUNC("OverlapHaplotypeBuilder::retrieveMatches")
+    PROFILE_FUNC("KmerOverlaps::retrieveMatches")
     assert(indices.pBWT != NULL);
     assert(indices.pSSA != NULL);
 
-    static size_t n_calls = 0;
-    static size_t n_candidates = 0;
-    static size_t n_output = 0;
-    static double t_time = 0;
-    Timer timer("test", true);
-
-    n_calls++;
-
     int64_t max_interval_size = 200;
     SequenceOverlapPairVector overlap_vector;
     if(query.size() < k)
@@ -217,7 +209,6 @@ SequenceOverlapPairVector KmerOverlaps::retrieveMatches(const std::string& query
             overlap = Overlapper::extendMatch(query, match_sequence, pos_0, pos_1, bandwidth);
         }
 
-        n_candidates += 1;
         bool bPassedOverlap = overlap.getOverlapLength() >= min_overlap;
         bool bPassedIdentity = overlap.getPercentIdentity() / 100 >= min_identity;
 
@@ -230,15 +221,67 @@ SequenceOverlapPairVector KmerOverlaps::retrieveMatches(const std::string& query
             op.overlap = overlap;
             op.is_reversed = iter->is_reverse;
             overlap_vector.push_back(op);
-            n_output += 1;
         }
     }
 
-    t_time += timer.getElapsedCPUTime();
+    PROFILE_HISTOGRAM("KmerOverlaps::retrieveMatches::candidates", matches.size());
+    PROFILE_HISTOGRAM("KmerOverlaps::retrieveMatches::valid", overlap_vector.size());
+    return overlap_vector;
+}
 
-    if(Verbosity::Instance().getPrintLevel() > 6 && n_calls % 100 == 0)
-        printf("[kmer overlaps] n: %zu candidates: %zu valid: %zu (%.2lf) time: %.2lfs\n", 
-            n_calls, n_candidates, n_output, (double)n_output / n_candidates, t_time);
+//
+SequenceOverlapPairVector KmerOverlaps::retrieveMinimizerMatches(const std::string& query,
+                                                                 const MinimizerIndex& mzIndex,
+                                                                 const ReadTable* pTargets,
+                                                                 int min_hits,
+                                                                 size_t max_occurrence,
+                                                                 int min_overlap,
+                                                                 double min_identity,
+                                                                 int bandwidth)
+{
+    PROFILE_FUNC("KmerOverlaps::retrieveMinimizerMatches")
+    assert(pTargets != NULL);
+    assert(mzIndex.getNumReads() == pTargets->getCount());
+
+    SequenceOverlapPairVector overlap_vector;
+    MinimizerCandidateVector candidates;
+    mzIndex.findCandidates(query, min_hits, bandwidth, max_occurrence, candidates);
+
+    // Only the candidates that share a diagonal with the query are aligned.
+    // The shared minimizer anchors the banded extension so we never
+    // need to fall back to the O(M*N) overlapper
+    for(size_t i = 0; i < candidates.size(); ++i)
+    {
+        const MinimizerCandidate& candidate = candidates[i];
+        std::string match_sequence = pTargets->getRead(candidate.target_idx).seq.toString();
+        if(candidate.is_reverse)
+            match_sequence = reverseComplement(match_sequence);
+
+        // Ignore identical matches
+        if(match_sequence == query)
+            continue;
+
+        SequenceOverlap overlap = Overlapper::extendMatch(query, match_sequence, 
+                                                          candidate.query_position,
+                                                          candidate.target_position,
+                                                          bandwidth);
+
+        bool bPassedOverlap = overlap.getOverlapLength() >= min_overlap;
+        bool bPassedIdentity = overlap.getPercentIdentity() / 100 >= min_identity;
+
+        if(bPassedOverlap && bPassedIdentity)
+        {
+            SequenceOverlapPair op;
+            op.sequence[0] = query;
+            op.sequence[1] = match_sequence;
+            op.match_idx = candidate.target_idx;
+            op.overlap = overlap;
+            op.is_reversed = candidate.is_reverse;
+            overlap_vector.push_back(op);
+        }
+    }
+    PROFILE_HISTOGRAM("KmerOverlaps::retrieveMinimizerMatches::candidates", candidates.size());
+    PROFILE_HISTOGRAM("KmerOverlaps::retrieveMinimizerMatches::valid", overlap_vector.size());
     return overlap_vector;
 }
 
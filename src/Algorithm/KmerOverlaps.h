@@ -13,6 +13,7 @@
 #include "multiple_alignment.h"
 #include "BWTIndexSet.h"
 #include "SampledSuffixArray.h"
+#include "MinimizerIndex.h"
 
 // A pair of sequences and an overlap matching them
 struct SequenceOverlapPair
@@ -46,6 +47,18 @@ SequenceOverlapPairVector retrieveMatches(const std::string& query,
                                           int bandwidth,
                                           const BWTIndexSet& indices);
 
+// Retrieve matches to the query sequence using shared minimizers to select the
+// candidate reads from pTargets and the diagonal to extend the alignment along.
+// mzIndex must have been built from pTargets.
+SequenceOverlapPairVector retrieveMinimizerMatches(const std::string& query,
+                                                   const MinimizerIndex& mzIndex,
+                                                   const ReadTable* pTargets,
+                                                   int min_hits,
+                                                   size_t max_occurrence,
+                                                   int min_overlap,
+                                                   double min_identity,
+                                                   int bandwidth);
+
 SequenceOverlapPairVector approximateMatch(const std::string& query,
                                            int min_overlap, 
                                            double min_identity,
@@ -0,0 +1,370 @@
+//-----------------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------------
+//
+// MinimizerIndex - An index of the (w,k)-minimizers
+// of a collection of reads. Used to nominate
+// candidate overlapping reads, and the diagonal
+// they overlap on, before performing an alignment
+//
+#include <algorithm>
+#include <deque>
+#include "MinimizerIndex.h"
+#include "Util.h"
+#include "MurmurHash3.h"
+
+// Macros for binary I/O, as in SampledSuffixArray
+static const uint32_t MZI_MAGIC_NUMBER = 17744;
+#define MZI_READ(x) pReader->read(reinterpret_cast<char*>(&(x)), sizeof((x)));
+#define MZI_READ_N(x,n) pReader->read(reinterpret_cast<char*>(&(x)), (n));
+#define MZI_WRITE(x) pWriter->write(reinterpret_cast<const char*>(&(x)), sizeof((x)));
+#define MZI_WRITE_N(x,n) pWriter->write(reinterpret_cast<const char*>(&(x)), (n));
+
+// The largest k that fits in the 2-bit packed 64-bit words
+static const int MZI_MAX_K = 31;
+
+// 2-bit encoding of a base, or 4 for any non-ACGT symbol
+static inline int encodeBase(char b)
+{
+    switch(b)
+    {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        default: return 4;
+    }
+}
+
+// Invertible integer hash (Thomas Wang) restricted to the low 2k bits.
+// Hashing the k-mers avoids the poly-A bias of lexicographic minimizers
+static inline uint64_t hashKmer(uint64_t key, uint64_t mask)
+{
+    key = (~key + (key << 21)) & mask;
+    key = key ^ (key >> 24);
+    key = ((key + (key << 3)) + (key << 8)) & mask;
+    key = key ^ (key >> 14);
+    key = ((key + (key << 2)) + (key << 4)) & mask;
+    key = key ^ (key >> 28);
+    key = (key + (key << 31)) & mask;
+    return key;
+}
+
+// Compare two hits on the same target by strand, then diagonal
+struct MinimizerHit
+{
+    uint32_t target_idx;
+    bool is_reverse;
+    int diagonal;
+    int query_position;
+    int target_position;
+
+    friend bool operator<(const MinimizerHit& a, const MinimizerHit& b)
+    {
+        if(a.target_idx != b.target_idx)
+            return a.target_idx < b.target_idx;
+        if(a.is_reverse != b.is_reverse)
+            return a.is_reverse < b.is_reverse;
+        return a.diagonal < b.diagonal;
+    }
+};
+typedef std::vector<MinimizerHit> MinimizerHitVector;
+
+//
+MinimizerIndex::MinimizerIndex() : m_k(0), m_w(0), m_checksum(0)
+{
+
+}
+
+//
+void MinimizerIndex::computeMinimizers(const std::string& sequence, int k, int w, MinimizerVector& outMinimizers)
+{
+    assert(k > 0 && k <= MZI_MAX_K && w > 0);
+    outMinimizers.clear();
+
+    uint64_t mask = (1ULL << (2 * k)) - 1;
+    uint64_t rc_shift = 2 * (k - 1);
+    uint64_t fwd = 0;
+    uint64_t rev = 0;
+    int valid_length = 0;
+
+    // The k-mers in the current window, in order of position. The deque is kept
+    // increasing by hash so the front is always the minimum of the window
+    std::deque<Minimizer> window;
+    int window_count = 0; // number of k-mers seen since the last break
+    int last_output = -1;
+
+    for(size_t i = 0; i < sequence.size(); ++i)
+    {
+        int c = encodeBase(sequence[i]);
+        if(c > 3)
+        {
+            // Ambiguous base, restart the k-mer and the window. If the segment
+            // was too short to fill a window, output its smallest k-mer
+            if(window_count > 0 && window_count < w && !window.empty() && (int)window.front().position != last_output)
+            {
+                outMinimizers.push_back(window.front());
+                last_output = window.front().position;
+            }
+            valid_length = 0;
+            window_count = 0;
+            window.clear();
+            continue;
+        }
+
+        fwd = ((fwd << 2) | c) & mask;
+        rev = (rev >> 2) | ((uint64_t)(3 - c) << rc_shift);
+        if(++valid_length < k)
+            continue;
+
+        int position = i - k + 1;
+        window_count += 1;
+
+        // Skip palindromic k-mers, their strand is undefined
+        if(fwd != rev)
+        {
+            Minimizer m;
+            m.is_reverse = rev < fwd;
+            m.hash = hashKmer(m.is_reverse ? rev : fwd, mask);
+            m.position = position;
+
+            while(!window.empty() && window.back().hash > m.hash)
+                window.pop_back();
+            window.push_back(m);
+        }
+
+        // Evict k-mers that have left the window
+        while(!window.empty() && (int)window.front().position <= position - w)
+            window.pop_front();
+
+        if(window_count >= w && !window.empty() && (int)window.front().position != last_output)
+        {
+            outMinimizers.push_back(window.front());
+            last_output = window.front().position;
+        }
+    }
+
+    if(window_count > 0 && window_count < w && !window.empty() && (int)window.front().position != last_output)
+        outMinimizers.push_back(window.front());
+}
+
+//
+void MinimizerIndex::build(const ReadTable* pReads, int k, int w)
+{
+    if(k <= 0 || k > MZI_MAX_K || w <= 0)
+    {
+        std::cerr << "Error: invalid minimizer parameters k: " << k << " w: " << w << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    m_k = k;
+    m_w = w;
+    m_checksum = computeChecksum(pReads);
+    m_readLengths.clear();
+    m_entries.clear();
+
+    size_t num_reads = pReads->getCount();
+    m_readLengths.reserve(num_reads);
+
+    MinimizerVector minimizers;
+    for(size_t i = 0; i < num_reads; ++i)
+    {
+        std::string sequence = pReads->getRead(i).seq.toString();
+        m_readLengths.push_back(sequence.size());
+
+        computeMinimizers(sequence, k, w, minimizers);
+        for(size_t j = 0; j < minimizers.size(); ++j)
+        {
+            Entry e;
+            e.hash = minimizers[j].hash;
+            e.read_idx = i;
+            e.position = minimizers[j].position;
+            e.is_reverse = minimizers[j].is_reverse;
+            m_entries.push_back(e);
+        }
+    }
+
+    std::sort(m_entries.begin(), m_entries.end());
+}
+
+//
+uint64_t MinimizerIndex::computeChecksum(const ReadTable* pReads)
+{
+    uint64_t checksum = 0;
+    uint64_t h[2];
+    for(size_t i = 0; i < pReads->getCount(); ++i)
+    {
+        std::string sequence = pReads->getRead(i).seq.toString();
+        MurmurHash3_x64_128(sequence.data(), sequence.size(), 0, h);
+        checksum ^= h[0] + 0x9e3779b97f4a7c15ULL + (checksum << 6) + (checksum >> 2);
+    }
+    return checksum;
+}
+
+//
+void MinimizerIndex::findCandidates(const std::string& query,
+                                    int min_hits,
+                                    int bandwidth,
+                                    size_t max_occurrence,
+                                    MinimizerCandidateVector& outCandidates) const
+{
+    outCandidates.clear();
+    if((int)query.size() < m_k)
+        return;
+
+    MinimizerVector minimizers;
+    computeMinimizers(query, m_k, m_w, minimizers);
+
+    // Collect the positions of every indexed occurrence of the query minimizers
+    MinimizerHitVector hits;
+    for(size_t i = 0; i < minimizers.size(); ++i)
+    {
+        const Minimizer& m = minimizers[i];
+        Entry key;
+        key.hash = m.hash;
+        key.read_idx = 0;
+        key.position = 0;
+        key.is_reverse = 0;
+
+        EntryVector::const_iterator start = std::lower_bound(m_entries.begin(), m_entries.end(), key);
+        EntryVector::const_iterator end = start;
+        size_t count = 0;
+        while(end != m_entries.end() && end->hash == m.hash && count <= max_occurrence)
+        {
+            ++end;
+            ++count;
+        }
+
+        // Skip repetitive minimizers
+        if(count > max_occurrence)
+            continue;
+
+        for(EntryVector::const_iterator iter = start; iter != end; ++iter)
+        {
+            MinimizerHit hit;
+            hit.target_idx = iter->read_idx;
+            hit.is_reverse = (bool)iter->is_reverse != m.is_reverse;
+            hit.query_position = m.position;
+
+            // For opposite strand hits, project the target position onto
+            // the reverse complement of the target
+            if(hit.is_reverse)
+                hit.target_position = m_readLengths[iter->read_idx] - iter->position - m_k;
+            else
+                hit.target_position = iter->position;
+            hit.diagonal = hit.target_position - hit.query_position;
+            hits.push_back(hit);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end());
+
+    // For each (target, strand) pair find the largest set of hits
+    // whose diagonals are all within bandwidth of each other
+    size_t group_start = 0;
+    while(group_start < hits.size())
+    {
+        size_t group_end = group_start + 1;
+        while(group_end < hits.size() &&
+              hits[group_end].target_idx == hits[group_start].target_idx &&
+              hits[group_end].is_reverse == hits[group_start].is_reverse)
+            ++group_end;
+
+        if((int)(group_end - group_start) >= min_hits)
+        {
+            size_t best_start = group_start;
+            size_t best_count = 0;
+            size_t left = group_start;
+            for(size_t right = group_start; right < group_end; ++right)
+            {
+                while(hits[right].diagonal - hits[left].diagonal > bandwidth)
+                    ++left;
+                if(right - left + 1 > best_count)
+                {
+                    best_count = right - left + 1;
+                    best_start = left;
+                }
+            }
+
+            if((int)best_count >= min_hits)
+            {
+                // Anchor the alignment at the median diagonal of the cluster
+                const MinimizerHit& anchor = hits[best_start + best_count / 2];
+                MinimizerCandidate candidate;
+                candidate.target_idx = anchor.target_idx;
+                candidate.is_reverse = anchor.is_reverse;
+                candidate.query_position = anchor.query_position;
+                candidate.target_position = anchor.target_position;
+                candidate.num_hits = best_count;
+                outCandidates.push_back(candidate);
+            }
+        }
+        group_start = group_end;
+    }
+}
+
+//
+void MinimizerIndex::printInfo() const
+{
+    printf("MinimizerIndex info:\n");
+    printf("k: %d w: %d\n", m_k, m_w);
+    printf("Number of reads: %zu\n", m_readLengths.size());
+    printf("Number of minimizers: %zu\n", m_entries.size());
+    printf("Total size: %.2lf MB\n", (double)(m_entries.size() * sizeof(Entry) + m_readLengths.size() * sizeof(uint32_t)) / (1024 * 1024));
+}
+
+//
+void MinimizerIndex::write(const std::string& filename) const
+{
+    std::ostream* pWriter = createWriter(filename, std::ios::out | std::ios::binary);
+
+    MZI_WRITE(MZI_MAGIC_NUMBER)
+    MZI_WRITE(m_k)
+    MZI_WRITE(m_w)
+    MZI_WRITE(m_checksum)
+
+    size_t n = m_readLengths.size();
+    MZI_WRITE(n)
+    if(n > 0)
+        MZI_WRITE_N(m_readLengths.front(), sizeof(uint32_t) * n)
+
+    n = m_entries.size();
+    MZI_WRITE(n)
+    if(n > 0)
+        MZI_WRITE_N(m_entries.front(), sizeof(Entry) * n)
+
+    delete pWriter;
+}
+
+//
+void MinimizerIndex::read(const std::string& filename)
+{
+    std::istream* pReader = createReader(filename, std::ios::binary);
+
+    uint32_t magic = 0;
+    MZI_READ(magic)
+    if(magic != MZI_MAGIC_NUMBER)
+    {
+        std::cerr << "Error: " << filename << " is not a minimizer index or was written by an older version. Remove it to rebuild the index\n";
+        exit(EXIT_FAILURE);
+    }
+
+    MZI_READ(m_k)
+    MZI_READ(m_w)
+    MZI_READ(m_checksum)
+
+    size_t n = 0;
+    MZI_READ(n)
+    m_readLengths.resize(n);
+    if(n > 0)
+        MZI_READ_N(m_readLengths.front(), sizeof(uint32_t) * n)
+
+    MZI_READ(n)
+    m_entries.resize(n);
+    if(n > 0)
+        MZI_READ_N(m_entries.front(), sizeof(Entry) * n)
+
+    delete pReader;
+}
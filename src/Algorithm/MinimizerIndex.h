@@ -0,0 +1,112 @@
+//-----------------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------------
+//
+// MinimizerIndex - An index of the (w,k)-minimizers
+// of a collection of reads. Used to nominate
+// candidate overlapping reads, and the diagonal
+// they overlap on, before performing an alignment
+//
+#ifndef MINIMIZER_INDEX_H
+#define MINIMIZER_INDEX_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "ReadTable.h"
+
+// A minimizer of a sequence. The hash is computed
+// from the canonical k-mer and is_reverse indicates
+// whether the canonical k-mer is the reverse complement
+// of the k-mer at position in the sequence.
+struct Minimizer
+{
+    uint64_t hash;
+    uint32_t position;
+    bool is_reverse;
+};
+typedef std::vector<Minimizer> MinimizerVector;
+
+// A read that shares minimizers with a query sequence
+// on a consistent diagonal. The query and target positions
+// give one of the shared k-mers, with the target position
+// given on the strand of the target that matches the query
+struct MinimizerCandidate
+{
+    size_t target_idx;
+    bool is_reverse;
+    int query_position;
+    int target_position;
+    int num_hits;
+};
+typedef std::vector<MinimizerCandidate> MinimizerCandidateVector;
+
+class MinimizerIndex
+{
+    public:
+
+        MinimizerIndex();
+
+        // Build the index from all the reads in the table
+        void build(const ReadTable* pReads, int k, int w);
+
+        // Find the reads that share at least min_hits minimizers with the query
+        // on diagonals that are within bandwidth of each other. Minimizers occurring
+        // more than max_occurrence times in the index are ignored. The candidates
+        // are returned sorted by target index and strand.
+        void findCandidates(const std::string& query,
+                            int min_hits,
+                            int bandwidth,
+                            size_t max_occurrence,
+                            MinimizerCandidateVector& outCandidates) const;
+
+        // Compute the (w,k)-minimizers of a sequence
+        static void computeMinimizers(const std::string& sequence, int k, int w, MinimizerVector& outMinimizers);
+
+        // Compute a checksum of the sequences in the table, in order. This
+        // is stored in the index to detect an index built from a different read set
+        static uint64_t computeChecksum(const ReadTable* pReads);
+
+        //
+        int getK() const { return m_k; }
+        int getW() const { return m_w; }
+        size_t getNumReads() const { return m_readLengths.size(); }
+        uint64_t getChecksum() const { return m_checksum; }
+        void printInfo() const;
+
+        // I/O
+        void write(const std::string& filename) const;
+        void read(const std::string& filename);
+
+    private:
+
+        // An occurrence of a minimizer in the indexed reads
+        struct Entry
+        {
+            uint64_t hash;
+            uint32_t read_idx;
+            uint32_t position:31;
+            uint32_t is_reverse:1;
+
+            friend bool operator<(const Entry& a, const Entry& b)
+            {
+                if(a.hash != b.hash)
+                    return a.hash < b.hash;
+                if(a.read_idx != b.read_idx)
+                    return a.read_idx < b.read_idx;
+                return a.position < b.position;
+            }
+        };
+        typedef std::vector<Entry> EntryVector;
+
+        // Data
+        int m_k;
+        int m_w;
+        uint64_t m_checksum;
+        std::vector<uint32_t> m_readLengths;
+        EntryVector m_entries; // sorted by hash
+};
+
+#endif
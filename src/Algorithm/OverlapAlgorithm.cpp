@@ -5,6 +5,7 @@
 //-----------------------------------------------
 #include "OverlapAlgorithm.h"
 #include "ASQG.h"
+#include "Profiler.h"
 #include <math.h>
 
 // Collect the complete set of overlaps in pOBOut
@@ -18,14 +19,20 @@ static const AlignFlags preSufAF(true, true, false);
 // Perform the overlap
 OverlapResult OverlapAlgorithm::overlapRead(const SeqRecord& read, int minOverlap, OverlapBlockList* pOutList) const
 {
+    PROFILE_FUNC("OverlapAlgorithm::overlapRead")
     OverlapResult r;
     if(static_cast<int>(read.seq.length()) < minOverlap)
         return r;
 
+    size_t initialBlocks = pOutList->size();
     if(!m_exactModeOverlap)
         r = overlapReadInexact(read, minOverlap, pOutList);
     else
         r = overlapReadExact(read, minOverlap, pOutList);
+
+    PROFILE_HISTOGRAM("OverlapAlgorithm::blocksPerRead", pOutList->size() - initialBlocks);
+    PROFILE_COUNT("OverlapAlgorithm::substringReads", r.isSubstring ? 1 : 0);
+    PROFILE_COUNT("OverlapAlgorithm::abortedSearches", r.searchAborted ? 1 : 0);
     return r;
 }
 
@@ -105,7 +105,7 @@ void StringGraphGenerator::buildGraph(FrontierQueue& queue)
 SGWalkVector StringGraphGenerator::searchWalks()
 {
     SGWalkVector walks;
-    SGSearch::findWalks(m_pStartVertex, m_pEndVertex, m_startDir, m_maxDistance, true, 10000, walks);
+    SGSearch::findWalks(m_pStartVertex, m_pEndVertex, m_startDir, m_maxDistance, 10000, true, walks);
     return walks;
 }
 
@@ -158,7 +158,10 @@ void StringGraphGenerator::updateGraphAndQueue(GraphFrontier& currNode, Frontier
         }
 
         // Construct the found edge
+        // No edge is created for substring containments
         Edge* pXY = SGAlgorithms::createEdgesFromOverlap(m_pGraph, o, true);
+        if(pXY == NULL)
+            continue;
 
         // If the endpoint vertex is unexplored, queue it
         if(pVertex->getColor() == UNEXPLORED_COLOR)
@@ -190,6 +193,7 @@ Vertex* StringGraphGenerator::addTerminalVertex(const SeqRecord& record)
     {
         if(matchIter->numDiff == 0 && !matchIter->flags.isQueryRev())
             break; // this block corresponds to the actual sequence of endRead
+        ++matchIter;
     }
     assert(matchIter != endBlockList.end());
     
@@ -15,6 +15,7 @@
 #include "BWTAlgorithms.h"
 #include "LRAlignment.h"
 #include "StdAlnTools.h"
+#include <algorithm>
 
 //
 // StringThreaderNode
@@ -30,7 +31,7 @@ StringThreaderNode::StringThreaderNode(const std::string* pQuery,
 StringThreaderNode::~StringThreaderNode()
 {
     // Delete children
-    for(STNodePtrList::iterator iter = m_children.begin(); iter != m_children.end(); ++iter)
+    for(STNodePtrVector::iterator iter = m_children.begin(); iter != m_children.end(); ++iter)
         delete *iter;
 
     // Delete alignment columns
@@ -38,18 +39,22 @@ StringThreaderNode::~StringThreaderNode()
         delete m_alignmentColumns[i];
 }
 
-// Return a suffix of length l of the path from the root to this node
-std::string StringThreaderNode::getSuffix(size_t l) const
+// Write the suffix of length l of the path from the root to this node
+// into out. The labels are copied walking up the tree, from the end of
+// the suffix to its start, so no temporaries are created.
+void StringThreaderNode::getSuffix(size_t l, std::string& out) const
 {
-    size_t n = m_label.size();
-    if(l <= n)
+    out.resize(l);
+    size_t remaining = l;
+    const StringThreaderNode* pNode = this;
+    while(remaining > 0)
     {
-        return m_label.substr(n - l, l);
-    }
-    else 
-    {
-        assert(m_pParent != NULL);
-        return m_pParent->getSuffix(l - n) + m_label;
+        assert(pNode != NULL);
+        size_t n = pNode->m_label.size();
+        size_t c = n < remaining ? n : remaining;
+        remaining -= c;
+        pNode->m_label.copy(&out[remaining], c, n - c);
+        pNode = pNode->m_pParent;
     }
 }
 
@@ -63,9 +68,9 @@ std::string StringThreaderNode::getFullString() const
 }
 
 // Create a new child node with the given label. Returns a pointer to the new node.
-StringThreaderNode* StringThreaderNode::createChild(const std::string& label)
+StringThreaderNode* StringThreaderNode::createChild(const std::string& label, Arena* pArena)
 {
-    StringThreaderNode* pAdded = new StringThreaderNode(m_pQuery, this);
+    StringThreaderNode* pAdded = new(pArena) StringThreaderNode(m_pQuery, this);
     m_children.push_back(pAdded);
 
     assert(!m_alignmentColumns.empty());
@@ -155,7 +160,7 @@ void StringThreaderNode::printAllStrings(const std::string& parent) const
     }
     else
     {
-        for(STNodePtrList::const_iterator iter = m_children.begin(); iter != m_children.end(); ++iter)
+        for(STNodePtrVector::const_iterator iter = m_children.begin(); iter != m_children.end(); ++iter)
             (*iter)->printAllStrings(parent + m_label);
     }
 }
@@ -167,10 +172,17 @@ StringThreader::StringThreader(const std::string& seed,
                                const std::string* pQuery,
                                int queryAlignmentEnd,
                                int kmer, 
-                               const BWT* pBWT) : m_pBWT(pBWT), m_kmer(kmer), m_pQuery(pQuery)
+                               const BWT* pBWT,
+                               Arena* pArena,
+                               size_t maxLeaves) : m_pBWT(pBWT), 
+                                                   m_kmer(kmer), 
+                                                   m_pQuery(pQuery), 
+                                                   m_maxLeaves(maxLeaves),
+                                                   m_pArena(pArena),
+                                                   m_navigator(pBWT)
 {
     // Create the root node containing the seed string
-    m_pRootNode = new StringThreaderNode(pQuery, NULL);
+    m_pRootNode = new(m_pArena) StringThreaderNode(pQuery, NULL);
     m_pRootNode->computeInitialAlignment(seed, queryAlignmentEnd, 50);
     m_leaves.push_back(m_pRootNode);
 }
@@ -178,7 +190,7 @@ StringThreader::StringThreader(const std::string& seed,
 //
 StringThreader::~StringThreader()
 {
-    // Recursively destroy the tree
+    // Recursively destroy the tree, which returns the nodes to the arena
     delete m_pRootNode;
 }
 
@@ -190,6 +202,7 @@ void StringThreader::run(StringThreaderResultVector& results)
     {
         extendLeaves();
         cullLeavesByEdits();
+        cullLeavesByRank();
         checkTerminated(results);
     }
 }
@@ -201,13 +214,19 @@ void StringThreader::printAll()
     m_pRootNode->printAllStrings("");
 }
 
-// Extend each leaf node
+// Extend each leaf node. Leaves that end in the same (k-1)-mer
+// are looked up one at a time but share the memoized node
+// of the navigator.
 void StringThreader::extendLeaves()
 {
-    STNodePtrList newLeaves;
-    for(STNodePtrList::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
+    m_newLeaves.clear();
+    std::string label(1, 'A');
+    for(size_t i = 0; i < m_leaves.size(); ++i)
     {
-        StringVector extensions = getDeBruijnExtensions(*iter);
+        StringThreaderNode* pLeaf = m_leaves[i];
+        pLeaf->getSuffix(m_kmer - 1, m_leafSuffix);
+        getDeBruijnExtensions(m_leafSuffix, m_leafExtensions);
+        const std::string& extensions = m_leafExtensions;
 
         // Either extend the current node or branch it
         // If no extension, do nothing and this node
@@ -215,22 +234,23 @@ void StringThreader::extendLeaves()
         if(extensions.size() == 1)
         {
             // Single extension, do not branch
-            (*iter)->extend(extensions.front());
-            newLeaves.push_back(*iter);
+            label[0] = extensions[0];
+            pLeaf->extend(label);
+            m_newLeaves.push_back(pLeaf);
         }
         else if(extensions.size() > 1)
         {
             // Branch
-            for(size_t i = 0; i < extensions.size(); ++i)
+            for(size_t j = 0; j < extensions.size(); ++j)
             {
-                StringThreaderNode* pAdded = (*iter)->createChild(extensions[i]);
-                newLeaves.push_back(pAdded);
+                label[0] = extensions[j];
+                StringThreaderNode* pAdded = pLeaf->createChild(label, m_pArena);
+                m_newLeaves.push_back(pAdded);
             }
         }
     }
 
-    m_leaves.clear();
-    m_leaves = newLeaves;
+    m_leaves.swap(m_newLeaves);
 }
 
 // Remove leaves that are have a high local error rate
@@ -238,14 +258,14 @@ void StringThreader::extendLeaves()
 // the query sequence.
 void StringThreader::cullLeavesByLocalError()
 {
-    STNodePtrList newLeaves;
+    STNodePtrVector newLeaves;
 
     int context = 20;
     double threshold = 0.3f;
 
     // Calculate the local error rate of the alignments to each new leaf
     // If it is less than threshold, add the leaf to the node
-    for(STNodePtrList::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
+    for(STNodePtrVector::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
     {
         double ler = (*iter)->getLocalErrorRate(context);
 
@@ -259,13 +279,13 @@ void StringThreader::cullLeavesByLocalError()
 // the best leaf
 void StringThreader::cullLeavesByEdits()
 {
-    STNodePtrList newLeaves;
+    STNodePtrVector newLeaves;
 
     // Calculate the local error rate of the alignments to each new leaf
     // If it is less than threshold, add the leaf to the node
     int bestEdits = std::numeric_limits<int>::max();
     IntVector editsVector;
-    for(STNodePtrList::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
+    for(STNodePtrVector::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
     {
         int edits = (*iter)->getEditDistance();
         if(edits < bestEdits)
@@ -275,7 +295,7 @@ void StringThreader::cullLeavesByEdits()
 
     int leafID = 0;
     int threshold = 1;
-    for(STNodePtrList::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
+    for(STNodePtrVector::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
     {
         if(editsVector[leafID] <= bestEdits + threshold)
             newLeaves.push_back(*iter);
@@ -285,12 +305,40 @@ void StringThreader::cullLeavesByEdits()
     m_leaves = newLeaves;
 }
 
+// If the frontier is larger than the maximum size, keep the
+// leaves with the lowest edit distance. Ties are broken by
+// the order of the leaves so the culling is deterministic.
+void StringThreader::cullLeavesByRank()
+{
+    if(m_leaves.size() <= m_maxLeaves)
+        return;
+
+    std::vector<std::pair<int, size_t> > ranks(m_leaves.size());
+    for(size_t i = 0; i < m_leaves.size(); ++i)
+        ranks[i] = std::make_pair(m_leaves[i]->getEditDistance(), i);
+    std::sort(ranks.begin(), ranks.end());
+
+    // Keep the selected leaves in their original order
+    std::vector<bool> keep(m_leaves.size(), false);
+    for(size_t i = 0; i < m_maxLeaves; ++i)
+        keep[ranks[i].second] = true;
+
+    STNodePtrVector newLeaves;
+    newLeaves.reserve(m_maxLeaves);
+    for(size_t i = 0; i < m_leaves.size(); ++i)
+    {
+        if(keep[i])
+            newLeaves.push_back(m_leaves[i]);
+    }
+    m_leaves.swap(newLeaves);
+}
+
 // Check for leaves whose extension has terminated. If the leaf has
 // terminated, its alignment result is pushed to the result vector
 void StringThreader::checkTerminated(StringThreaderResultVector& results)
 {
-    STNodePtrList newLeaves;
-    for(STNodePtrList::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
+    STNodePtrVector newLeaves;
+    for(STNodePtrVector::iterator iter = m_leaves.begin(); iter != m_leaves.end(); ++iter)
     {
         if((*iter)->hasExtensionTerminated())
             results.push_back((*iter)->getAlignment());
@@ -300,32 +348,21 @@ void StringThreader::checkTerminated(StringThreaderResultVector& results)
     m_leaves = newLeaves;
 }
 
-// Calculate the successors of this node in the implicit deBruijn graph
-StringVector StringThreader::getDeBruijnExtensions(StringThreaderNode* pNode)
+// Calculate the successors of the string ending in pmer in the implicit deBruijn graph
+void StringThreader::getDeBruijnExtensions(const std::string& pmer, std::string& out)
 {
-    // Get the last k-1 bases of the node
-    std::string pmer = pNode->getSuffix(m_kmer - 1);
-    AlphaCount64 extensions = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(pmer, m_pBWT, ED_SENSE, NULL);
+    AlphaCount64 extensions = m_navigator.getExtensions(pmer, ED_SENSE);
 
     // Loop over the DNA symbols, if there is are more than two characters create a branch
     // otherwise just perform an extension.
-    bool hasExtension = extensions.hasDNAChar();
-
-    StringVector out;
-    if(hasExtension)
+    out.clear();
+    if(extensions.hasDNAChar())
     {
         for(int i = 0; i < DNA_ALPHABET::size; ++i)
         {
             char b = DNA_ALPHABET::getBase(i);
             if(extensions.get(b) >= 3)
-            {
-                // extend to b
-                std::string tmp;
-                tmp.append(1,b);
-                out.push_back(tmp);
-            }
+                out.push_back(b);
         }
     }
-
-    return out;
 }
@@ -14,13 +14,15 @@
 #ifndef STRING_THREADER_H
 #define STRING_THREADER_H
 
-#include <list>
+#include <vector>
 #include "BWT.h"
 #include "ExtensionDP.h"
+#include "DBGNavigator.h"
+#include "Arena.h"
 
 // Typedefs
 class StringThreaderNode;
-typedef std::list<StringThreaderNode*> STNodePtrList;
+typedef std::vector<StringThreaderNode*> STNodePtrVector;
 
 // Object to hold the result of the threading process
 struct StringThreaderResult
@@ -41,15 +43,15 @@ class StringThreaderNode
         StringThreaderNode(const std::string* pQuery, StringThreaderNode* parent);
         ~StringThreaderNode();
       
-        // Add a child node to this node with the given label
+        // Add a child node to this node with the given label, allocated from pArena
         // Returns a pointer to the created node
-        StringThreaderNode* createChild(const std::string& label);
+        StringThreaderNode* createChild(const std::string& label, Arena* pArena);
 
         // Extend the label of this node by l
         void extend(const std::string& ext);
         
-        // Return a suffix of length l of the string represented by this node
-        std::string getSuffix(size_t l) const;
+        // Write the suffix of length l of the string represented by this node into out
+        void getSuffix(size_t l, std::string& out) const;
 
         // Return the complete sequence of the string represented by the branch
         std::string getFullString() const;
@@ -77,6 +79,23 @@ class StringThreaderNode
         // by this node and all its children.
         void printAllStrings(const std::string& parent) const;
 
+        // Memory management
+        // The nodes of a tree are allocated from the arena of its threader
+        void* operator new(size_t size, Arena* pArena)
+        {
+            return pArena->alloc(size);
+        }
+
+        // Called if the constructor throws
+        void operator delete(void* target, Arena* /*pArena*/)
+        {
+            Arena::dealloc(target);
+        }
+
+        void operator delete(void* target)
+        {
+            Arena::dealloc(target);
+        }
 
     private:
         
@@ -92,7 +111,7 @@ class StringThreaderNode
 
         // The parent node, can be NULL
         StringThreaderNode* m_pParent;
-        STNodePtrList m_children;
+        STNodePtrVector m_children;
 
         // Alignment information between the label of this node and the query sequence
         // One column per label base
@@ -110,7 +129,9 @@ class StringThreader
                        const std::string* pQuery,
                        int queryAlignmentEnd,
                        int kmer,
-                       const BWT* pBWT);
+                       const BWT* pBWT,
+                       Arena* pArena,
+                       size_t maxLeaves = 256);
 
         ~StringThreader();
 
@@ -131,13 +152,17 @@ class StringThreader
         // Leaf removal heuristics
         void cullLeavesByLocalError();
         void cullLeavesByEdits();
+
+        // Keep only the maxLeaves leaves with the lowest edit distance
+        void cullLeavesByRank();
         
         // Check if the leaves can be extended no further
         // If so, the best alignment is pushed to results
         void checkTerminated(StringThreaderResultVector& results);
 
-        // Calculate the successors of this node in the implicit deBruijn graph
-        StringVector getDeBruijnExtensions(StringThreaderNode* pNode);
+        // Calculate the successors of the string ending in pmer in the
+        // implicit deBruijn graph. The bases are written to out.
+        void getDeBruijnExtensions(const std::string& pmer, std::string& out);
         
         //
         // Data
@@ -145,8 +170,22 @@ class StringThreader
         const BWT* m_pBWT; 
         int m_kmer;
         const std::string* m_pQuery;
+        size_t m_maxLeaves;
         StringThreaderNode* m_pRootNode;
-        STNodePtrList m_leaves;
+        STNodePtrVector m_leaves;
+
+        // The nodes of the tree are allocated from this arena, which
+        // is owned by the caller so it can be reused between threaders
+        Arena* m_pArena;
+
+        // Scratch space reused by each round of extension
+        STNodePtrVector m_newLeaves;
+        std::string m_leafSuffix;
+        std::string m_leafExtensions;
+
+        // Branches of the search share most of their suffixes
+        // so the graph nodes are memoized for the whole search
+        DBGNavigator m_navigator;
 };
 
 #endif
@@ -19,9 +19,8 @@
 //
 Bigraph::Bigraph() : m_hasContainment(false), m_hasTransitive(false), m_isExactMode(false), m_minOverlap(0), m_errorRate(0.0f)
 {
-    // Set up the memory pools for the graph
-    m_pEdgeAllocator = new SimpleAllocator<Edge>();
-    m_pVertexAllocator = new SimpleAllocator<Vertex>();
+    // Set up the memory pool for the graph
+    m_pArena = new Arena();
 
     m_vertices.set_deleted_key("");
     //WARN_ONCE("HARDCODED HASH TABLE MAX SIZE");
@@ -40,9 +39,8 @@ Bigraph::~Bigraph()
         iter->second = NULL;
     }
 
-    // Clean up the memory pools
-    delete m_pEdgeAllocator;
-    delete m_pVertexAllocator;
+    // Clean up the memory pool
+    delete m_pArena;
 }
 
 //
@@ -667,6 +665,7 @@ void Bigraph::printMemSize() const
     printf("num verts: %zu using %zu bytes (%.2lf per vert)\n", numVerts, vertMem, double(vertMem) / numVerts);
     printf("num edges: %zu using %zu bytes (%.2lf per edge)\n", numEdges, edgeMem, double(edgeMem) / numEdges);
     printf("total: %zu\n", edgeMem + vertMem);
+    m_pArena->printStats();
 }
 
 //
@@ -169,10 +169,10 @@ class Bigraph
         void writeASQG(const std::string& filename) const;
 
         // Returns an allocator for the edges of the graph
-        SimpleAllocator<Edge>* getEdgeAllocator() { return m_pEdgeAllocator; }
+        Arena* getEdgeAllocator() { return m_pArena; }
 
         // Returns an allocator for the vertices of the graph
-        SimpleAllocator<Vertex>* getVertexAllocator() { return m_pVertexAllocator; }
+        Arena* getVertexAllocator() { return m_pArena; }
 
         // Return a string for a color code
         static std::string getColorString(GraphColor c);
@@ -198,8 +198,8 @@ class Bigraph
         double m_errorRate;
 
         // Memory management
-        SimpleAllocator<Vertex>* m_pVertexAllocator;
-        SimpleAllocator<Edge>* m_pEdgeAllocator;
+        // The vertices and edges share a single arena
+        Arena* m_pArena;
 };
 
 #endif
@@ -17,7 +17,7 @@
 #include "EdgeDesc.h"
 #include "Vertex.h"
 #include "BitChar.h"
-#include "SimpleAllocator.h"
+#include "Arena.h"
 
 // Packed structure holding the direction and comp of an edge
 // The EdgeDir/EdgeComp enums (which only have values 0/1) are used 
@@ -136,16 +136,24 @@ class Edge
         void flip() { flipComp(); flipDir(); }
 
         // Memory management
-        void* operator new(size_t /*size*/, SimpleAllocator<Edge>* pAllocator)
+        // All the edges of a graph are allocated from its arena.
+        // Deleted edges are returned to the arena for reuse, so an
+        // edge no longer lives as long as its graph. The twin of a
+        // deleted edge must be deleted or relinked before it is used.
+        void* operator new(size_t size, Arena* pArena)
         {
-            return pAllocator->alloc();
+            return pArena->alloc(size);
         }
 
-        void operator delete(void* /*target*/, size_t /*size*/)
+        // Called if the constructor throws
+        void operator delete(void* target, Arena* /*pArena*/)
         {
-            // Deletions are handled at the graph/pool level. The lifetime of an edge
-            // is as long as the graph it belongs to, even if it is deleted before
-            // the graph.
+            Arena::dealloc(target);
+        }
+
+        void operator delete(void* target)
+        {
+            Arena::dealloc(target);
         }
 
         // Validate that the edge is sane
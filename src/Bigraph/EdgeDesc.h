@@ -31,4 +31,15 @@ struct EdgeDesc
     friend std::ostream& operator<<(std::ostream& out, const EdgeDesc& ed);
 };
 
+// Hash an edge description by the address of its vertex. This avoids
+// hashing the vertex ID as a vertex is unique within a graph.
+struct EdgeDescHasher
+{
+    size_t operator()(const EdgeDesc& ed) const
+    {
+        size_t h = reinterpret_cast<size_t>(ed.pVertex) >> 4;
+        return (h << 2) ^ (ed.dir << 1) ^ ed.comp;
+    }
+};
+
 #endif
@@ -241,7 +241,15 @@ void Vertex::deleteEdges()
 }
 
 // Delete edges that are marked
-// This only deletes the edge and not its twin
+// This only deletes the edge and not its twin.
+// The deleted edges go back to the graph's arena and may be reused
+// by the next allocation, so until the twin's vertex is swept the twin
+// points to a freed edge. This is safe because the sweep only reads
+// the colour of the edges of the vertex being swept and every caller
+// (Bigraph::sweepEdges via the transitive reduction, duplicate edge and
+// overlap ratio visitors) marks an edge and its twin together, so the
+// twins are deleted in the same pass. Marking only one side of a pair
+// would leave the survivor with a dangling twin pointer.
 int Vertex::sweepEdges(GraphColor c)
 {
     int numRemoved = 0;
@@ -21,7 +21,7 @@
 #include "GraphCommon.h"
 #include "QualityVector.h"
 #include "EncodedString.h"
-#include "SimpleAllocator.h"
+#include "Arena.h"
 #include "EdgeDesc.h"
 #include "MultiOverlap.h"
 
@@ -63,6 +63,14 @@ class Vertex
                                                     m_coverage(1),
                                                     m_isContained(false),
                                                     m_isSuperRepeat(false) {}
+
+        // Store the sequence in pArena if it is too long to be held in the vertex
+        Vertex(VertexID id, const std::string& s, Arena* pArena) : m_id(id), 
+                                                                   m_seq(s, pArena), 
+                                                                   m_color(GC_WHITE),
+                                                                   m_coverage(1),
+                                                                   m_isContained(false),
+                                                                   m_isSuperRepeat(false) {}
         ~Vertex();
 
         // High-level modification functions
@@ -132,16 +140,23 @@ class Vertex
         uint16_t getCoverage() const { return m_coverage; }
 
         // Memory management
-        void* operator new(size_t /*size*/, SimpleAllocator<Vertex>* pAllocator)
+        // All the vertices of a graph are allocated from its arena.
+        // Deleted vertices are returned to the arena for reuse, so
+        // a vertex must not be accessed once it has been deleted.
+        void* operator new(size_t size, Arena* pArena)
+        {
+            return pArena->alloc(size);
+        }
+
+        // Called if the constructor throws
+        void operator delete(void* target, Arena* /*pArena*/)
         {
-            return pAllocator->alloc();
+            Arena::dealloc(target);
         }
 
-        void operator delete(void* /*target*/, size_t /*size*/)
+        void operator delete(void* target)
         {
-            // delete does nothing since all allocations go through the memory pool
-            // belonging to the graph. The memory allocated for the vertex will be
-            // cleaned up when the graph is destroyed.
+            Arena::dealloc(target);
         }
 
         // Output edges in graphviz format
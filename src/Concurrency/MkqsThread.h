@@ -6,68 +6,160 @@
 //
 // Implementation of a multikey quicksort worker thread
 //
+// Each worker owns a deque of sort jobs. A worker
+// takes the most recently created job from its own deque,
+// which is the smallest and most likely to be in cache,
+// and when its deque is empty it steals the oldest,
+// and largest, job from another worker.
+//
 #include <pthread.h>
-#include <semaphore.h>
+#include <sched.h>
+#include <deque>
+#include <vector>
 #include "mkqs.h"
 
-// 
+//
 template<typename T>
 struct MkqsJob
 {
+    MkqsJob() : pData(NULL), n(0), depth(0) {}
     MkqsJob(T* p, int num, int d) : pData(p), n(num), depth(d) {}
     T* pData;
     int n;
     int depth;
 };
 
+// A deque of jobs guarded by a spinlock. The lock is only
+// contended when a job is stolen.
+template<typename T>
+class MkqsJobDeque
+{
+    typedef MkqsJob<T> Job;
+
+    public:
+        MkqsJobDeque() : m_lock(0) {}
+
+        void push(const Job& job)
+        {
+            lock();
+            m_jobs.push_back(job);
+            unlock();
+        }
+
+        // Take the newest job, used by the owner of the deque
+        bool pop(Job& job)
+        {
+            lock();
+            bool found = !m_jobs.empty();
+            if(found)
+            {
+                job = m_jobs.back();
+                m_jobs.pop_back();
+            }
+            unlock();
+            return found;
+        }
+
+        // Take the oldest job, used by the other workers
+        bool steal(Job& job)
+        {
+            lock();
+            bool found = !m_jobs.empty();
+            if(found)
+            {
+                job = m_jobs.front();
+                m_jobs.pop_front();
+            }
+            unlock();
+            return found;
+        }
+
+    private:
+
+        void lock()
+        {
+            while(__sync_lock_test_and_set(&m_lock, 1))
+            {
+                while(m_lock)
+                    ;
+            }
+        }
+
+        void unlock()
+        {
+            __sync_lock_release(&m_lock);
+        }
+
+        volatile int m_lock;
+        std::deque<Job> m_jobs;
+};
+
+// The state shared by the workers of a parallel sort
+template<typename T>
+struct MkqsSharedState
+{
+    MkqsSharedState(int numThreads, int threshold) : deques(numThreads), numPending(0), thresholdSize(threshold) {}
+
+    std::vector<MkqsJobDeque<T> > deques;
+
+    // The number of jobs that have been created but not finished.
+    // The sort is complete when this reaches zero.
+    volatile long numPending;
+
+    // Jobs of at most this many elements are sorted serially
+    int thresholdSize;
+};
+
 //
 template<typename T, class PrimarySorter, class FinalSorter>
 class MkqsThread
 {
     typedef MkqsJob<T> Job;
-    typedef std::queue<Job> JobQueue;
+    typedef MkqsSharedState<T> SharedState;
 
     public:
-        MkqsThread(int id, JobQueue* pQueue, pthread_mutex_t* pQueueMutex, 
-                   sem_t* pQueueSem, sem_t* pDoneSem, int thresholdSize,
-                   const PrimarySorter* pPrimarySorter, 
-                   const FinalSorter* pFinalSorter) : m_id(id), 
-                                                      m_pQueue(pQueue), 
-                                                      m_pQueueMutex(pQueueMutex), 
-                                                      m_pQueueSem(pQueueSem),
-                                                      m_pDoneSem(pDoneSem),
-                                                      m_thresholdSize(thresholdSize),
-                                                      m_pPrimary(pPrimarySorter), 
+        MkqsThread(int id, SharedState* pState,
+                   const PrimarySorter* pPrimarySorter,
+                   const FinalSorter* pFinalSorter) : m_id(id),
+                                                      m_pState(pState),
+                                                      m_pPrimary(pPrimarySorter),
                                                       m_pFinal(pFinalSorter),
-                                                      m_stopRequested(false),
-                                                      m_numProcessed(0) {}
+                                                      m_numProcessed(0),
+                                                      m_numStolen(0) {}
         ~MkqsThread();
 
         void start();
-        void stop();
         void join();
 
+        // Add a job to the deque of this worker
+        void push(const Job& job);
+
+        int getNumProcessed() const { return m_numProcessed; }
+        int getNumStolen() const { return m_numStolen; }
+
         static void* startThread(void* obj);
 
     private:
 
         void run();
+        bool steal(Job& job);
         void process(Job& job);
+        void processRadix(Job& job);
 
         // Data
         int m_id;
-        JobQueue* m_pQueue; // shared
-        pthread_mutex_t* m_pQueueMutex; // shared
-        sem_t* m_pQueueSem; // shared
-        sem_t* m_pDoneSem; // shared
-        
-        int m_thresholdSize;
+        SharedState* m_pState; // shared
+
         const PrimarySorter* m_pPrimary;
         const FinalSorter* m_pFinal;
 
+        // Buffers for the radix partitioning, reused between jobs
+        std::vector<uint32_t> m_bucketCache;
+        std::vector<int> m_bucketCounts;
+
         pthread_t m_thread;
-        volatile bool m_stopRequested;
         int m_numProcessed;
+        int m_numStolen;
 };
 
 //
@@ -88,13 +180,6 @@ void MkqsThread<T, PrimarySorter, FinalSorter>::start()
     }
 }
 
-// Stop thread
-template<typename T, class PrimarySorter, class FinalSorter>
-void MkqsThread<T, PrimarySorter, FinalSorter>::stop()
-{
-    m_stopRequested = true;
-}
-
 // Called from the external main function, joins the thread to the main on exit
 template<typename T, class PrimarySorter, class FinalSorter>
 void MkqsThread<T, PrimarySorter, FinalSorter>::join()
@@ -107,47 +192,105 @@ void MkqsThread<T, PrimarySorter, FinalSorter>::join()
     }
 }
 
+//
+template<typename T, class PrimarySorter, class FinalSorter>
+void MkqsThread<T, PrimarySorter, FinalSorter>::push(const Job& job)
+{
+    // The pending count must be incremented before the job can be taken
+    __sync_fetch_and_add(&m_pState->numPending, 1);
+    m_pState->deques[m_id].push(job);
+}
+
 // Run thread
 template<typename T, class PrimarySorter, class FinalSorter>
 void MkqsThread<T, PrimarySorter, FinalSorter>::run()
 {
+    Job job;
     while(1)
     {
-        sem_post(m_pDoneSem);
-        sem_wait(m_pQueueSem);
-        
-        // Exit if the thread was stopped
-        if(m_stopRequested)
+        if(m_pState->deques[m_id].pop(job) || steal(job))
+        {
+            process(job);
+            m_numProcessed += 1;
+
+            // The sub jobs of this job have been pushed so the
+            // count cannot reach zero while work remains
+            __sync_fetch_and_sub(&m_pState->numPending, 1);
+        }
+        else if(m_pState->numPending == 0)
         {
-            pthread_exit(NULL);
+            break;
         }
+        else
+        {
+            sched_yield();
+        }
+    }
+}
 
-        // Take an item from the queue and process it
-        pthread_mutex_lock(m_pQueueMutex);
-        assert(!m_pQueue->empty());
+// Take a job from another worker
+template<typename T, class PrimarySorter, class FinalSorter>
+bool MkqsThread<T, PrimarySorter, FinalSorter>::steal(Job& job)
+{
+    int numThreads = m_pState->deques.size();
+    for(int i = 1; i < numThreads; ++i)
+    {
+        int victim = (m_id + i) % numThreads;
+        if(m_pState->deques[victim].steal(job))
+        {
+            m_numStolen += 1;
+            return true;
+        }
+    }
+    return false;
+}
 
-        // Decrement the done count. Since this is done
-        // while the queue is not empty and locked, the master
-        // thread can never see an empty queue before the
-        // done semaphore is decremented. This ensures all threads
-        // will work to completion
-        sem_wait(m_pDoneSem);
+// Process the job using either the serial algorithm, or a radix or
+// mkqs partitioning step which subdivides the job further
+template<typename T, class PrimarySorter, class FinalSorter>
+void MkqsThread<T, PrimarySorter, FinalSorter>::process(Job& job)
+{
+    if(job.n <= m_pState->thresholdSize)
+    {
+        mkqs2(job.pData, job.n, job.depth, *m_pPrimary, *m_pFinal);
+    }
+    else if(mkqs_use_radix(job.n, job.depth, *m_pPrimary))
+    {
+        processRadix(job);
+    }
+    else
+    {
+        Job subJobs[3];
+        int numJobs = mkqs_partition(job, subJobs, *m_pPrimary, *m_pFinal);
+        for(int i = 0; i < numJobs; ++i)
+            push(subJobs[i]);
+    }
+}
 
-        Job job = m_pQueue->front();
-        m_pQueue->pop();
-        pthread_mutex_unlock(m_pQueueMutex);
+//
+template<typename T, class PrimarySorter, class FinalSorter>
+void MkqsThread<T, PrimarySorter, FinalSorter>::processRadix(Job& job)
+{
+    if(m_bucketCache.size() < (size_t)job.n)
+        m_bucketCache.resize(job.n);
 
-        // Process the item using either the parallel algorithm (which subdivides the job further)
-        // or the serial algorithm (which doesn't subdivide)
-        if(job.n > m_thresholdSize)
-        {
-            parallel_mkqs_process(job, m_pQueue, m_pQueueMutex, m_pQueueSem, *m_pPrimary, *m_pFinal);
-        }
-        else
+    mkqs_compute_buckets(job.pData, job.n, job.depth, *m_pPrimary, &m_bucketCache[0]);
+    mkqs_radix_partition(job.pData, job.n, *m_pPrimary, &m_bucketCache[0], m_bucketCounts);
+
+    // Sort the buckets that contain complete suffixes and create jobs for the rest
+    int nextDepth = job.depth + m_pPrimary->getBucketLen();
+    T* pBucket = job.pData;
+    for(size_t i = 0; i < m_bucketCounts.size(); ++i)
+    {
+        int count = m_bucketCounts[i];
+        if(count > 1)
         {
-            mkqs2(job.pData, job.n, job.depth, *m_pPrimary, *m_pFinal);
+            if(m_pPrimary->isBucketDegenerate(i))
+                std::sort(pBucket, pBucket + count, *m_pFinal);
+            else
+                push(Job(pBucket, count, nextDepth));
         }
-        m_numProcessed += 1;
+        pBucket += count;
     }
 }
 
@@ -10,6 +10,7 @@
 //
 #include "ThreadWorker.h"
 #include "Timer.h"
+#include "Profiler.h"
 #include "SequenceWorkItem.h"
 #include "config.h"
 
@@ -31,6 +32,7 @@ const size_t BUFFER_SIZE = 1000;
 template<class Input, class Output, class Generator, class Processor, class PostProcessor>
 size_t processWorkSerial(Generator& generator, Processor* pProcessor, PostProcessor* pPostProcessor, size_t n = -1)
 {
+    PROFILE_FUNC("SequenceProcessFramework::process")
     Timer timer("SequenceProcess", true);
     Input workItem;
     
@@ -52,6 +54,7 @@ size_t processWorkSerial(Generator& generator, Processor* pProcessor, PostProces
     double proc_time_secs = timer.getElapsedWallTime();
     printf("[sga::process] processed %zu sequences in %lfs (%lf sequences/s)\n", 
             generator.getNumConsumed(), proc_time_secs, (double)generator.getNumConsumed() / proc_time_secs);    
+    PROFILE_COUNT("SequenceProcessFramework::sequences", generator.getNumConsumed());
     
     return generator.getNumConsumed();
 }
@@ -104,6 +107,7 @@ size_t processWorkParallelPthread(Generator& generator,
                                   PostProcessor* pPostProcessor, 
                                   size_t n = -1)
 {
+    PROFILE_FUNC("SequenceProcessFramework::process")
     Timer timer("SequenceProcess", true);
 
     // Helpful typedefs
@@ -140,7 +144,7 @@ size_t processWorkParallelPthread(Generator& generator,
 
         // Create and start the thread
         threadVec[i] = new Thread(semVec[i], processPtrVector[i], BUFFER_SIZE);
-        threadVec[i]->start();
+        threadVec[i]->start(i);
 
         inputBuffers[i] = new InputItemVector;
         inputBuffers[i]->reserve(BUFFER_SIZE);
@@ -238,6 +242,7 @@ size_t processWorkParallelPthread(Generator& generator,
     double proc_time_secs = timer.getElapsedWallTime();
     printf("[sga::process] processed %zu sequences in %lfs (%lf sequences/s)\n", 
             generator.getNumConsumed(), proc_time_secs, (double)generator.getNumConsumed() / proc_time_secs);
+    PROFILE_COUNT("SequenceProcessFramework::sequences", generator.getNumConsumed());
     return generator.getNumConsumed();
 }
 
@@ -263,6 +268,7 @@ size_t processWorkParallelOpenMP(Generator& generator,
                                  size_t n = -1)
 {
 #if HAVE_OPENMP
+    PROFILE_FUNC("SequenceProcessFramework::process")
     Timer timer("SequenceProcess", true);
 
     // Helpful typedefs
@@ -278,6 +284,14 @@ size_t processWorkParallelOpenMP(Generator& generator,
 
     omp_set_num_threads(numThreads);
 
+    // The runtime keeps the same threads for each parallel region
+    // of the same size, so the threads only need to be pinned once
+    if(MemoryPolicy::getPinThreads())
+    {
+        #pragma omp parallel
+        MemoryPolicy::pinThread(omp_get_thread_num());
+    }
+
     bool done = false;
     while(!done)
     {
@@ -327,6 +341,7 @@ size_t processWorkParallelOpenMP(Generator& generator,
     double proc_time_secs = timer.getElapsedWallTime();
     printf("[sga::process] processed %zu sequences in %lfs (%lf sequences/s)\n", 
             generator.getNumConsumed(), proc_time_secs, (double)generator.getNumConsumed() / proc_time_secs);
+    PROFILE_COUNT("SequenceProcessFramework::sequences", generator.getNumConsumed());
     return generator.getNumConsumed();
 #else // OPENMP
     (void)generator;
@@ -16,6 +16,7 @@
 
 #include <semaphore.h>
 #include "Util.h"
+#include "MemoryPolicy.h"
 
 template<class Input, class Output, class Processor>
 class ThreadWorker
@@ -30,8 +31,9 @@ class ThreadWorker
         // Exchange the contents of the shared input/output vectors with pInput/pOutput
         void swapBuffers(InputVector& otherInputVector, OutputVector& otherOutputVector);
 
-        // External control functions
-        void start();
+        // External control functions. The thread index is used
+        // to pin the thread to a processor, if enabled by the MemoryPolicy
+        void start(int threadIdx = -1);
         void stop();
         bool isReady();
 
@@ -65,6 +67,7 @@ class ThreadWorker
 
         volatile bool m_stopRequested;
         bool m_isReady;
+        int m_threadIdx;
 };
 
 // Implementation
@@ -75,7 +78,8 @@ ThreadWorker<Input, Output, Processor>::ThreadWorker(sem_t* pReadySem,
                                                       m_pReadySem(pReadySem),
                                                       m_pProcessor(pProcessor),
                                                       m_stopRequested(false), 
-                                                      m_isReady(false)
+                                                      m_isReady(false),
+                                                      m_threadIdx(-1)
 {
     m_sharedInputVector.reserve(max_items);
     m_sharedOutputVector.reserve(max_items);
@@ -128,8 +132,9 @@ void ThreadWorker<Input, Output, Processor>::swapBuffers(InputVector& otherInput
 
 // Externally-called function to start the worker
 template<class Input, class Output, class Processor>
-void ThreadWorker<Input, Output, Processor>::start()
+void ThreadWorker<Input, Output, Processor>::start(int threadIdx)
 {
+    m_threadIdx = threadIdx;
     int ret = pthread_create(&m_thread, 0, &ThreadWorker<Input, Output, Processor>::startThread, this);
     if(ret != 0)
     {
@@ -169,6 +174,8 @@ bool ThreadWorker<Input, Output, Processor>::isReady()
 template<class Input, class Output, class Processor>
 void ThreadWorker<Input, Output, Processor>::run()
 {
+    MemoryPolicy::pinThread(m_threadIdx);
+
     // Indicate that the thread is ready to receive data
     pthread_mutex_lock(&m_mutex);
     m_isReady = true;
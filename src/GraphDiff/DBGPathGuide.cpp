@@ -9,28 +9,71 @@
 //
 #include "DBGPathGuide.h"
 #include <stdio.h>
+#include <string.h>
 
-DBGPathGuide::DBGPathGuide(size_t k) : m_k(k), m_pmers_checked(0), m_pmers_passed(0)
+// The number of slots in a new table, which must be a power of two.
+// The table is doubled when it is more than 3/4 full.
+static const size_t INITIAL_SLOTS = 1024;
+
+// 2-bit code of a base, or -1 for a non-DNA symbol
+static inline int baseCode(char b)
 {
+    switch(b)
+    {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return -1;
+    }
+}
 
+DBGPathGuide::DBGPathGuide(size_t k) : m_k(k), m_pmers_checked(0), m_pmers_passed(0),
+                                       m_p(k + 1), m_words((k + 1 + 31) / 32), m_num_pmers(0)
+{
+    m_key.resize(m_words);
+    resize(INITIAL_SLOTS);
 }
 
 //
 void DBGPathGuide::addSequence(const std::string& str)
 {
-    size_t p = m_k + 1;
+    size_t p = m_p;
     if(str.size() < p)
         return;
 
-    for(size_t i = 0; i < str.size() - p + 1; i++)
-        m_pmer_set.insert(str.substr(i, p));
+    // Roll the encoding of the p-mer ending at position i along the sequence.
+    // Appending a base shifts the encoding down by one base across the words,
+    // so the base that falls off the front is discarded.
+    std::vector<uint64_t> key(m_words, 0);
+    size_t lastWord = m_words - 1;
+    size_t lastShift = 2 * ((p - 1) % 32);
+    size_t validBases = 0;
+    for(size_t i = 0; i < str.size(); ++i)
+    {
+        for(size_t w = 0; w < lastWord; ++w)
+            key[w] = (key[w] >> 2) | (key[w + 1] << 62);
+        key[lastWord] >>= 2;
+
+        int code = baseCode(str[i]);
+        if(code < 0)
+        {
+            validBases = 0;
+            continue;
+        }
+
+        key[lastWord] |= (uint64_t)code << lastShift;
+        validBases += 1;
+        if(validBases >= p)
+            insert(&key[0]);
+    }
 }
 
 //
 bool DBGPathGuide::hasPmer(const std::string& str)
 {
     m_pmers_checked += 1;
-    bool passed = m_pmer_set.find(str) != m_pmer_set.end();
+    bool passed = str.size() == m_p && encode(str, &m_key[0]) && findSlot(&m_key[0]) != m_occupied.size();
     m_pmers_passed += passed;
     return passed;
 }
@@ -38,5 +81,90 @@ bool DBGPathGuide::hasPmer(const std::string& str)
 //
 void DBGPathGuide::printStats() const
 {
-    printf("DBGPathGuide has %zu pmers. %zu out of %zu have passed the check\n", m_pmer_set.size(), m_pmers_passed, m_pmers_checked);
+    size_t numSlots = m_occupied.size();
+    size_t tableBytes = numSlots * m_words * sizeof(uint64_t) + numSlots / 8;
+    printf("DBGPathGuide has %zu pmers. %zu out of %zu have passed the check\n", m_num_pmers, m_pmers_passed, m_pmers_checked);
+    printf("DBGPathGuide table uses %zu bytes in %zu slots (%.2lf bytes per pmer)\n", 
+           tableBytes, numSlots, m_num_pmers > 0 ? (double)tableBytes / m_num_pmers : 0.0);
+}
+
+//
+bool DBGPathGuide::encode(const std::string& str, uint64_t* key) const
+{
+    memset(key, 0, m_words * sizeof(uint64_t));
+    for(size_t i = 0; i < m_p; ++i)
+    {
+        int code = baseCode(str[i]);
+        if(code < 0)
+            return false;
+        key[i / 32] |= (uint64_t)code << 2 * (i % 32);
+    }
+    return true;
+}
+
+//
+void DBGPathGuide::resize(size_t numSlots)
+{
+    std::vector<uint64_t> oldTable(numSlots * m_words);
+    std::vector<bool> oldOccupied(numSlots, false);
+    oldTable.swap(m_table);
+    oldOccupied.swap(m_occupied);
+    m_num_pmers = 0;
+
+    for(size_t i = 0; i < oldOccupied.size(); ++i)
+    {
+        if(oldOccupied[i])
+            insert(&oldTable[i * m_words]);
+    }
+}
+
+//
+void DBGPathGuide::insert(const uint64_t* key)
+{
+    if(4 * (m_num_pmers + 1) > 3 * m_occupied.size())
+        resize(2 * m_occupied.size());
+
+    // Linear probing. The table size is a power of two.
+    size_t mask = m_occupied.size() - 1;
+    size_t slot = hash(key) & mask;
+    while(m_occupied[slot])
+    {
+        if(memcmp(getSlot(slot), key, m_words * sizeof(uint64_t)) == 0)
+            return; // already present
+        slot = (slot + 1) & mask;
+    }
+
+    memcpy(getSlot(slot), key, m_words * sizeof(uint64_t));
+    m_occupied[slot] = true;
+    m_num_pmers += 1;
+}
+
+// Returns the slot holding the key or the number of slots if it is not present
+size_t DBGPathGuide::findSlot(const uint64_t* key) const
+{
+    size_t mask = m_occupied.size() - 1;
+    size_t slot = hash(key) & mask;
+    while(m_occupied[slot])
+    {
+        if(memcmp(getSlot(slot), key, m_words * sizeof(uint64_t)) == 0)
+            return slot;
+        slot = (slot + 1) & mask;
+    }
+    return m_occupied.size();
+}
+
+// Mix the words of the key with the 64-bit finalizer of MurmurHash3
+size_t DBGPathGuide::hash(const uint64_t* key) const
+{
+    uint64_t h = 0;
+    for(size_t w = 0; w < m_words; ++w)
+    {
+        h ^= key[w] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb93e07a2e8ddULL;
+        h ^= h >> 33;
+    }
+    return h;
 }
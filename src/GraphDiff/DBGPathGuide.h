@@ -7,11 +7,22 @@
 // DBGPathGuide - Determine whether edges in a de Bruijn
 // graph are supported by a subset of sequence reads
 //
+// The (k+1)-mers are stored 2 bits per base in an
+// open-addressing hash table, so a p-mer of up to 32
+// bases takes a single 64-bit word per slot, plus one
+// occupancy bit. The table is doubled when it is 3/4
+// full so between 3/8 and 3/4 of the slots are used,
+// which costs 11-22 bytes per p-mer for k < 32 and
+// 22-43 bytes for k < 64. printStats reports the
+// measured figure. Lookups encode the query into a
+// preallocated buffer and do not allocate.
+//
 #ifndef DBGPATHGUIDE_H
 #define DBGPATHGUIDE_H
 
 #include <string>
-#include <set>
+#include <vector>
+#include <stdint.h>
 
 class DBGPathGuide
 {
@@ -29,10 +40,35 @@ class DBGPathGuide
 
     private:
 
+        // Encode the p-mer into the words of key.
+        // Returns false if it contains a non-DNA symbol
+        bool encode(const std::string& str, uint64_t* key) const;
+
+        // Rehash the table into numSlots slots
+        void resize(size_t numSlots);
+
+        //
+        void insert(const uint64_t* key);
+        size_t findSlot(const uint64_t* key) const;
+        size_t hash(const uint64_t* key) const;
+
+        uint64_t* getSlot(size_t slot) { return &m_table[slot * m_words]; }
+        const uint64_t* getSlot(size_t slot) const { return &m_table[slot * m_words]; }
+
         size_t m_k;
         size_t m_pmers_checked;
         size_t m_pmers_passed;
-        std::set<std::string> m_pmer_set;
+
+        // The p-mers are stored in m_words consecutive words of m_table.
+        // Base i of the p-mer is held in bits 2*(i%32) of word i/32.
+        size_t m_p;
+        size_t m_words;
+        size_t m_num_pmers;
+        std::vector<uint64_t> m_table;
+        std::vector<bool> m_occupied;
+
+        // Scratch space for encoding queries
+        std::vector<uint64_t> m_key;
 };
 
 #endif
@@ -21,7 +21,8 @@
 //
 //
 //
-DeBruijnHaplotypeBuilder::DeBruijnHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params)
+DeBruijnHaplotypeBuilder::DeBruijnHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params),
+                                                                                            m_navigator(params.variantIndex.pBWT, NULL, params.variantIndex.pCache)
 {
 
 }
@@ -36,6 +37,7 @@ DeBruijnHaplotypeBuilder::~DeBruijnHaplotypeBuilder()
 void DeBruijnHaplotypeBuilder::setInitialHaplotype(const std::string& str)
 {
     m_startingKmer = str;
+    m_navigator.clear();
 }
 
 // Run the bubble construction process
@@ -83,8 +85,7 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
 
         // Calculate de Bruijn extensions for this node
         std::string vertStr = curr.pVertex->getSeq().toString();
-        AlphaCount64 extensionCounts = 
-            BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, m_parameters.variantIndex.pBWT, curr.direction);
+        AlphaCount64 extensionCounts = m_navigator.getExtensions(vertStr, curr.direction);
 
         // Count valid extensions
         std::string extensions;
@@ -152,6 +153,7 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
     // If the graph construction was successful, walk the graph
     // between the endpoints to make a string
     // Generate haplotypes between every pair of antisense/sense join vertices
+    SGSearchNodePool searchPool;
     for(size_t i = 0; i < antisense_join_vector.size(); ++i) {
         for(size_t j = 0; j < sense_join_vector.size(); ++j) {
             SGWalkVector outWalks;
@@ -161,7 +163,8 @@ HaplotypeBuilderReturnCode DeBruijnHaplotypeBuilder::run(StringVector& out_haplo
                                 100000, // max distance to search
                                 10000, // max nodes to search
                                 true, // exhaustive search
-                                outWalks);
+                                outWalks,
+                                &searchPool);
 
             for(size_t k = 0; k < outWalks.size(); ++k)
                 out_haplotypes.push_back(outWalks[k].getString(SGWT_START_TO_END));
@@ -219,8 +222,7 @@ Vertex* DeBruijnHaplotypeBuilder::extendUnambiguously(Vertex* pStart, StringGrap
     while(distance < max_distance)
     {
         std::string vertStr = pCurrent->getSeq().toString();
-        AlphaCount64 extensionCounts = 
-            BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, m_parameters.variantIndex.pBWT, direction);
+        AlphaCount64 extensionCounts = m_navigator.getExtensions(vertStr, direction);
         
         // Count valid extensions
         char ext_base = '\0';
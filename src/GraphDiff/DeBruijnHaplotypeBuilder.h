@@ -22,6 +22,7 @@
 #include "GraphCompare.h"
 #include "ErrorCorrectProcess.h"
 #include "SGWalk.h"
+#include "DBGNavigator.h"
 #include <queue>
 
 // Build haplotypes starting from a given sequence.
@@ -54,6 +55,9 @@ class DeBruijnHaplotypeBuilder
         //
         GraphCompareParameters m_parameters;
         std::string m_startingKmer;
+
+        // The implicit graph of the variant reads
+        DBGNavigator m_navigator;
 };
 
 #endif
@@ -16,6 +16,7 @@
 
 #include "DindelRealignWindow.h"
 #include "DindelHMM.h"
+#include "Profiler.h"
 const int DINDEL_DEBUG=0;
 
 #ifdef DINDELHMMSTANDALONE
@@ -136,6 +137,7 @@ void DindelHMM::getSeedPositions(std::set<int> & positions)
 
 ReadHaplotypeAlignment DindelHMM::getAlignment()
 {
+    PROFILE_FUNC("DindelHMM::getAlignment")
     bool rcRead = m_pRead->getRCRead();
 
     std::set<int> positions;
@@ -1715,6 +1715,9 @@ void DindelRealignWindow::algorithm_hmm(VCFCollection& out,
     assert(numHaps>=1);
     assert(pThisResult != NULL);
 
+    PROFILE_HISTOGRAM("DindelRealignWindow::haplotypesPerWindow", numHaps);
+    PROFILE_HISTOGRAM("DindelRealignWindow::readsPerWindow", m_pDindelReads->size());
+
     // process the user-defined haplotypes
     computeReadHaplotypeAlignmentsUsingHMM(0, numHaps-1);
 
@@ -13,6 +13,7 @@
 //
 #include "GraphCompare.h"
 #include "BWTAlgorithms.h"
+#include "DBGNavigator.h"
 #include "SGAlgorithms.h"
 #include "SGSearch.h"
 #include "StdAlnTools.h"
@@ -129,96 +130,111 @@ GraphCompareResult GraphCompare::process(const SequenceWorkItem& item) const
     // in a read are connected in the de Bruijn graph, if the first attempt
     // to assemble a k-mer into a variant fails, it is very unlikely that
     // subsequent attempts will succeed.
+    //
+    // The k-mers of both strands are copied out of the read and its reverse
+    // complement into reused buffers. The index searches are ordered so that
+    // a k-mer is rejected with as few of them as possible: the reverse complement
+    // is only counted if the k-mer itself could still pass the discovery
+    // thresholds and only the presence of the k-mer in the base index is tested.
+    // Once a variant has been attempted no later k-mer of the read can be used
+    // so the scan stops.
+    std::string rc_w = reverseComplement(w);
+    std::string kmer;
+    std::string rc_kmer;
+    size_t k = m_parameters.kmer;
     bool variantAttempted = false;
-    for(int j = 0; j < num_kmers; ++j)
+    for(int j = 0; j < num_kmers && !variantAttempted; ++j)
     {
-        std::string kmer = w.substr(j, m_parameters.kmer);
-        std::string rc_kmer = reverseComplement(kmer);
+        kmer.assign(w, j, k);
+        rc_kmer.assign(rc_w, len - j - k, k);
 
         // Use the lexicographically lower of the kmer and its pair as the key in the bloom filter
-        std::string& key_kmer = kmer < rc_kmer ? kmer : rc_kmer;
+        const std::string& key_kmer = kmer < rc_kmer ? kmer : rc_kmer;
 
         // Check if this k-mer is marked as used by the bloom filter
         if(m_parameters.pBloomFilter->test(key_kmer.c_str(), key_kmer.size()))
             continue;
         
-    	// Get the interval for this kmer
+        // Get the interval for this kmer. The k-mer must be seen on both strands.
         BWTInterval interval = BWTAlgorithms::findInterval(m_parameters.variantIndex, kmer);
+        if(interval.size() <= 0 || (size_t)interval.size() >= m_parameters.maxDiscoveryCount)
+            continue;
+
         BWTInterval rc_interval = BWTAlgorithms::findInterval(m_parameters.variantIndex, rc_kmer);
-        
-        size_t count = interval.size();
-        if(rc_interval.isValid())
-            count += rc_interval.size();
+        if(rc_interval.size() <= 0)
+            continue;
+
+        size_t count = interval.size() + rc_interval.size();
+        if(count < m_parameters.minDiscoveryCount || count >= m_parameters.maxDiscoveryCount)
+            continue;
 
-        bool both_strands = interval.size() > 0 && rc_interval.size() > 0;
+        // Update the bloom filter to contain this kmer
+        m_parameters.pBloomFilter->add(key_kmer.c_str(), key_kmer.size());
 
-        size_t min_base_coverage = 1;
-        if(count >= m_parameters.minDiscoveryCount && count < m_parameters.maxDiscoveryCount && !variantAttempted && both_strands)
+        // Check if this k-mer is present in the other base index
+        bool in_base = BWTAlgorithms::findInterval(m_parameters.baseIndex, kmer).isValid() ||
+                       BWTAlgorithms::findInterval(m_parameters.baseIndex, rc_kmer).isValid();
+        
+        if(Verbosity::Instance().getPrintLevel() > 6)
         {
-            // Update the bloom filter to contain this kmer
-            m_parameters.pBloomFilter->add(key_kmer.c_str(), key_kmer.size());
-
-            // Check if this k-mer is present in the other base index
             size_t base_count = BWTAlgorithms::countSequenceOccurrences(kmer, m_parameters.baseIndex);
-            
-            if(Verbosity::Instance().getPrintLevel() > 6)
-                std::cout << "Read: " << currRead.id << " k: " << j << " CV: " << interval.size() << "/" << rc_interval.size() << " " << base_count << "\n";
-            
-            // k-mer present in the base read set, skip it
-            if(base_count >= min_base_coverage)
-                continue;
-            
-            if(Verbosity::Instance().getPrintLevel() > 0)
-                std::cout << "Variant read: " << w << "\n";
+            std::cout << "Read: " << currRead.id << " k: " << j << " CV: " << interval.size() << "/" << rc_interval.size() << " " << base_count << "\n";
+        }
+        
+        // k-mer present in the base read set, skip it
+        if(in_base)
+            continue;
 
-            // variant k-mer, attempt to assemble it into haplotypes
-            GraphBuildResult build_result = processVariantKmer(kmer, count);
-            variantAttempted = true;
+        if(Verbosity::Instance().getPrintLevel() > 0)
+            std::cout << "Variant read: " << w << "\n";
 
-            // Mark the kmers of the variant haplotypes as being visited
-            for(size_t vhi = 0; vhi < build_result.variant_haplotypes.size(); ++vhi)
-                markVariantSequenceKmers(build_result.variant_haplotypes[vhi]);
+        // variant k-mer, attempt to assemble it into haplotypes
+        GraphBuildResult build_result = processVariantKmer(kmer, count);
+        variantAttempted = true;
+
+        // Mark the kmers of the variant haplotypes as being visited
+        for(size_t vhi = 0; vhi < build_result.variant_haplotypes.size(); ++vhi)
+            markVariantSequenceKmers(build_result.variant_haplotypes[vhi]);
+        
+        // If we assembled anything, run Dindel on the haplotypes
+        if(build_result.variant_haplotypes.size() > 0)
+        {
+            if(Verbosity::Instance().getPrintLevel() > 0)
+                std::cout << "Running dindel\n";
+
+            std::stringstream baseVCFSS;
+            std::stringstream variantVCFSS;
+            std::stringstream callsVCFSS;
+            DindelReadReferenceAlignmentVector alignments;
+
+            DindelReturnCode drc = DindelUtil::runDindelPairMatePair(kmer,
+                                                                     build_result.base_haplotypes,
+                                                                     build_result.variant_haplotypes,
+                                                                     m_parameters,
+                                                                     baseVCFSS,
+                                                                     variantVCFSS,
+                                                                     callsVCFSS,
+                                                                     &alignments);
             
-            // If we assembled anything, run Dindel on the haplotypes
-            if(build_result.variant_haplotypes.size() > 0)
+            //
+            if(Verbosity::Instance().getPrintLevel() > 0)
             {
-                if(Verbosity::Instance().getPrintLevel() > 0)
-                    std::cout << "Running dindel\n";
-
-                std::stringstream baseVCFSS;
-                std::stringstream variantVCFSS;
-                std::stringstream callsVCFSS;
-                DindelReadReferenceAlignmentVector alignments;
-
-                DindelReturnCode drc = DindelUtil::runDindelPairMatePair(kmer,
-                                                                         build_result.base_haplotypes,
-                                                                         build_result.variant_haplotypes,
-                                                                         m_parameters,
-                                                                         baseVCFSS,
-                                                                         variantVCFSS,
-                                                                         callsVCFSS,
-                                                                         &alignments);
-                
-                //
-                if(Verbosity::Instance().getPrintLevel() > 0)
-                {
-                    std::cout << "Dindel returned " << drc << "\n";
-                    std::cout << "base vcf records:\n" << baseVCFSS.str() << "\n";
-                    std::cout << "variant vcf records:\n" << variantVCFSS.str() << "\n";
-                }
-                
-                // DINDEL ran without error, push its results to the output
-                if(drc == DRC_OK)
-                {                        
-                    result.baseVCFStrings.push_back(baseVCFSS.str());
-                    result.variantVCFStrings.push_back(variantVCFSS.str());
-                    result.calledVCFStrings.push_back(callsVCFSS.str());
-
-                    result.varStrings.insert(result.varStrings.end(), 
-                                             build_result.variant_haplotypes.begin(), build_result.variant_haplotypes.end());
-                
-                    result.projectedReadAlignments = alignments;
-                }
+                std::cout << "Dindel returned " << drc << "\n";
+                std::cout << "base vcf records:\n" << baseVCFSS.str() << "\n";
+                std::cout << "variant vcf records:\n" << variantVCFSS.str() << "\n";
+            }
+            
+            // DINDEL ran without error, push its results to the output
+            if(drc == DRC_OK)
+            {                        
+                result.baseVCFStrings.push_back(baseVCFSS.str());
+                result.variantVCFStrings.push_back(variantVCFSS.str());
+                result.calledVCFStrings.push_back(callsVCFSS.str());
+
+                result.varStrings.insert(result.varStrings.end(), 
+                                         build_result.variant_haplotypes.begin(), build_result.variant_haplotypes.end());
+            
+                result.projectedReadAlignments = alignments;
             }
         }
     }
@@ -453,10 +469,11 @@ size_t GraphCompare::calculateHaplotypeBranches(const std::string& sequence,
 
     size_t num_branches = 0;
     size_t nk = sequence.size() - k + 1;
+    DBGNavigator navigator(indices.pBWT, NULL, indices.pCache);
     for(size_t i = 0; i < nk; ++i)
     {
         std::string kmer = sequence.substr(i, k);
-        AlphaCount64 extensions = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(kmer, indices.pBWT, ED_SENSE, indices.pCache);
+        AlphaCount64 extensions = navigator.getExtensions(kmer, ED_SENSE);
 
         // Count number of symbols with coverage >= min_branch_depth
         size_t n = 0;
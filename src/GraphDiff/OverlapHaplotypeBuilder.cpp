@@ -17,6 +17,7 @@
 #include "multiple_alignment.h"
 #include "KmerOverlaps.h"
 #include "CorrectionThresholds.h"
+#include "MurmurHash3.h"
 
 //#define SHOW_MULTIPLE_ALIGNMENT 1
 //#define SHOW_GRAPH 1
@@ -25,7 +26,7 @@
 //
 //
 //
-OverlapHaplotypeBuilder::OverlapHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params), m_numReads(0)
+OverlapHaplotypeBuilder::OverlapHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params)
 {
     assert(m_parameters.minOverlap > 25);
 
@@ -109,6 +110,7 @@ HaplotypeBuilderReturnCode OverlapHaplotypeBuilder::run(StringVector& out_haplot
         // Clean up the graph
         SGIdenticalRemoveVisitor dupVisit;
         m_graph->visit(dupVisit);
+        syncVertexIndex();
         m_graph->setContainmentFlag(false);
 
         // Remove transitive edges
@@ -172,7 +174,7 @@ void OverlapHaplotypeBuilder::extendGraph()
 
     for(size_t i = 0; i < tips.size(); ++i)
     {
-        Vertex* x = m_graph->getVertex(tips[i].id);
+        Vertex* x = m_vertices[tips[i].vertex_index];
         assert(x != NULL);
         EdgeDir dir = tips[i].direction;
 
@@ -181,7 +183,7 @@ void OverlapHaplotypeBuilder::extendGraph()
 #endif
 
         // Find corrected reads that perfectly overlap this vertex
-        StringVector overlapping_reads = getCorrectedOverlaps(x->getSeq().toString(), dir);
+        StringVector overlapping_reads = getCorrectedOverlaps(m_vertex_sequences[tips[i].vertex_index], dir);
 
 #ifdef OVERLAP_HAP_DEBUG
         printf("Found %zu overlaps\n", overlapping_reads.size());
@@ -193,82 +195,128 @@ void OverlapHaplotypeBuilder::extendGraph()
             // Determine whether the incoming read is possible join point
             bool is_join = isJoinSequence(overlapping_reads[j], dir);
 
-            std::stringstream label;
-            label << (is_join ? "join-" : "extend-");
-            label << (dir == ED_ANTISENSE ? "left-" : "right-");
-            insertVertexIntoGraph(label.str(), overlapping_reads[j]);
+            const char* label;
+            if(dir == ED_ANTISENSE)
+                label = is_join ? "join-left-" : "extend-left-";
+            else
+                label = is_join ? "join-right-" : "extend-right-";
+            insertVertexIntoGraph(label, overlapping_reads[j]);
         }
 
         // Check if x is still a tip in this direction. If so, we trim it and its branch from the graph
-        EdgePtrVec x_edges = x->getEdges(dir);
-        if(x_edges.size() == 0)
+        if(x->countEdges(dir) == 0)
             vertices_to_trim.push_back(tips[i]);
     }
     
     // Trim non-extended vertices
     for(size_t i = 0; i < vertices_to_trim.size(); ++i)
     {
-        Vertex* x = m_graph->getVertex(vertices_to_trim[i].id);
-
         // This vertex may have been removed in a previous iteration
-        if(x != NULL)
-            trimTip(x, vertices_to_trim[i].direction);
+        if(m_vertices[vertices_to_trim[i].vertex_index] != NULL)
+            trimTip(vertices_to_trim[i].vertex_index, vertices_to_trim[i].direction);
     }
 }
 
+// Encode the kmers of sequence using 2 bits per base. Kmers
+// containing a non-DNA symbol are given the code INVALID_KMER_CODE
+static const uint64_t INVALID_KMER_CODE = (uint64_t)-1;
+static void encodeKmers(const std::string& sequence, size_t k, std::vector<uint64_t>& kmer_codes)
+{
+    assert(k < 32);
+    kmer_codes.clear();
+    if(sequence.size() < k)
+        return;
+
+    uint64_t mask = ((uint64_t)1 << 2 * k) - 1;
+    uint64_t code = 0;
+    size_t valid_length = 0; // the number of DNA symbols ending at the current position
+    for(size_t i = 0; i < sequence.size(); ++i)
+    {
+        uint64_t rank;
+        switch(sequence[i])
+        {
+            case 'A': rank = 0; break;
+            case 'C': rank = 1; break;
+            case 'G': rank = 2; break;
+            case 'T': rank = 3; break;
+            default: rank = 4; break;
+        }
+
+        if(rank < 4)
+        {
+            code = ((code << 2) | rank) & mask;
+            valid_length += 1;
+        }
+        else
+        {
+            valid_length = 0;
+        }
+
+        if(i + 1 >= k)
+            kmer_codes.push_back(valid_length >= k ? code : INVALID_KMER_CODE);
+    }
+}
+
+// Hash a read sequence for the used reads map
+static uint64_t hashSequence(const std::string& sequence)
+{
+    uint64_t h[2];
+    MurmurHash3_x64_128(sequence.data(), sequence.size(), 0, h);
+    return h[0];
+}
+
 // 
-void OverlapHaplotypeBuilder::insertVertexIntoGraph(const std::string& prefix, const std::string& sequence)
+void OverlapHaplotypeBuilder::insertVertexIntoGraph(const char* prefix, const std::string& sequence)
 {
     PROFILE_FUNC("OverlapHaplotypeBuilder::insertVertexIntoGraph")
     // Check if a vertex with this sequence already exists, if so
-    // we do not create a new vertex
-    if(m_used_reads.find(sequence) != m_used_reads.end())
+    // we do not create a new vertex. On the very unlikely event of
+    // a hash collision between different sequences the read is added.
+    uint64_t sequence_hash = hashSequence(sequence);
+    HashMap<uint64_t, size_t>::const_iterator used_iter = m_used_reads.find(sequence_hash);
+    if(used_iter != m_used_reads.end() && m_vertex_sequences[used_iter->second] == sequence)
         return;
 
     // Create the vertex
-    std::stringstream id_ss;
-    id_ss << prefix << m_numReads++;
-    Vertex* pVertex = new(m_graph->getVertexAllocator()) Vertex(id_ss.str(), sequence);
+    size_t vertex_index = m_vertices.size();
+    char number[32];
+    snprintf(number, sizeof(number), "%zu", vertex_index);
+    std::string id = std::string(prefix) + number;
+    Vertex* pVertex = new(m_graph->getVertexAllocator()) Vertex(id, sequence);
     m_graph->addVertex(pVertex);
 
+    m_vertices.push_back(pVertex);
+    m_vertex_sequences.push_back(sequence);
+    m_vertex_index[pVertex] = vertex_index;
+
 #ifdef OVERLAP_HAP_DEBUG
-    std::cout << "Inserting vertex " << id_ss.str() << "\n";
+    std::cout << "Inserting vertex " << id << "\n";
 #endif
 
     // Get a list of vertices that have a k-mer match to this sequence.
-    SharedVertexKmerVector candidate_vertices = getCandidateOverlaps(pVertex);
+    std::vector<uint64_t> kmer_codes;
+    encodeKmers(sequence, m_vertex_map_kmer, kmer_codes);
+    SharedVertexKmerVector candidate_vertices = getCandidateOverlaps(kmer_codes);
 
     // Align the sequence against candidate reads
     for(size_t i = 0; i < candidate_vertices.size(); ++i) 
     {
-        Vertex* existing_vertex = candidate_vertices[i].vertex;
-
-        // Skip self-edge
-        if(existing_vertex == pVertex)
-            continue;
+        const SharedVertexKmer& candidate = candidate_vertices[i];
+        Vertex* existing_vertex = m_vertices[candidate.vertex_index];
+        const std::string& existing_sequence = m_vertex_sequences[candidate.vertex_index];
 
-        std::string existing_sequence = existing_vertex->getSeq().toString();
-
-        // Try to compute the overlap using the shared kmer as a seed match
         SequenceOverlap overlap;
-        std::string shared_kmer = sequence.substr(candidate_vertices[i].kmer_index, m_vertex_map_kmer);
-        size_t pos_0 = existing_sequence.find(shared_kmer);
-        size_t pos_1 = sequence.find(shared_kmer);
-        assert(pos_0 != std::string::npos && pos_1 != std::string::npos);
-
-        // Check for secondary occurrences
-        if(existing_sequence.find(shared_kmer, pos_0 + 1) != std::string::npos || 
-                    sequence.find(shared_kmer, pos_1 + 1) != std::string::npos) 
+        if(candidate.is_unique)
+        {
+            // Seed the match using kmer position
+            overlap = Overlapper::extendMatch(existing_sequence, sequence, candidate.existing_index, candidate.kmer_index, 1);
+        }
+        else
         {
             // One of the reads has a second occurrence of the kmer. Use
             // the slow overlapper.
             overlap = Overlapper::computeOverlap(existing_sequence, sequence);
         } 
-        else 
-        {
-            // Seed the match using kmer position
-            overlap = Overlapper::extendMatch(existing_sequence, sequence, pos_0, pos_1, 1);
-        }
 
         /*
         printf("Overlap: %s - %s\n", existing_vertex->getID().c_str(), pVertex->getID().c_str());
@@ -280,63 +328,179 @@ void OverlapHaplotypeBuilder::insertVertexIntoGraph(const std::string& prefix, c
             // Add an overlap to the graph
             // Translate the sequence overlap struture into an SGA overlap
             Overlap sga_overlap(existing_vertex->getID(), overlap.match[0].start, overlap.match[0].end, existing_sequence.size(),
-                                             id_ss.str(), overlap.match[1].start, overlap.match[1].end, sequence.size(), false, 0);
+                                             id, overlap.match[1].start, overlap.match[1].end, sequence.size(), false, 0);
             SGAlgorithms::createEdgesFromOverlap(m_graph, sga_overlap, true);
         }
     }
 
-    // Insert the sequence into the used reads set
-    m_used_reads.insert(sequence);
+    // Insert the sequence into the used reads map
+    m_used_reads.insert(std::make_pair(sequence_hash, vertex_index));
 
     // Update kmer map too
-    updateKmerVertexMap(pVertex);
+    updateKmerVertexMap(vertex_index, kmer_codes);
+}
+
+// A kmer shared between the incoming sequence and a vertex. The diagonal
+// is the offset of the kmer in the vertex relative to the incoming sequence.
+struct SharedKmerHit
+{
+    size_t vertex_index;
+    int diagonal;
+    size_t kmer_index;
+    size_t existing_index;
+};
+
+static bool sortHitsByVertexDiagonal(const SharedKmerHit& a, const SharedKmerHit& b)
+{
+    if(a.vertex_index != b.vertex_index)
+        return a.vertex_index < b.vertex_index;
+    if(a.diagonal != b.diagonal)
+        return a.diagonal < b.diagonal;
+    return a.kmer_index < b.kmer_index;
 }
 
+// Order candidates by the address of their vertex
+struct CandidateVertexOrder
+{
+    CandidateVertexOrder(const VertexPtrVec& vertices) : m_vertices(vertices) {}
+    bool operator()(const SharedVertexKmer& a, const SharedVertexKmer& b) const
+    {
+        return m_vertices[a.vertex_index] < m_vertices[b.vertex_index];
+    }
+    const VertexPtrVec& m_vertices;
+};
+
 //
-SharedVertexKmerVector OverlapHaplotypeBuilder::getCandidateOverlaps(const Vertex* incoming_vertex)
+SharedVertexKmerVector OverlapHaplotypeBuilder::getCandidateOverlaps(const std::vector<uint64_t>& kmer_codes) const
 {
-    // Get a list of vertices that have a k-mer match to this sequence.
+    // Collect every occurrence of the kmers of the sequence in the vertices still in the graph
+    std::vector<SharedKmerHit> hits;
+    for(size_t i = 0; i < kmer_codes.size(); ++i) 
+    {
+        if(kmer_codes[i] == INVALID_KMER_CODE)
+            continue;
+
+        HashMap<uint64_t, int>::const_iterator find_iter = m_kmer_vertex_map.find(kmer_codes[i]);
+        if(find_iter == m_kmer_vertex_map.end())
+            continue;
+
+        for(int oi = find_iter->second; oi != -1; oi = m_kmer_occurrences[oi].next)
+        {
+            const VertexKmerOccurrence& occurrence = m_kmer_occurrences[oi];
+            if(m_vertices[occurrence.vertex_index] == NULL)
+                continue;
+            SharedKmerHit hit = { occurrence.vertex_index, (int)occurrence.position - (int)i, i, occurrence.position };
+            hits.push_back(hit);
+        }
+    }
+
+    // A perfect overlap of minOverlap bases contains minOverlap - k + 1 kmers that are
+    // shared on the same diagonal. Vertices without this many kmers on any diagonal 
+    // cannot be connected to the sequence so they are not aligned.
+    int min_shared = m_parameters.minOverlap - (int)m_vertex_map_kmer + 1;
+    size_t min_diagonal_hits = min_shared > 1 ? min_shared : 1;
+
+    // Sort the hits by vertex and diagonal and take the best supported diagonal of each vertex
+    std::sort(hits.begin(), hits.end(), sortHitsByVertexDiagonal);
     SharedVertexKmerVector candidate_vertices;
-    const std::string sequence = incoming_vertex->getSeq().toString();
-    size_t nk = sequence.size() - m_vertex_map_kmer + 1;
-    for(size_t i = 0; i < nk; ++i) 
+    std::vector<size_t> kmer_indices;
+    std::vector<size_t> existing_indices;
+    size_t vertex_start = 0;
+    while(vertex_start < hits.size())
     {
-        std::string query_kmer = sequence.substr(i, m_vertex_map_kmer);
-        HashMap<std::string, StringVector>::iterator find_iter = m_kmer_vertex_id_cache.find(query_kmer);
-        if(find_iter != m_kmer_vertex_id_cache.end())
+        size_t vertex_end = vertex_start;
+        size_t best_start = vertex_start;
+        size_t best_end = vertex_start;
+        while(vertex_end < hits.size() && hits[vertex_end].vertex_index == hits[vertex_start].vertex_index)
         {
-            // Get the vertices for these ids
-            for(StringVector::iterator iter = find_iter->second.begin(); iter != find_iter->second.end(); ++iter)
+            size_t diagonal_end = vertex_end;
+            while(diagonal_end < hits.size() && 
+                  hits[diagonal_end].vertex_index == hits[vertex_end].vertex_index && 
+                  hits[diagonal_end].diagonal == hits[vertex_end].diagonal)
             {
-                Vertex* candidate = m_graph->getVertex(*iter);
-                if(candidate != NULL)
-                {
-                    SharedVertexKmer svk = { i, candidate };
-                    candidate_vertices.push_back(svk);
-                }
+                ++diagonal_end;
+            }
+
+            if(diagonal_end - vertex_end > best_end - best_start)
+            {
+                best_start = vertex_end;
+                best_end = diagonal_end;
             }
+            vertex_end = diagonal_end;
         }
+
+        if(best_end - best_start >= min_diagonal_hits)
+        {
+            // A kmer that is repeated in one of the sequences has more than
+            // one hit with the same position in the other sequence. Use the 
+            // first kmer on the diagonal that is unique as the seed.
+            kmer_indices.clear();
+            existing_indices.clear();
+            for(size_t i = vertex_start; i < vertex_end; ++i)
+            {
+                kmer_indices.push_back(hits[i].kmer_index);
+                existing_indices.push_back(hits[i].existing_index);
+            }
+            std::sort(kmer_indices.begin(), kmer_indices.end());
+            std::sort(existing_indices.begin(), existing_indices.end());
+
+            size_t seed_idx = best_start;
+            bool is_unique = false;
+            for(size_t i = best_start; i < best_end && !is_unique; ++i)
+            {
+                is_unique = std::upper_bound(kmer_indices.begin(), kmer_indices.end(), hits[i].kmer_index) - 
+                            std::lower_bound(kmer_indices.begin(), kmer_indices.end(), hits[i].kmer_index) == 1 &&
+                            std::upper_bound(existing_indices.begin(), existing_indices.end(), hits[i].existing_index) - 
+                            std::lower_bound(existing_indices.begin(), existing_indices.end(), hits[i].existing_index) == 1;
+                if(is_unique)
+                    seed_idx = i;
+            }
+
+            const SharedKmerHit& seed = hits[seed_idx];
+            SharedVertexKmer svk = { seed.vertex_index, seed.kmer_index, seed.existing_index, is_unique };
+            candidate_vertices.push_back(svk);
+        }
+        vertex_start = vertex_end;
     }
 
-    // Sort the vector by the vertex pointer and remove duplicates
-    // Remove duplicates from the candidate list
-    std::sort(candidate_vertices.begin(), candidate_vertices.end(), SharedVertexKmer::sortByVertex);
-    SharedVertexKmerVector::iterator new_end = std::unique(candidate_vertices.begin(), candidate_vertices.end(), SharedVertexKmer::equalByVertex);
-    candidate_vertices.resize(new_end - candidate_vertices.begin());
+    // Visit the candidates in the order of the vertices in memory, so the edges
+    // are added in the same order as when the candidates were sorted by vertex
+    std::sort(candidate_vertices.begin(), candidate_vertices.end(), CandidateVertexOrder(m_vertices));
     return candidate_vertices;
 }
 
 // 
-void OverlapHaplotypeBuilder::updateKmerVertexMap(const Vertex* incoming_vertex)
+void OverlapHaplotypeBuilder::updateKmerVertexMap(size_t vertex_index, const std::vector<uint64_t>& kmer_codes)
 {
-    const std::string sequence = incoming_vertex->getSeq().toString();
-    size_t nk = sequence.size() - m_vertex_map_kmer + 1;
-
     // Insert kmers into the kmer pointer cache
-    for(size_t i = 0; i < nk; ++i) 
+    for(size_t i = 0; i < kmer_codes.size(); ++i) 
+    {
+        if(kmer_codes[i] == INVALID_KMER_CODE)
+            continue;
+
+        std::pair<HashMap<uint64_t, int>::iterator, bool> result = 
+            m_kmer_vertex_map.insert(std::make_pair(kmer_codes[i], -1));
+
+        VertexKmerOccurrence occurrence = { vertex_index, i, result.first->second };
+        result.first->second = m_kmer_occurrences.size();
+        m_kmer_occurrences.push_back(occurrence);
+    }
+}
+
+//
+void OverlapHaplotypeBuilder::syncVertexIndex()
+{
+    HashSet<const Vertex*> graph_vertices;
+    VertexPtrVec vertices = m_graph->getAllVertices();
+    graph_vertices.insert(vertices.begin(), vertices.end());
+
+    for(size_t i = 0; i < m_vertices.size(); ++i)
     {
-        std::string query_kmer = sequence.substr(i, m_vertex_map_kmer);
-        m_kmer_vertex_id_cache[query_kmer].push_back(incoming_vertex->getID());
+        if(m_vertices[i] != NULL && graph_vertices.find(m_vertices[i]) == graph_vertices.end())
+        {
+            m_vertex_index.erase(m_vertices[i]);
+            m_vertices[i] = NULL;
+        }
     }
 }
 
@@ -374,6 +538,7 @@ void OverlapHaplotypeBuilder::checkWalks(StringVector* walk_strings)
 #endif
 
     //
+    SGSearchNodePool searchPool;
     for(size_t i = 0; i < left_join_vertices.size(); ++i)
     {
         for(size_t j = 0; j < right_join_vertices.size(); ++j)
@@ -385,7 +550,7 @@ void OverlapHaplotypeBuilder::checkWalks(StringVector* walk_strings)
 
             // Try to find a walk between this pair of join vertices
             SGWalkVector walks;
-            SGSearch::findWalks(left_join_vertices[i], right_join_vertices[j], ED_SENSE, 2000, 10000, true, walks);
+            SGSearch::findWalks(left_join_vertices[i], right_join_vertices[j], ED_SENSE, 2000, 10000, true, walks, &searchPool);
 
             if(!walks.empty())
             {
@@ -482,8 +647,8 @@ ExtendableTipVector OverlapHaplotypeBuilder::findTips() const
             Edge* xy = x_edges[j];
 
             // Do not count edges to duplicate vertices
-            Overlap o = xy->getOverlap();
-            if(!o.isContainment())
+            bool is_containment = xy->getMatchCoord().isContained() || xy->getTwin()->getMatchCoord().isContained();
+            if(!is_containment)
                 edge_count[xy->getDir()]++;
         }
 
@@ -491,15 +656,18 @@ ExtendableTipVector OverlapHaplotypeBuilder::findTips() const
         if(edge_count[ED_SENSE] == 0 && edge_count[ED_ANTISENSE] == 0)
             continue;
 
+        HashMap<const Vertex*, size_t>::const_iterator index_iter = m_vertex_index.find(x);
+        assert(index_iter != m_vertex_index.end());
+
         if(edge_count[ED_SENSE] == 0)
         {
-            ExtendableTip tip = { x->getID(), ED_SENSE };
+            ExtendableTip tip = { index_iter->second, ED_SENSE };
             tips.push_back(tip);
         }
 
         if(edge_count[ED_ANTISENSE] == 0)
         {
-            ExtendableTip tip = { x->getID(), ED_ANTISENSE };
+            ExtendableTip tip = { index_iter->second, ED_ANTISENSE };
             tips.push_back(tip);
         }
     }
@@ -507,8 +675,10 @@ ExtendableTipVector OverlapHaplotypeBuilder::findTips() const
 }
 
 //
-void OverlapHaplotypeBuilder::trimTip(Vertex* x, EdgeDir direction)
+void OverlapHaplotypeBuilder::trimTip(size_t vertex_index, EdgeDir direction)
 {
+    Vertex* x = m_vertices[vertex_index];
+
     // Check if we should recurse to the neighbors of x
     EdgePtrVec x_opp_edges = x->getEdges(!direction);
     
@@ -519,6 +689,8 @@ void OverlapHaplotypeBuilder::trimTip(Vertex* x, EdgeDir direction)
     */
 
     // Remove x from the graph
+    m_vertex_index.erase(x);
+    m_vertices[vertex_index] = NULL;
     m_graph->removeConnectedVertex(x);
 
     /*
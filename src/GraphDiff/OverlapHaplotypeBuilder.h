@@ -23,21 +23,35 @@
 #include "SGWalk.h"
 #include <queue>
 
-// A struct holding a kmer that is shared between two reads
+// A vertex of the graph that shares k-mers with an incoming sequence.
+// The seed is a shared k-mer on the diagonal supported by the most
+// shared k-mers, given by its position in both sequences.
 struct SharedVertexKmer
 {
+    size_t vertex_index;
     size_t kmer_index;
-    Vertex* vertex;
+    size_t existing_index;
 
-    static bool sortByVertex(const SharedVertexKmer& a, const SharedVertexKmer& b) { return a.vertex < b.vertex; }
-    static bool equalByVertex(const SharedVertexKmer& a, const SharedVertexKmer& b) { return a.vertex == b.vertex; }
+    // True if the seed k-mer occurs once in each sequence
+    bool is_unique;
 };
 typedef std::vector<SharedVertexKmer> SharedVertexKmerVector;
 
+// An occurrence of an indexed k-mer in a vertex sequence. The
+// occurrences of a k-mer are chained through next, which is -1
+// for the last occurrence.
+struct VertexKmerOccurrence
+{
+    size_t vertex_index;
+    size_t position;
+    int next;
+};
+typedef std::vector<VertexKmerOccurrence> VertexKmerOccurrenceVector;
+
 // A tip in the graph that can be extended
 struct ExtendableTip
 {
-    std::string id;
+    size_t vertex_index;
     EdgeDir direction;
 };
 typedef std::vector<ExtendableTip> ExtendableTipVector;
@@ -80,14 +94,19 @@ class OverlapHaplotypeBuilder
         void extendGraph();
 
         // Insert a new vertex into the graph with the specified sequence
-        void insertVertexIntoGraph(const std::string& prefix, const std::string& sequence);
+        void insertVertexIntoGraph(const char* prefix, const std::string& sequence);
 
         // Use the kmer to vertex map to find vertices in the graph that possibly
-        // overlap the incoming vertex
-        SharedVertexKmerVector getCandidateOverlaps(const Vertex* incoming_vertex);
+        // overlap the incoming sequence, given by the codes of its kmers. 
+        // Only vertices that share enough kmers on a single diagonal to have
+        // a perfect overlap of at least minOverlap bases are returned.
+        SharedVertexKmerVector getCandidateOverlaps(const std::vector<uint64_t>& kmer_codes) const;
 
         // Update the kmer to vertex map to include kmers for the new vertex
-        void updateKmerVertexMap(const Vertex* incoming_vertex);
+        void updateKmerVertexMap(size_t vertex_index, const std::vector<uint64_t>& kmer_codes);
+
+        // Clear the entries of m_vertices for vertices that are no longer in the graph
+        void syncVertexIndex();
 
         // Find corrected reads that share a perfect overlap to the input sequence
         StringVector getCorrectedOverlaps(const std::string& sequence, EdgeDir direction);
@@ -96,7 +115,7 @@ class OverlapHaplotypeBuilder
         ExtendableTipVector findTips() const;
 
         // Trim a tip off the graph.
-        void trimTip(Vertex* x, EdgeDir direction);
+        void trimTip(size_t vertex_index, EdgeDir direction);
 
         // Returns true if the sequence represents a junction in the variation graph
         bool isJoinSequence(const std::string& sequence, EdgeDir dir);
@@ -122,20 +141,28 @@ class OverlapHaplotypeBuilder
         GraphCompareParameters m_parameters;
         ErrorCorrectProcess* m_corrector;
         StringGraph* m_graph;
-        size_t m_numReads;
 
         std::string m_initial_kmer_string;
 
-        // Cache the sequences of reads in the graph to avoid adding redundant reads
-        HashSet<std::string> m_used_reads;
+        // The vertices of the graph in the order they were inserted. The index of a
+        // vertex in this vector is used as its handle. Vertices that have been removed
+        // from the graph are NULL but their sequences are kept.
+        VertexPtrVec m_vertices;
+        StringVector m_vertex_sequences;
+        HashMap<const Vertex*, size_t> m_vertex_index;
+
+        // Map from the hash of a read sequence to the first vertex with that sequence.
+        // This is used to avoid adding redundant reads.
+        HashMap<uint64_t, size_t> m_used_reads;
 
         // Cache the corrected sequences for reads in the graph. Since we may visit the same
         // raw sequence multiple times, this lets us avoid redundantly correcting the reads.
         HashMap<std::string, std::string> m_correction_cache;
 
-        // A map from kmer to vertex ids. We use this when inserting new reads into the graph to avoid
-        // comparing incoming reads against everything
-        HashMap<std::string, StringVector> m_kmer_vertex_id_cache;
+        // A map from 2-bit encoded kmer to the first of its occurrences in the vertices. We use 
+        // this when inserting new reads into the graph to avoid comparing incoming reads against everything
+        HashMap<uint64_t, int> m_kmer_vertex_map;
+        VertexKmerOccurrenceVector m_kmer_occurrences;
         static const size_t m_vertex_map_kmer = 31;
 };
 
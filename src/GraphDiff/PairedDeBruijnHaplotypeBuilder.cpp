@@ -21,7 +21,8 @@
 //
 //
 //
-PairedDeBruijnHaplotypeBuilder::PairedDeBruijnHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params)
+PairedDeBruijnHaplotypeBuilder::PairedDeBruijnHaplotypeBuilder(const GraphCompareParameters& params) : m_parameters(params),
+                                                                                                        m_navigator(params.variantIndex.pBWT, NULL, params.variantIndex.pCache)
 {
 
 }
@@ -36,6 +37,7 @@ PairedDeBruijnHaplotypeBuilder::~PairedDeBruijnHaplotypeBuilder()
 void PairedDeBruijnHaplotypeBuilder::setInitialHaplotype(const std::string& str)
 {
     m_startingKmer = str;
+    m_navigator.clear();
 }
 
 // Run the bubble construction process
@@ -67,7 +69,10 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
     selectGuideAndTargetKmers(reverseComplement(m_startingKmer), true, guide, target_set);
 
     if(Verbosity::Instance().getPrintLevel() > 3)
+    {
         printf("PairedDBGHaplotype: found %zu targets\n", target_set.size());
+        guide.printStats();
+    }
 
     if(target_set.empty())
         return HBRC_OK;
@@ -104,7 +109,7 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
 
         // Calculate de Bruijn extensions for this node
         std::string vertStr = curr.pVertex->getSeq().toString();
-        AlphaCount64 extensionCounts = BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(vertStr, m_parameters.variantIndex.pBWT, curr.direction);
+        AlphaCount64 extensionCounts = m_navigator.getExtensions(vertStr, curr.direction);
 
         // Check whether to accept this edge into the graph
         // We currently only use the counts and not the guide kmers
@@ -178,6 +183,7 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
     // If the graph construction was successful, walk the graph
     // between the endpoints to make a string
     // Generate haplotypes between every pair of antisense/sense join vertices
+    SGSearchNodePool searchPool;
     for(size_t i = 0; i < antisense_join_vector.size(); ++i) {
         for(size_t j = 0; j < sense_join_vector.size(); ++j) {
             SGWalkVector outWalks;
@@ -187,7 +193,8 @@ HaplotypeBuilderReturnCode PairedDeBruijnHaplotypeBuilder::run(StringVector& out
                                 100000, // max distance to search
                                 10000, // max nodes to search
                                 true, // exhaustive search
-                                outWalks);
+                                outWalks,
+                                &searchPool);
 
             for(size_t k = 0; k < outWalks.size(); ++k)
             {
@@ -23,6 +23,7 @@
 #include "ErrorCorrectProcess.h"
 #include "SGWalk.h"
 #include "DBGPathGuide.h"
+#include "DBGNavigator.h"
 #include <queue>
 
 // Build haplotypes starting from a given sequence.
@@ -53,6 +54,9 @@ class PairedDeBruijnHaplotypeBuilder
         //
         GraphCompareParameters m_parameters;
         std::string m_startingKmer;
+
+        // The implicit graph of the variant reads
+        DBGNavigator m_navigator;
 };
 
 #endif
@@ -26,6 +26,7 @@
 #define RSAI_EXT ".rsai"
 #define SSA_EXT ".ssa"
 #define POPIDX_EXT ".popidx"
+#define MZI_EXT ".mzi"
 
 // Default values
 #define DEFAULT_MIN_OVERLAP 45
@@ -44,6 +44,7 @@ static const char *ASSEMBLE_USAGE_MESSAGE =
 "      -g, --max-gap-divergence=F       only remove variation if the divergence between sequences when only counting indels is less than F (default: 0.01)\n"
 "                                       Setting this to 0.0 will suppress removing indel variation\n"
 "          --max-indel=D                do not remove variation that is an indel of length greater than D (default: 20)\n"
+"      -t, --threads=NUM                use NUM threads to find bubbles (default: 1)\n"
 "\n"
 "\nTrimming parameters:\n"
 "      -x, --cut-terminal=N             cut off terminal branches in N rounds (default: 10)\n"
@@ -77,6 +78,7 @@ namespace opt
     static double maxBubbleDivergence = 0.05f;
     static double maxBubbleGapDivergence = 0.01f;
     static int maxIndelLength = 20;
+    static int numThreads = 1;
 
     // 
     static bool bValidate;
@@ -84,7 +86,7 @@ namespace opt
     static bool bPerformTR = false;
 }
 
-static const char* shortopts = "p:o:m:d:g:b:a:r:x:l:sv";
+static const char* shortopts = "p:o:m:d:g:b:a:r:x:l:t:sv";
 
 enum { OPT_HELP = 1, OPT_VERSION, OPT_VALIDATE, OPT_EDGESTATS, OPT_EXACT, OPT_MAXINDEL, OPT_TR, OPT_MAXEDGES };
 
@@ -99,6 +101,7 @@ static const struct option longopts[] = {
     { "max-divergence",        required_argument, NULL, 'd' },
     { "max-gap-divergence",    required_argument, NULL, 'g' },
     { "max-indel",             required_argument, NULL, OPT_MAXINDEL },
+    { "threads",               required_argument, NULL, 't' },
     { "max-edges",             required_argument, NULL, OPT_MAXEDGES },
     { "smooth",                no_argument,       NULL, 's' },
     { "transitive-reduction",  no_argument,       NULL, OPT_TR },
@@ -146,6 +149,7 @@ void assemble()
     std::cout << "Removing contained vertices from graph\n";
     while(pGraph->hasContainment())
         pGraph->visit(containVisit);
+    std::cout << "Inferred " << containVisit.getCost() << " overlaps while remodelling the graph\n";
 
     // Pre-assembly graph stats
     std::cout << "[Stats] After removing contained vertices:\n";
@@ -165,6 +169,7 @@ void assemble()
     {
         std::cout << "Validating graph structure\n";
         pGraph->visit(validationVisit);
+        std::cout << "Inferred " << validationVisit.getCost() << " overlaps while validating the graph\n";
     }
 
     // Remove dead-end branches from the graph
@@ -198,7 +203,7 @@ void assemble()
     if(opt::numBubbleRounds > 0)
     {
         std::cout << "\nPerforming variation smoothing\n";
-        SGSmoothingVisitor smoothingVisit(opt::outVariantsFile, opt::maxBubbleGapDivergence, opt::maxBubbleDivergence, opt::maxIndelLength);
+        SGSmoothingVisitor smoothingVisit(opt::outVariantsFile, opt::maxBubbleGapDivergence, opt::maxBubbleDivergence, opt::maxIndelLength, opt::numThreads);
         int numSmooth = opt::numBubbleRounds;
         while(numSmooth-- > 0)
             pGraph->visit(smoothingVisit);
@@ -247,6 +252,7 @@ void parseAssembleOptions(int argc, char** argv)
             case 's': opt::bSmoothGraph = true; break;
             case 'x': arg >> opt::numTrimRounds; break;
             case 'r': arg >> opt::resolveSmallRepeatLen; break;
+            case 't': arg >> opt::numThreads; break;
             case OPT_MAXEDGES: arg >> opt::maxEdges; break;
             case OPT_TR: opt::bPerformTR = true; break;
             case OPT_MAXINDEL: arg >> opt::maxIndelLength; break;
@@ -279,6 +285,12 @@ void parseAssembleOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
     if (die) 
     {
         std::cout << "\n" << ASSEMBLE_USAGE_MESSAGE;
@@ -0,0 +1,325 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// bench-fm - Measure the speed of the FM-index
+// queries under the current memory policy
+//
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include "SGACommon.h"
+#include "Util.h"
+#include "bench-fm.h"
+#include "BWT.h"
+#include "BWTAlgorithms.h"
+#include "BWTIntervalCache.h"
+#include "SampledSuffixArray.h"
+#include "MemoryPolicy.h"
+#include "Profiler.h"
+#include "Timer.h"
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
+//
+// Getopt
+//
+#define SUBPROGRAM "bench-fm"
+
+static const char *BENCHFM_VERSION_MESSAGE =
+SUBPROGRAM " Version " PACKAGE_VERSION "\n"
+"Written by agent.\n"
+"\n"
+"Copyright 2026 agent\n";
+
+static const char *BENCHFM_USAGE_MESSAGE =
+"Usage: " PACKAGE_NAME " " SUBPROGRAM " [OPTION] ... READSFILE\n"
+"Measure the speed of the FM-index of READSFILE. The index is queried with rank\n"
+"lookups at random positions, backwards searches of k-mers sampled from the index\n"
+"and, if the sampled suffix array is available, suffix array lookups.\n"
+"Run with the global --hugepages, --numa and --pin-threads options to compare the memory policies.\n"
+"\n"
+"  -v, --verbose                        display verbose output\n"
+"      --help                           display this help and exit\n"
+"  -t, --threads=NUM                    use NUM threads (default: 1)\n"
+"  -p, --prefix=PREFIX                  use PREFIX for the names of the index files (default: prefix of the input file)\n"
+"  -d, --sample-rate=N                  use occurrence array sample rate of N in the FM-index (default: 128)\n"
+"  -n, --rank-queries=N                 perform N rank lookups (default: 10000000)\n"
+"  -m, --search-queries=N               perform N k-mer searches (default: 1000000)\n"
+"  -k, --kmer-size=K                    search for k-mers of length K (default: 31)\n"
+"  -c, --cache-length=N                 cache the intervals of all N-mers (default: 0, no cache)\n"
+"  -s, --seed=N                         seed the random positions with N (default: 1)\n"
+"      --sa                             also perform suffix array lookups using PREFIX.ssa\n"
+"\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
+
+namespace opt
+{
+    static unsigned int verbose;
+    static int numThreads = 1;
+    static std::string prefix;
+    static std::string readsFile;
+    static int sampleRate = BWT::DEFAULT_SAMPLE_RATE_SMALL;
+    static size_t numRankQueries = 10000000;
+    static size_t numSearchQueries = 1000000;
+    static int kmerLength = 31;
+    static int cacheLength = 0;
+    static unsigned int seed = 1;
+    static bool benchSA = false;
+}
+
+static const char* shortopts = "t:p:d:n:m:k:c:s:v";
+
+enum { OPT_HELP = 1, OPT_VERSION, OPT_SA };
+
+static const struct option longopts[] = {
+    { "verbose",        no_argument,       NULL, 'v' },
+    { "threads",        required_argument, NULL, 't' },
+    { "prefix",         required_argument, NULL, 'p' },
+    { "sample-rate",    required_argument, NULL, 'd' },
+    { "rank-queries",   required_argument, NULL, 'n' },
+    { "search-queries", required_argument, NULL, 'm' },
+    { "kmer-size",      required_argument, NULL, 'k' },
+    { "cache-length",   required_argument, NULL, 'c' },
+    { "seed",           required_argument, NULL, 's' },
+    { "sa",             no_argument,       NULL, OPT_SA },
+    { "help",           no_argument,       NULL, OPT_HELP },
+    { "version",        no_argument,       NULL, OPT_VERSION },
+    { NULL, 0, NULL, 0 }
+};
+
+// Returns a random position in [0, n)
+static inline size_t randomPosition(unsigned int* pSeed, size_t n)
+{
+    uint64_t r = ((uint64_t)rand_r(pSeed) << 31) ^ (uint64_t)rand_r(pSeed);
+    return r % n;
+}
+
+// Extract a k-mer that occurs in the indexed strings by stepping backwards
+// through the BWT from position. Returns false if the walk reached the start of a string
+static bool sampleKmer(const BWT* pBWT, size_t position, std::string& out)
+{
+    out.resize(opt::kmerLength);
+    for(int i = opt::kmerLength - 1; i >= 0; --i)
+    {
+        char b = pBWT->getChar(position);
+        if(b == '$')
+            return false;
+        out[i] = b;
+        position = pBWT->getPC(b) + pBWT->getOcc(b, position) - 1;
+    }
+    return true;
+}
+
+// Pin the threads of the team, if enabled
+static void pinThreads()
+{
+#if HAVE_OPENMP
+    if(MemoryPolicy::getPinThreads())
+    {
+        #pragma omp parallel
+        MemoryPolicy::pinThread(omp_get_thread_num());
+    }
+#endif
+}
+
+//
+static void printResult(const char* name, size_t numQueries, double seconds)
+{
+    printf("%s: %zu queries in %.3lfs (%.1lf ns/query, %.2lf million queries/s)\n",
+           name, numQueries, seconds, seconds * 1000000000 / numQueries, numQueries / seconds / 1000000);
+}
+
+//
+static void benchRank(const BWT* pBWT, const std::vector<size_t>& positions)
+{
+    PROFILE_FUNC("bench-fm::rank")
+    Timer timer("bench-fm::rank", true);
+    uint64_t sum = 0;
+
+    #pragma omp parallel for reduction(+:sum)
+    for(int64_t i = 0; i < (int64_t)positions.size(); ++i)
+        sum += pBWT->getFullOcc(positions[i]).getSum();
+
+    printResult("rank", positions.size(), timer.getElapsedWallTime());
+
+    // Use the result so the queries are not optimized away
+    if(opt::verbose > 0)
+        printf("rank checksum: %llu\n", (unsigned long long)sum);
+}
+
+//
+static void benchSearch(const BWT* pBWT, const BWTIntervalCache* pCache, const std::vector<std::string>& kmers)
+{
+    PROFILE_FUNC("bench-fm::search")
+    Timer timer("bench-fm::search", true);
+    uint64_t found = 0;
+
+    #pragma omp parallel for reduction(+:found)
+    for(int64_t i = 0; i < (int64_t)kmers.size(); ++i)
+    {
+        BWTInterval interval = pCache != NULL ? BWTAlgorithms::findIntervalWithCache(pBWT, pCache, kmers[i]) :
+                                                BWTAlgorithms::findInterval(pBWT, kmers[i]);
+        found += interval.isValid() ? 1 : 0;
+    }
+
+    printResult("search", kmers.size(), timer.getElapsedWallTime());
+
+    // Every k-mer was sampled from the index so all should be found
+    if(found != kmers.size())
+        std::cerr << "Warning: " << kmers.size() - found << " sampled k-mers were not found in the index\n";
+}
+
+//
+static void benchSA(const BWT* pBWT, const SampledSuffixArray* pSSA, const std::vector<size_t>& positions)
+{
+    PROFILE_FUNC("bench-fm::sa")
+    Timer timer("bench-fm::sa", true);
+    uint64_t sum = 0;
+
+    #pragma omp parallel for reduction(+:sum)
+    for(int64_t i = 0; i < (int64_t)positions.size(); ++i)
+        sum += pSSA->calcSA(positions[i], pBWT).getPos();
+
+    printResult("sa", positions.size(), timer.getElapsedWallTime());
+    if(opt::verbose > 0)
+        printf("sa checksum: %llu\n", (unsigned long long)sum);
+}
+
+//
+int benchFMMain(int argc, char** argv)
+{
+    parseBenchFMOptions(argc, argv);
+
+#if HAVE_OPENMP
+    omp_set_num_threads(opt::numThreads);
+#endif
+    pinThreads();
+
+    printf("[%s] %s threads=%d\n", SUBPROGRAM, MemoryPolicy::getDescription().c_str(), opt::numThreads);
+
+    Timer* pLoadTimer = new Timer("bench-fm::load", true);
+    BWT* pBWT = new BWT(opt::prefix + BWT_EXT, opt::sampleRate);
+    BWTIntervalCache* pCache = opt::cacheLength > 0 ? new BWTIntervalCache(opt::cacheLength, pBWT) : NULL;
+    SampledSuffixArray* pSSA = opt::benchSA ? new SampledSuffixArray(opt::prefix + SSA_EXT) : NULL;
+    printf("load: %.3lfs\n", pLoadTimer->getElapsedWallTime());
+    delete pLoadTimer;
+
+    if(opt::verbose > 0)
+        pBWT->printInfo();
+
+    // Draw the query positions and k-mers before timing
+    unsigned int seed = opt::seed;
+    size_t n = pBWT->getBWLen();
+    std::vector<size_t> positions(opt::numRankQueries);
+    for(size_t i = 0; i < positions.size(); ++i)
+        positions[i] = randomPosition(&seed, n);
+
+    std::vector<std::string> kmers;
+    kmers.reserve(opt::numSearchQueries);
+    std::string kmer;
+    size_t attempts = 0;
+    while(kmers.size() < opt::numSearchQueries && attempts++ < 100 * opt::numSearchQueries)
+    {
+        if(sampleKmer(pBWT, randomPosition(&seed, n), kmer))
+            kmers.push_back(kmer);
+    }
+
+    if(kmers.size() < opt::numSearchQueries)
+        std::cerr << "Warning: only " << kmers.size() << " k-mers could be sampled from the index\n";
+
+    if(!positions.empty())
+        benchRank(pBWT, positions);
+    if(!kmers.empty())
+        benchSearch(pBWT, pCache, kmers);
+    if(pSSA != NULL && !positions.empty())
+        benchSA(pBWT, pSSA, positions);
+
+    delete pSSA;
+    delete pCache;
+    delete pBWT;
+    return 0;
+}
+
+//
+// Handle command line arguments
+//
+void parseBenchFMOptions(int argc, char** argv)
+{
+    bool die = false;
+    for (char c; (c = getopt_long(argc, argv, shortopts, longopts, NULL)) != -1;)
+    {
+        std::istringstream arg(optarg != NULL ? optarg : "");
+        switch (c)
+        {
+            case 't': arg >> opt::numThreads; break;
+            case 'p': arg >> opt::prefix; break;
+            case 'd': arg >> opt::sampleRate; break;
+            case 'n': arg >> opt::numRankQueries; break;
+            case 'm': arg >> opt::numSearchQueries; break;
+            case 'k': arg >> opt::kmerLength; break;
+            case 'c': arg >> opt::cacheLength; break;
+            case 's': arg >> opt::seed; break;
+            case OPT_SA: opt::benchSA = true; break;
+            case '?': die = true; break;
+            case 'v': opt::verbose++; break;
+            case OPT_HELP:
+                std::cout << BENCHFM_USAGE_MESSAGE;
+                exit(EXIT_SUCCESS);
+            case OPT_VERSION:
+                std::cout << BENCHFM_VERSION_MESSAGE;
+                exit(EXIT_SUCCESS);
+        }
+    }
+
+    if (argc - optind < 1)
+    {
+        std::cerr << SUBPROGRAM ": missing arguments\n";
+        die = true;
+    }
+    else if (argc - optind > 1)
+    {
+        std::cerr << SUBPROGRAM ": too many arguments\n";
+        die = true;
+    }
+
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
+    if(opt::kmerLength <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid k-mer length: " << opt::kmerLength << ", must be greater than zero\n";
+        die = true;
+    }
+
+    if(opt::cacheLength < 0 || opt::cacheLength > opt::kmerLength)
+    {
+        std::cerr << SUBPROGRAM ": invalid cache length: " << opt::cacheLength << ", must be between 0 and the k-mer length\n";
+        die = true;
+    }
+
+#if !HAVE_OPENMP
+    if(opt::numThreads > 1)
+    {
+        std::cerr << SUBPROGRAM ": multiple threads requested but OpenMP is not available\n";
+        die = true;
+    }
+#endif
+
+    if (die)
+    {
+        std::cout << "\n" << BENCHFM_USAGE_MESSAGE;
+        exit(EXIT_FAILURE);
+    }
+
+    // Parse the input filenames
+    opt::readsFile = argv[optind++];
+    if(opt::prefix.empty())
+        opt::prefix = stripFilename(opt::readsFile);
+}
@@ -0,0 +1,18 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// bench-fm - Measure the speed of the FM-index
+// queries under the current memory policy
+//
+#ifndef BENCHFM_H
+#define BENCHFM_H
+#include <getopt.h>
+#include "config.h"
+
+int benchFMMain(int argc, char** argv);
+void parseBenchFMOptions(int argc, char** argv);
+
+#endif
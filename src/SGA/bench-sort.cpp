@@ -0,0 +1,207 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// bench-sort - Measure how the suffix sort
+// scales with the number of threads
+//
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include "SGACommon.h"
+#include "Util.h"
+#include "bench-sort.h"
+#include "ReadTable.h"
+#include "SuffixArray.h"
+#include "Profiler.h"
+#include "Timer.h"
+
+//
+// Getopt
+//
+#define SUBPROGRAM "bench-sort"
+
+static const char *BENCHSORT_VERSION_MESSAGE =
+SUBPROGRAM " Version " PACKAGE_VERSION "\n"
+"Written by agent.\n"
+"\n"
+"Copyright 2026 agent\n";
+
+static const char *BENCHSORT_USAGE_MESSAGE =
+"Usage: " PACKAGE_NAME " " SUBPROGRAM " [OPTION] ... READSFILE\n"
+"Measure the time taken to construct the suffix array of READSFILE with each\n"
+"of the given numbers of threads. The suffix arrays are checked to be identical.\n"
+"\n"
+"  -v, --verbose                        display verbose output\n"
+"      --help                           display this help and exit\n"
+"  -t, --threads=LIST                   sort with each number of threads in the comma-separated LIST (default: 1,2,4,8)\n"
+"  -r, --repeat=N                       sort N times with each number of threads and report the fastest (default: 1)\n"
+"\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
+
+namespace opt
+{
+    static unsigned int verbose;
+    static std::vector<int> threadCounts;
+    static int numRepeats = 1;
+    static std::string readsFile;
+}
+
+static const char* shortopts = "t:r:v";
+
+enum { OPT_HELP = 1, OPT_VERSION };
+
+static const struct option longopts[] = {
+    { "verbose",        no_argument,       NULL, 'v' },
+    { "threads",        required_argument, NULL, 't' },
+    { "repeat",         required_argument, NULL, 'r' },
+    { "help",           no_argument,       NULL, OPT_HELP },
+    { "version",        no_argument,       NULL, OPT_VERSION },
+    { NULL, 0, NULL, 0 }
+};
+
+// Returns true if the two suffix arrays contain the same elements in the same order
+static bool isSameSuffixArray(const SuffixArray* pA, const SuffixArray* pB)
+{
+    if(pA->getSize() != pB->getSize())
+        return false;
+
+    for(size_t i = 0; i < pA->getSize(); ++i)
+    {
+        const SAElem& a = pA->get(i);
+        const SAElem& b = pB->get(i);
+        if(a.getID() != b.getID() || a.getPos() != b.getPos())
+            return false;
+    }
+    return true;
+}
+
+//
+int benchSortMain(int argc, char** argv)
+{
+    parseBenchSortOptions(argc, argv);
+
+    Timer* pLoadTimer = new Timer("bench-sort::load", true);
+    ReadTable* pRT = new ReadTable(opt::readsFile);
+    printf("load: %zu reads, %zu symbols in %.3lfs\n", pRT->getCount(), pRT->countSumLengths(), pLoadTimer->getElapsedWallTime());
+    delete pLoadTimer;
+
+    // The suffix array of the first thread count is the reference for the others
+    SuffixArray* pReferenceSA = NULL;
+    double referenceTime = 0.0f;
+    bool allSame = true;
+
+    for(size_t i = 0; i < opt::threadCounts.size(); ++i)
+    {
+        int numThreads = opt::threadCounts[i];
+        double bestTime = 0.0f;
+        for(int j = 0; j < opt::numRepeats; ++j)
+        {
+            PROFILE_FUNC("bench-sort::sort")
+            Timer timer("bench-sort::sort", true);
+            SuffixArray* pSA = new SuffixArray(pRT, numThreads, opt::verbose == 0);
+            double seconds = timer.getElapsedWallTime();
+            if(j == 0 || seconds < bestTime)
+                bestTime = seconds;
+
+            if(pReferenceSA == NULL)
+            {
+                pReferenceSA = pSA;
+            }
+            else
+            {
+                if(!isSameSuffixArray(pReferenceSA, pSA))
+                {
+                    std::cerr << "Error: the suffix array built with " << numThreads << " threads differs from the one built with "
+                              << opt::threadCounts[0] << " threads\n";
+                    allSame = false;
+                }
+                delete pSA;
+            }
+        }
+
+        if(i == 0)
+            referenceTime = bestTime;
+        printf("threads=%d: %.3lfs (%.2lfx speedup)\n", numThreads, bestTime, referenceTime / bestTime);
+    }
+
+    delete pReferenceSA;
+    delete pRT;
+
+    if(!allSame)
+        exit(EXIT_FAILURE);
+    return 0;
+}
+
+//
+// Handle command line arguments
+//
+void parseBenchSortOptions(int argc, char** argv)
+{
+    std::string threadList = "1,2,4,8";
+    bool die = false;
+    for (char c; (c = getopt_long(argc, argv, shortopts, longopts, NULL)) != -1;)
+    {
+        std::istringstream arg(optarg != NULL ? optarg : "");
+        switch (c)
+        {
+            case 't': arg >> threadList; break;
+            case 'r': arg >> opt::numRepeats; break;
+            case '?': die = true; break;
+            case 'v': opt::verbose++; break;
+            case OPT_HELP:
+                std::cout << BENCHSORT_USAGE_MESSAGE;
+                exit(EXIT_SUCCESS);
+            case OPT_VERSION:
+                std::cout << BENCHSORT_VERSION_MESSAGE;
+                exit(EXIT_SUCCESS);
+        }
+    }
+
+    if (argc - optind < 1)
+    {
+        std::cerr << SUBPROGRAM ": missing arguments\n";
+        die = true;
+    }
+    else if (argc - optind > 1)
+    {
+        std::cerr << SUBPROGRAM ": too many arguments\n";
+        die = true;
+    }
+
+    StringVector fields = split(threadList, ',');
+    for(size_t i = 0; i < fields.size(); ++i)
+    {
+        std::istringstream parser(fields[i]);
+        int numThreads = 0;
+        parser >> numThreads;
+        if(numThreads <= 0)
+        {
+            std::cerr << SUBPROGRAM ": invalid number of threads: " << fields[i] << "\n";
+            die = true;
+        }
+        opt::threadCounts.push_back(numThreads);
+    }
+
+    if(opt::threadCounts.empty())
+    {
+        std::cerr << SUBPROGRAM ": no thread counts given\n";
+        die = true;
+    }
+
+    if(opt::numRepeats <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of repeats: " << opt::numRepeats << "\n";
+        die = true;
+    }
+
+    if (die)
+    {
+        std::cout << "\n" << BENCHSORT_USAGE_MESSAGE;
+        exit(EXIT_FAILURE);
+    }
+
+    // Parse the input filenames
+    opt::readsFile = argv[optind++];
+}
@@ -0,0 +1,18 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// bench-sort - Measure how the suffix sort
+// scales with the number of threads
+//
+#ifndef BENCHSORT_H
+#define BENCHSORT_H
+#include <getopt.h>
+#include "config.h"
+
+int benchSortMain(int argc, char** argv);
+void parseBenchSortOptions(int argc, char** argv);
+
+#endif
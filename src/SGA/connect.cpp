@@ -199,6 +199,7 @@ int connectMain(int argc, char** argv)
     bool done = false;
 
     const BamTools::RefVector& referenceVector = pBamReader->GetReferenceData();
+    SGSearchNodePool searchPool;
     while(!done)
     {
         // Read a pair from the BAM
@@ -275,7 +276,7 @@ int connectMain(int argc, char** argv)
         int maxWalkDistance = opt::maxDistance - coveredX;
 
         SGWalkVector walks;
-        SGSearch::findWalks(pX, pY, walkDirectionXOut, maxWalkDistance, 10000, true, walks);
+        SGSearch::findWalks(pX, pY, walkDirectionXOut, maxWalkDistance, 10000, true, walks, &searchPool);
 
         // Mark used vertices in the graph
         // If the entire path was resolved, mark black
@@ -296,16 +297,15 @@ int connectMain(int argc, char** argv)
                 bool correctOrientation = true;
                 WARN_ONCE("check orientation of result");
 
-                std::string fragment = walks[i].getFragmentString(pX, 
-                                                                  pY, 
-                                                                  fromX,
-                                                                  toY,
-                                                                  walkDirectionXOut,
-                                                                  walkDirectionYIn);
-
-                // Calculate the seqcoord on the path string representing the paired end fragment
-                int fragSize = fragment.length();
-                bool correctSize = !fragment.empty();
+                // Calculate the size of the paired end fragment on the path.
+                // The fragment string is only built if the size is in range.
+                int fragSize = walks[i].getFragmentLength(pX, 
+                                                          pY, 
+                                                          fromX,
+                                                          toY,
+                                                          walkDirectionXOut,
+                                                          walkDirectionYIn);
+                bool correctSize = fragSize > 0;
 
                 if(fragSize < opt::minDistance)
                 {
@@ -322,6 +322,12 @@ int connectMain(int argc, char** argv)
 
                 if(correctOrientation && correctSize)
                 {                    
+                    std::string fragment = walks[i].getFragmentString(pX, 
+                                                                      pY, 
+                                                                      fromX,
+                                                                      toY,
+                                                                      walkDirectionXOut,
+                                                                      walkDirectionYIn);
                     writeWalk(getPairBasename(record1.Name), i, fragment, pWriter);
                     
                     // Mark all the vertices in this walk as resolved
@@ -29,10 +29,34 @@
 #include "api/BamReader.h"
 #include "api/BamWriter.h"
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 // Structs
 
+// Flags recording which filters a pair of alignments was checked against or failed
+enum FilterBAMFlag
+{
+    FBF_UNMAPPED = 1,
+    FBF_ERROR_RATE = 2,
+    FBF_QUALITY = 4,
+    FBF_DEPTH = 8,
+    FBF_FR_CONTAMINATION = 16,
+    FBF_END_DISTANCE = 32,
+    FBF_GRAPH_CHECKED = 64,
+    FBF_PASSED = 128
+};
+
 // Functions
-bool filterByGraph(StringGraph* pGraph, 
+int filterAlignmentPair(const StringGraph* pGraph,
+                        const BWT* pBWT,
+                        const BWT* pRBWT,
+                        const BamTools::RefVector& referenceVector,
+                        BamTools::BamAlignment& record1,
+                        BamTools::BamAlignment& record2);
+
+bool filterByGraph(const StringGraph* pGraph, 
                    const BamTools::RefVector& referenceVector, 
                    BamTools::BamAlignment& record1, 
                    BamTools::BamAlignment& record2);
@@ -61,6 +85,7 @@ static const char *FILTERBAM_USAGE_MESSAGE =
 "\n"
 "      --help                           display this help and exit\n"
 "      -v, --verbose                    display verbose output\n"
+"      -t, --threads=NUM                use NUM threads to filter the alignment pairs (default: 1)\n"
 "      -a, --asqg=FILE                  load an asqg file and filter pairs that are shorter than --max-distance\n"
 "      -d, --max-distance=LEN           search the graph for a path completing the mate-pair fragment. If the path is less than LEN\n"
 "                                       then the pair will be discarded.\n"
@@ -95,6 +120,9 @@ namespace opt
     static int kmerSize = 31;
     static int maxKmerDepth = -1;
     static int sampleRate = 256;
+
+    // Number of pairs read from the BAM and filtered at once
+    static size_t batchSize = 10000;
 }
 
 static const char* shortopts = "d:t:o:q:e:a:p:x:t:c:v";
@@ -160,119 +188,65 @@ int filterBAMMain(int argc, char** argv)
     const BamTools::RefVector& referenceVector = pBamReader->GetReferenceData();
 
 
-    BamTools::BamAlignment record1;
-    BamTools::BamAlignment record2;
+    // The pairs are read in batches. The filters for a batch are run in parallel
+    // against the shared read-only graph and FM-index, then the passing pairs are
+    // written in the order they were read.
+    std::vector<BamTools::BamAlignment> records(2 * opt::batchSize);
+    std::vector<int> filterFlags(opt::batchSize);
     bool done = false;
 
+#if HAVE_OPENMP
+    omp_set_num_threads(opt::numThreads);
+#endif
+
     while(!done)
     {
-        if(numPairsTotal++ % 200000 == 0)
-            printf("[sga filterBAM] Processed %d pairs\n", numPairsTotal);
-
-        done = !readAlignmentPair(pBamReader, record1, record2);
-        if(done)
-            break;
-
-        if(!record1.IsMapped() || !record2.IsMapped())
+        size_t numPairsInBatch = 0;
+        while(numPairsInBatch < opt::batchSize)
         {
-            numPairsUnmapped += 1;
-            continue;
+            if(numPairsTotal++ % 200000 == 0)
+                printf("[sga filterBAM] Processed %d pairs\n", numPairsTotal);
+
+            BamTools::BamAlignment& record1 = records[2 * numPairsInBatch];
+            BamTools::BamAlignment& record2 = records[2 * numPairsInBatch + 1];
+            done = !readAlignmentPair(pBamReader, record1, record2);
+            if(done)
+                break;
+            numPairsInBatch += 1;
         }
 
-        // Ensure the pairing is correct
-        if(record1.Name != record2.Name)
-            std::cout << "NAME FAIL: " << record1.Name << " " << record2.Name << "\n";
-        assert(record1.Name == record2.Name);
-        bool bPassedFilters = true;
-
-        // Check if the error rate is below the max
-        double er1 = getErrorRate(record1);
-        double er2 = getErrorRate(record2);
-
-        if(er1 > opt::maxError || er2 > opt::maxError)
-        {
-            bPassedFilters = false;
-            numPairsFilteredByER += 1;
-        }
-
-        if(record1.MapQuality < opt::minQuality || record2.MapQuality < opt::minQuality)
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for(size_t i = 0; i < numPairsInBatch; ++i)
         {
-            bPassedFilters = false;
-            numPairsFilteredByQuality += 1;
+            filterFlags[i] = filterAlignmentPair(pGraph, pBWT, pRBWT, referenceVector, 
+                                                 records[2 * i], records[2 * i + 1]);
         }
 
-        // Perform depth check for pairs aligning to different contigs
-        if(bPassedFilters && (pBWT != NULL && pRBWT != NULL && opt::maxKmerDepth > 0) && (record1.RefID != record2.RefID))
+        for(size_t i = 0; i < numPairsInBatch; ++i)
         {
-            int maxDepth1 = getMaxKmerDepth(record1.QueryBases, pBWT, pRBWT);
-            int maxDepth2 = getMaxKmerDepth(record1.QueryBases, pBWT, pRBWT);
-            if(maxDepth1 > opt::maxKmerDepth || maxDepth2 > opt::maxKmerDepth)
+            int flags = filterFlags[i];
+            if(flags & FBF_UNMAPPED)
             {
-                bPassedFilters = false;
-                numPairsFilteredByDepth += 1;
+                numPairsUnmapped += 1;
+                continue;
             }
-        }
 
-        // Filter forward-reverse contimating pairs in a mate pair library
-        if(opt::filterFRContamination)
-        {
-            if(record1.RefID == record2.RefID)
-            {
-                // Check the orientation of the pairs
-                // We discard the pair if they are like this:
-                //  ------1---->
-                //                <------2------
-                BamTools::BamAlignment* pUpstream;
-                BamTools::BamAlignment* pDownstream;
-                if(record1.Position < record2.Position)
-                {
-                    pUpstream = &record1;
-                    pDownstream = &record2;
-                }
-                else
-                {
-                    pUpstream = &record2;
-                    pDownstream = &record1;
-                }
-                
-                // Upstream half of the pair (more 5') should be forward, downstream should be reverse
-                if(!pUpstream->IsReverseStrand() && pDownstream->IsReverseStrand())
-                {
-                    numPairsFilteredFRContamination += 1;
-                    bPassedFilters = false;
-                }
-            }
+            numPairsFilteredByER += (flags & FBF_ERROR_RATE) ? 1 : 0;
+            numPairsFilteredByQuality += (flags & FBF_QUALITY) ? 1 : 0;
+            numPairsFilteredByDepth += (flags & FBF_DEPTH) ? 1 : 0;
+            numPairsFilteredFRContamination += (flags & FBF_FR_CONTAMINATION) ? 1 : 0;
+            numPairsTooCloseToEnd += (flags & FBF_END_DISTANCE) ? 1 : 0;
+            numPairsFilteredByDistance += (flags & FBF_GRAPH_CHECKED) ? 1 : 0;
 
-            if(bPassedFilters && record1.RefID != record2.RefID)
+            if(flags & FBF_PASSED)
             {
-                int distanceToLeftEnd1 = record1.Position;
-                int distanceToRightEnd1 = referenceVector[record1.RefID].RefLength - record1.GetEndPosition();
-                int distance1 = std::min(distanceToLeftEnd1, distanceToRightEnd1);
-                
-                int distanceToLeftEnd2 = record2.Position;
-                int distanceToRightEnd2 = referenceVector[record2.RefID].RefLength - record2.GetEndPosition();
-                int distance2 = std::min(distanceToLeftEnd2, distanceToRightEnd2);
-                if(distance1 < opt::minDistanceToEnd || distance2 < opt::minDistanceToEnd)
-                {
-                    bPassedFilters = false;
-                    numPairsTooCloseToEnd += 1;
-                }
+                pBamWriter->SaveAlignment(records[2 * i]);
+                pBamWriter->SaveAlignment(records[2 * i + 1]);
+                numPairsWrote += 1;
             }
         }
-
-        // Perform short-insert pair check
-        if(pGraph != NULL)
-        {
-            bPassedFilters = bPassedFilters && filterByGraph(pGraph, referenceVector, record1, record2);
-            numPairsFilteredByDistance += 1;
-        }
-
-        if(bPassedFilters)
-        {
-            pBamWriter->SaveAlignment(record1);
-            pBamWriter->SaveAlignment(record2);
-            numPairsWrote += 1;
-        }
     }
 
     std::cout << "Total pairs: " << numPairsTotal << "\n";
@@ -303,8 +277,119 @@ int filterBAMMain(int argc, char** argv)
     return 0;
 }
 
+// Run the filters on a pair of alignments. Returns a bitmask of FilterBAMFlag
+// values giving the filters that rejected the pair, or FBF_PASSED if it should be kept
+int filterAlignmentPair(const StringGraph* pGraph,
+                        const BWT* pBWT,
+                        const BWT* pRBWT,
+                        const BamTools::RefVector& referenceVector,
+                        BamTools::BamAlignment& record1,
+                        BamTools::BamAlignment& record2)
+{
+    if(!record1.IsMapped() || !record2.IsMapped())
+        return FBF_UNMAPPED;
+
+    // Ensure the pairing is correct
+    if(record1.Name != record2.Name)
+    {
+#if HAVE_OPENMP
+        #pragma omp critical
+#endif
+        std::cout << "NAME FAIL: " << record1.Name << " " << record2.Name << "\n";
+    }
+    assert(record1.Name == record2.Name);
+    bool bPassedFilters = true;
+    int flags = 0;
+
+    // Check if the error rate is below the max
+    double er1 = getErrorRate(record1);
+    double er2 = getErrorRate(record2);
+
+    if(er1 > opt::maxError || er2 > opt::maxError)
+    {
+        bPassedFilters = false;
+        flags |= FBF_ERROR_RATE;
+    }
+
+    if(record1.MapQuality < opt::minQuality || record2.MapQuality < opt::minQuality)
+    {
+        bPassedFilters = false;
+        flags |= FBF_QUALITY;
+    }
+
+    // Perform depth check for pairs aligning to different contigs
+    if(bPassedFilters && (pBWT != NULL && pRBWT != NULL && opt::maxKmerDepth > 0) && (record1.RefID != record2.RefID))
+    {
+        int maxDepth1 = getMaxKmerDepth(record1.QueryBases, pBWT, pRBWT);
+        int maxDepth2 = getMaxKmerDepth(record1.QueryBases, pBWT, pRBWT);
+        if(maxDepth1 > opt::maxKmerDepth || maxDepth2 > opt::maxKmerDepth)
+        {
+            bPassedFilters = false;
+            flags |= FBF_DEPTH;
+        }
+    }
+
+    // Filter forward-reverse contimating pairs in a mate pair library
+    if(opt::filterFRContamination)
+    {
+        if(record1.RefID == record2.RefID)
+        {
+            // Check the orientation of the pairs
+            // We discard the pair if they are like this:
+            //  ------1---->
+            //                <------2------
+            BamTools::BamAlignment* pUpstream;
+            BamTools::BamAlignment* pDownstream;
+            if(record1.Position < record2.Position)
+            {
+                pUpstream = &record1;
+                pDownstream = &record2;
+            }
+            else
+            {
+                pUpstream = &record2;
+                pDownstream = &record1;
+            }
+            
+            // Upstream half of the pair (more 5') should be forward, downstream should be reverse
+            if(!pUpstream->IsReverseStrand() && pDownstream->IsReverseStrand())
+            {
+                flags |= FBF_FR_CONTAMINATION;
+                bPassedFilters = false;
+            }
+        }
+
+        if(bPassedFilters && record1.RefID != record2.RefID)
+        {
+            int distanceToLeftEnd1 = record1.Position;
+            int distanceToRightEnd1 = referenceVector[record1.RefID].RefLength - record1.GetEndPosition();
+            int distance1 = std::min(distanceToLeftEnd1, distanceToRightEnd1);
+            
+            int distanceToLeftEnd2 = record2.Position;
+            int distanceToRightEnd2 = referenceVector[record2.RefID].RefLength - record2.GetEndPosition();
+            int distance2 = std::min(distanceToLeftEnd2, distanceToRightEnd2);
+            if(distance1 < opt::minDistanceToEnd || distance2 < opt::minDistanceToEnd)
+            {
+                bPassedFilters = false;
+                flags |= FBF_END_DISTANCE;
+            }
+        }
+    }
+
+    // Perform short-insert pair check
+    if(pGraph != NULL)
+    {
+        bPassedFilters = bPassedFilters && filterByGraph(pGraph, referenceVector, record1, record2);
+        flags |= FBF_GRAPH_CHECKED;
+    }
+
+    if(bPassedFilters)
+        flags |= FBF_PASSED;
+    return flags;
+}
+
 // Returns true if the paired reads are a short-insert pair
-bool filterByGraph(StringGraph* pGraph, 
+bool filterByGraph(const StringGraph* pGraph, 
                    const BamTools::RefVector& referenceVector, 
                    BamTools::BamAlignment& record1, 
                    BamTools::BamAlignment& record2)
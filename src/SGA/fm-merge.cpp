@@ -133,13 +133,10 @@ int FMMergeMain(int argc, char** argv)
     }
 
     // Check that every bit was set in the bit vector
-    size_t numSet = 0;
+    size_t numSet = markedReads.count();
     size_t numTotal = pBWT->getNumStrings();
-    for(size_t i = 0; i < numTotal; ++i)
-    {
-        if(markedReads.test(i))
-            ++numSet;
-    }
+    if(opt::verbose > 0 && numSet != numTotal)
+        printf("[%s] %zu of %zu reads were not used in a merged sequence\n", PROGRAM_IDENT, numTotal - numSet, numTotal);
 
     // Get the number of strings in the BWT, this is used to pre-allocated the read table
     delete pOverlapper;
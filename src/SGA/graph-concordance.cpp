@@ -52,6 +52,7 @@ PACKAGE_NAME "::" SUBPROGRAM;
 namespace opt
 {
     static unsigned int verbose;
+    static int numThreads = 1;
     static int k = 51;
     static std::string variantFile;
     static std::string baseFile;
@@ -200,7 +201,7 @@ StringVector extractSomaticKmers(const std::string& haplotype,
 }
 
 std::string reconstructHaplotype(const VCFRecord& somatic_record, 
-                                 const VariantRecordVector nearby_germline, 
+                                 const VariantRecordSpan& nearby_germline, 
                                  const ReadTable& refTable,
                                  const BWTIndexSet& variantIndex,
                                  size_t flanking_size)
@@ -309,7 +310,7 @@ int graphConcordanceMain(int argc, char** argv)
 
     // Index the germline variants so we can make germline haplotypes
     std::cerr << "Loading germline variant index..." << std::flush;
-    VariantIndex germlineIndex(opt::germlineFile, refTable);
+    VariantIndex germlineIndex(opt::germlineFile, refTable, opt::numThreads);
     std::cerr << "done\n";
 
     // Load FM-index of the reads
@@ -351,9 +352,9 @@ int graphConcordanceMain(int argc, char** argv)
 
         // Grab nearby variants
         size_t flanking_size = opt::k;
-        VariantRecordVector nearby_vector = germlineIndex.getNearVariants(record.refName, 
-                                                                          record.refPosition, 
-                                                                          flanking_size);
+        VariantRecordSpan nearby_vector = germlineIndex.getNearVariants(record.refName, 
+                                                                        record.refPosition, 
+                                                                        flanking_size);
         
         if(opt::verbose > 0)
         {
@@ -442,6 +443,7 @@ void parseGraphConcordanceOptions(int argc, char** argv)
             case 'b': arg >> opt::baseFile; break;
             case 'r': arg >> opt::variantFile; break;
             case 'g': arg >> opt::germlineFile; break;
+            case 't': arg >> opt::numThreads; break;
             case OPT_REFERENCE: arg >> opt::referenceFile; break;
             case '?': die = true; break;
             case 'v': opt::verbose++; break;
@@ -477,6 +479,12 @@ void parseGraphConcordanceOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
     opt::vcfFile = argv[optind++];
 
     if (die) 
@@ -10,6 +10,7 @@
 #include <fstream>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
 #include "Util.h"
 #include "overlap-long.h"
 #include "SuffixArray.h"
@@ -24,6 +25,11 @@
 #include "OverlapProcess.h"
 #include "ReadInfoTable.h"
 #include "KmerOverlaps.h"
+#include "MinimizerIndex.h"
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
 
 // Functions
 size_t computeHitsSerial(const std::string& prefix, const std::string& readsFile, 
@@ -66,6 +72,13 @@ static const char *OVERLAP_LONG_USAGE_MESSAGE =
 "                                       is specified (see above). This parameter defaults to the same value as --seed-length\n"
 "      -d, --sample-rate=N              sample the symbol counts every N symbols in the FM-index. Higher values use significantly\n"
 "                                       less memory at the cost of higher runtime. This value must be a power of 2 (default: 128)\n"
+"\nMinimizer filter options:\n"
+"      --minimizer-filter               select the candidate reads to align using shared (w,k)-minimizers instead of\n"
+"                                       the FM-index seeds. The minimizer index is stored in PREFIX.mzi and reused if present\n"
+"      --minimizer-k=K                  use K-mers for the minimizers (default: 15, maximum: 31)\n"
+"      --minimizer-w=W                  select one minimizer per window of W consecutive k-mers (default: 10)\n"
+"      --min-minimizer-hits=N           require N shared minimizers on a consistent diagonal to align a pair (default: 3)\n"
+"      --max-minimizer-occurrence=N     ignore minimizers that occur more than N times in the index (default: 200)\n"
 "\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
 
 static const char* PROGRAM_IDENT =
@@ -86,11 +99,23 @@ namespace opt
     static int sampleRate = BWT::DEFAULT_SAMPLE_RATE_SMALL;
     static bool bIrreducibleOnly = true;
     static bool bExactIrreducible = false;
+
+    static bool bMinimizerFilter = false;
+    static int minimizerK = 15;
+    static int minimizerW = 10;
+    static int minMinimizerHits = 3;
+    static int maxMinimizerOccurrence = 200;
+
+    // Band width of the alignment extension around the seed
+    static int bandwidth = 100;
+
+    // Number of queries to process between output flushes
+    static size_t batchSize = 1000;
 }
 
 static const char* shortopts = "m:d:e:t:l:s:o:f:vix";
 
-enum { OPT_HELP = 1, OPT_VERSION, OPT_EXACT };
+enum { OPT_HELP = 1, OPT_VERSION, OPT_EXACT, OPT_MINIMIZER_FILTER, OPT_MINIMIZER_K, OPT_MINIMIZER_W, OPT_MIN_MINIMIZER_HITS, OPT_MAX_MINIMIZER_OCC };
 
 static const struct option longopts[] = {
     { "verbose",     no_argument,       NULL, 'v' },
@@ -105,6 +130,11 @@ static const struct option longopts[] = {
     { "seed-stride", required_argument, NULL, 's' },
     { "exhaustive",  no_argument,       NULL, 'x' },
     { "exact",       no_argument,       NULL, OPT_EXACT },
+    { "minimizer-filter",   no_argument,       NULL, OPT_MINIMIZER_FILTER },
+    { "minimizer-k",        required_argument, NULL, OPT_MINIMIZER_K },
+    { "minimizer-w",        required_argument, NULL, OPT_MINIMIZER_W },
+    { "min-minimizer-hits", required_argument, NULL, OPT_MIN_MINIMIZER_HITS },
+    { "max-minimizer-occurrence", required_argument, NULL, OPT_MAX_MINIMIZER_OCC },
     { "help",        no_argument,       NULL, OPT_HELP },
     { "version",     no_argument,       NULL, OPT_VERSION },
     { NULL, 0, NULL, 0 }
@@ -140,6 +170,92 @@ std::string ascii_overlap(const std::string& s0, const std::string& s1,
     return out;
 }
 
+// Order read indices by decreasing read length
+struct ReadLengthDescending
+{
+    ReadLengthDescending(const ReadTable* pReads) : m_pReads(pReads) {}
+    bool operator()(size_t a, size_t b) const { return m_pReads->getReadLength(a) > m_pReads->getReadLength(b); }
+    const ReadTable* m_pReads;
+};
+
+// Compute the overlaps of a single query read. The progress log and the
+// ASQG edge records are appended to outLog and outEdges
+void computeLongReadOverlaps(const SeqItem& curr_read,
+                             const ReadTable* pTargetReads,
+                             const MinimizerIndex* pMinimizerIndex,
+                             const BWTIndexSet& index,
+                             std::string& outLog,
+                             std::string& outEdges)
+{
+    char buffer[1024];
+    snprintf(buffer, sizeof(buffer), "read %s %zubp\n", curr_read.id.c_str(), curr_read.seq.length());
+    outLog.append(buffer);
+
+    SequenceOverlapPairVector sopv;
+    if(pMinimizerIndex != NULL)
+        sopv = KmerOverlaps::retrieveMinimizerMatches(curr_read.seq.toString(),
+                                                      *pMinimizerIndex,
+                                                      pTargetReads,
+                                                      opt::minMinimizerHits,
+                                                      opt::maxMinimizerOccurrence,
+                                                      opt::minOverlap,
+                                                      1 - opt::errorRate,
+                                                      opt::bandwidth);
+    else
+        sopv = KmerOverlaps::retrieveMatches(curr_read.seq.toString(),
+                                             opt::seedLength,
+                                             opt::minOverlap,
+                                             1 - opt::errorRate,
+                                             opt::bandwidth,
+                                             index);
+
+    snprintf(buffer, sizeof(buffer), "Found %zu matches\n", sopv.size());
+    outLog.append(buffer);
+
+    std::ostringstream edgeWriter;
+    for(size_t i = 0; i < sopv.size(); ++i)
+    {
+        std::string match_id = pTargetReads->getRead(sopv[i].match_idx).id;
+
+        // We only want to output each edge once so skip this overlap
+        // if the matched read has a lexicographically lower ID
+        if(curr_read.id > match_id)
+            continue;
+
+        std::string ao = ascii_overlap(sopv[i].sequence[0], sopv[i].sequence[1], sopv[i].overlap, 50);
+        std::string line = "\t" + ao;
+        snprintf(buffer, sizeof(buffer), "\t[%d %d] ID=", sopv[i].overlap.match[0].start,
+                                                        sopv[i].overlap.match[0].end);
+        line.append(buffer);
+        line.append(match_id);
+        snprintf(buffer, sizeof(buffer), " OL=%d PI:%.2lf C=", sopv[i].overlap.getOverlapLength(),
+                                                               sopv[i].overlap.getPercentIdentity());
+        line.append(buffer);
+        line.append(sopv[i].overlap.cigar);
+        line.append("\n");
+        outLog.append(line);
+
+        // Convert to ASQG
+        SeqCoord sc1(sopv[i].overlap.match[0].start, sopv[i].overlap.match[0].end, sopv[i].overlap.length[0]);
+        SeqCoord sc2(sopv[i].overlap.match[1].start, sopv[i].overlap.match[1].end, sopv[i].overlap.length[1]);
+        
+        // KmerOverlaps returns the coordinates of the overlap after flipping the reads
+        // to ensure the strand matches. The ASQG file wants the coordinate of the original
+        // sequencing strand. Flip here if necessary
+        if(sopv[i].is_reversed)
+            sc2.flip();
+
+        // Convert the SequenceOverlap the ASQG's overlap format
+        Overlap ovr(curr_read.id, sc1, match_id,  sc2, sopv[i].is_reversed, -1);
+
+        ASQG::EdgeRecord er(ovr);
+        er.setCigarTag(sopv[i].overlap.cigar);
+        er.setPercentIdentityTag(sopv[i].overlap.getPercentIdentity());
+        er.write(edgeWriter);
+    }
+    outEdges.append(edgeWriter.str());
+}
+
 //
 // Main
 //
@@ -166,11 +282,19 @@ int overlapLongMain(int argc, char** argv)
     else
         indexPrefix = stripFilename(opt::readsFile);
 
-    BWT* pBWT = new BWT(indexPrefix + BWT_EXT, opt::sampleRate);
-    SampledSuffixArray* pSSA = new SampledSuffixArray(indexPrefix + SAI_EXT, SSA_FT_SAI);
+    // The FM-index is only needed to seed the alignments when the
+    // minimizer filter is not used
+    BWT* pBWT = NULL;
+    SampledSuffixArray* pSSA = NULL;
+    if(!opt::bMinimizerFilter)
+    {
+        pBWT = new BWT(indexPrefix + BWT_EXT, opt::sampleRate);
+        pSSA = new SampledSuffixArray(indexPrefix + SAI_EXT, SSA_FT_SAI);
+    }
     
     Timer* pTimer = new Timer(PROGRAM_IDENT);
-    pBWT->printInfo();
+    if(pBWT != NULL)
+        pBWT->printInfo();
 
     // Read the sequence file and write vertex records for each
     // Also store the read names in a vector of strings
@@ -191,71 +315,85 @@ int overlapLongMain(int argc, char** argv)
     delete pReader;
     pReader = NULL;
 
+    // The matches are indices into the target reads, load them if they
+    // are not the same as the query reads
+    ReadTable* pTargetReads = &reads;
+    if(!opt::targetFile.empty())
+        pTargetReads = new ReadTable(opt::targetFile, SRF_NO_VALIDATION);
+
     BWTIndexSet index;
     index.pBWT = pBWT;
     index.pSSA = pSSA;
-    index.pReadTable = &reads;
+    index.pReadTable = pTargetReads;
 
-    // Make a prefix for the temporary hits files
+    // Load the minimizer index of the target reads, or build it if it does not
+    // exist or was built with different parameters or from a different read set
+    MinimizerIndex* pMinimizerIndex = NULL;
+    if(opt::bMinimizerFilter)
+    {
+        pMinimizerIndex = new MinimizerIndex;
+        std::string mziFilename = indexPrefix + MZI_EXT;
+        std::ifstream mziTest(mziFilename.c_str());
+        if(mziTest.good())
+        {
+            mziTest.close();
+            pMinimizerIndex->read(mziFilename);
+        }
+
+        if(pMinimizerIndex->getK() != opt::minimizerK || 
+           pMinimizerIndex->getW() != opt::minimizerW || 
+           pMinimizerIndex->getNumReads() != pTargetReads->getCount() ||
+           pMinimizerIndex->getChecksum() != MinimizerIndex::computeChecksum(pTargetReads))
+        {
+            pMinimizerIndex->build(pTargetReads, opt::minimizerK, opt::minimizerW);
+            pMinimizerIndex->write(mziFilename);
+        }
+
+        if(opt::verbose > 0)
+            pMinimizerIndex->printInfo();
+    }
+
+    // The queries are processed in batches. Within a batch the reads are dispatched
+    // longest first with dynamic scheduling, as long reads can differ in length (and cost)
+    // by orders of magnitude. Each query writes to its own buffers, which are
+    // flushed in input order so the output does not depend on the number of threads.
     size_t n_reads = reads.getCount();
+    std::vector<size_t> schedule;
+    StringVector logBuffers;
+    StringVector edgeBuffers;
 
 #if HAVE_OPENMP
     omp_set_num_threads(opt::numThreads);
-    #pragma omp parallel for
 #endif
-    for(size_t read_idx = 0; read_idx < n_reads; ++read_idx)
+
+    for(size_t batch_start = 0; batch_start < n_reads; batch_start += opt::batchSize)
     {
-        const SeqItem& curr_read = reads.getRead(read_idx);
-
-        printf("read %s %zubp\n", curr_read.id.c_str(), curr_read.seq.length());
-        SequenceOverlapPairVector sopv = 
-            KmerOverlaps::retrieveMatches(curr_read.seq.toString(),
-                                          opt::seedLength,
-                                          opt::minOverlap,
-                                          1 - opt::errorRate,
-                                          100,
-                                          index);
-
-        printf("Found %zu matches\n", sopv.size());
-        for(size_t i = 0; i < sopv.size(); ++i)
+        size_t batch_end = std::min(batch_start + opt::batchSize, n_reads);
+        size_t batch_count = batch_end - batch_start;
+
+        schedule.clear();
+        for(size_t read_idx = batch_start; read_idx < batch_end; ++read_idx)
+            schedule.push_back(read_idx);
+        std::stable_sort(schedule.begin(), schedule.end(), ReadLengthDescending(&reads));
+
+        logBuffers.assign(batch_count, "");
+        edgeBuffers.assign(batch_count, "");
+
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for(size_t j = 0; j < batch_count; ++j)
         {
-            std::string match_id = reads.getRead(sopv[i].match_idx).id;
-
-            // We only want to output each edge once so skip this overlap
-            // if the matched read has a lexicographically lower ID
-            if(curr_read.id > match_id)
-                continue;
-
-            std::string ao = ascii_overlap(sopv[i].sequence[0], sopv[i].sequence[1], sopv[i].overlap, 50);
-            printf("\t%s\t[%d %d] ID=%s OL=%d PI:%.2lf C=%s\n", ao.c_str(),
-                                                                sopv[i].overlap.match[0].start,
-                                                                sopv[i].overlap.match[0].end,
-                                                                match_id.c_str(),
-                                                                sopv[i].overlap.getOverlapLength(),
-                                                                sopv[i].overlap.getPercentIdentity(),
-                                                                sopv[i].overlap.cigar.c_str());
-
-            // Convert to ASQG
-            SeqCoord sc1(sopv[i].overlap.match[0].start, sopv[i].overlap.match[0].end, sopv[i].overlap.length[0]);
-            SeqCoord sc2(sopv[i].overlap.match[1].start, sopv[i].overlap.match[1].end, sopv[i].overlap.length[1]);
-            
-            // KmerOverlaps returns the coordinates of the overlap after flipping the reads
-            // to ensure the strand matches. The ASQG file wants the coordinate of the original
-            // sequencing strand. Flip here if necessary
-            if(sopv[i].is_reversed)
-                sc2.flip();
-
-            // Convert the SequenceOverlap the ASQG's overlap format
-            Overlap ovr(curr_read.id, sc1, match_id,  sc2, sopv[i].is_reversed, -1);
-
-            ASQG::EdgeRecord er(ovr);
-            er.setCigarTag(sopv[i].overlap.cigar);
-            er.setPercentIdentityTag(sopv[i].overlap.getPercentIdentity());
-
-#pragma omp critical
-            {
-                er.write(*pASQGWriter);
-            }
+            size_t read_idx = schedule[j];
+            size_t slot = read_idx - batch_start;
+            computeLongReadOverlaps(reads.getRead(read_idx), pTargetReads, pMinimizerIndex, index,
+                                    logBuffers[slot], edgeBuffers[slot]);
+        }
+
+        for(size_t j = 0; j < batch_count; ++j)
+        {
+            fputs(logBuffers[j].c_str(), stdout);
+            pASQGWriter->write(edgeBuffers[j].data(), edgeBuffers[j].size());
         }
     }
 
@@ -263,6 +401,9 @@ int overlapLongMain(int argc, char** argv)
     delete pReader;
     delete pBWT; 
     delete pSSA;
+    delete pMinimizerIndex;
+    if(pTargetReads != &reads)
+        delete pTargetReads;
     
     delete pASQGWriter;
     delete pTimer;
@@ -349,6 +490,11 @@ void parseOverlapLongOptions(int argc, char** argv)
             case 'd': arg >> opt::sampleRate; break;
             case 'f': arg >> opt::targetFile; break;
             case OPT_EXACT: opt::bExactIrreducible = true; break;
+            case OPT_MINIMIZER_FILTER: opt::bMinimizerFilter = true; break;
+            case OPT_MINIMIZER_K: arg >> opt::minimizerK; break;
+            case OPT_MINIMIZER_W: arg >> opt::minimizerW; break;
+            case OPT_MIN_MINIMIZER_HITS: arg >> opt::minMinimizerHits; break;
+            case OPT_MAX_MINIMIZER_OCC: arg >> opt::maxMinimizerOccurrence; break;
             case 'x': opt::bIrreducibleOnly = false; break;
             case '?': die = true; break;
             case 'v': opt::verbose++; break;
@@ -384,6 +530,30 @@ void parseOverlapLongOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::minimizerK <= 0 || opt::minimizerK > 31)
+    {
+        std::cerr << SUBPROGRAM ": invalid parameter to --minimizer-k, must be between 1 and 31. got: " << opt::minimizerK << "\n";
+        die = true;
+    }
+
+    if(opt::minimizerW <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid parameter to --minimizer-w, must be positive. got: " << opt::minimizerW << "\n";
+        die = true;
+    }
+
+    if(opt::minMinimizerHits <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid parameter to --min-minimizer-hits, must be positive. got: " << opt::minMinimizerHits << "\n";
+        die = true;
+    }
+
+    if(opt::maxMinimizerOccurrence <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid parameter to --max-minimizer-occurrence, must be positive. got: " << opt::maxMinimizerOccurrence << "\n";
+        die = true;
+    }
+
     if (die) 
     {
         std::cout << "\n" << OVERLAP_LONG_USAGE_MESSAGE;
@@ -17,6 +17,7 @@
 #include "Timer.h"
 #include "BWT.h"
 #include "BWTAlgorithms.h"
+#include "DBGNavigator.h"
 #include "SGACommon.h"
 #include "HashMap.h"
 #include "KmerDistribution.h"
@@ -212,15 +213,11 @@ static const struct option longopts[] = {
 // as the single base they add. A coverage threshold
 // is applied to filter out low-coverage extensions.
 std::string get_valid_dbg_neighbors_ratio(const std::string& kmer,
-                                          const BWTIndexSet& index_set,
+                                          DBGNavigator& navigator,
                                           double coverage_ratio_threshold)
 {
     std::string out;
-    AlphaCount64 counts = 
-        BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(kmer, 
-                                                              index_set.pBWT,
-                                                              ED_SENSE,
-                                                              index_set.pCache);
+    AlphaCount64 counts = navigator.getExtensions(kmer, ED_SENSE);
     
     if(!counts.hasDNAChar())
         return out; // no extensions
@@ -239,17 +236,13 @@ std::string get_valid_dbg_neighbors_ratio(const std::string& kmer,
 }
 
 std::string get_valid_dbg_neighbors_coverage_and_ratio(const std::string& kmer,
-                                                       const BWTIndexSet& index_set,
+                                                       DBGNavigator& navigator,
                                                        size_t min_coverage,
                                                        double min_ratio,
                                                        EdgeDir dir)
 {
     std::string out;
-    AlphaCount64 counts = 
-        BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(kmer, 
-                                                              index_set.pBWT,
-                                                              dir,
-                                                              index_set.pCache);
+    AlphaCount64 counts = navigator.getExtensions(kmer, dir);
     
     if(!counts.hasDNAChar())
         return out; // no extensions
@@ -871,6 +864,7 @@ void generate_local_graph_complexity(JSONWriter* pWriter, const BWTIndexSet& ind
             if(s.size() < k)
                 continue;
             
+            DBGNavigator navigator(index_set.pBWT, NULL, index_set.pCache);
             for(size_t j = 0; j < s.size() - k + 1; ++j)
             {
                 std::string kmer = s.substr(j, k);
@@ -880,7 +874,7 @@ void generate_local_graph_complexity(JSONWriter* pWriter, const BWTIndexSet& ind
 
                 std::string extensions = 
                     get_valid_dbg_neighbors_coverage_and_ratio(kmer, 
-                                                               index_set, 
+                                                               navigator, 
                                                                min_coverage_for_branch, 
                                                                min_coverage_ratio,
                                                                ED_SENSE);
@@ -937,16 +931,17 @@ void generate_double_branch(JSONWriter* pWriter, const BWTIndexSet& index_set)
             size_t count = BWTAlgorithms::countSequenceOccurrences(kmer, index_set);
             if(count >= min_coverage_to_test)
             {
+                DBGNavigator navigator(index_set.pBWT, NULL, index_set.pCache);
                 std::string right_extensions = 
                     get_valid_dbg_neighbors_coverage_and_ratio(kmer, 
-                                                               index_set,
+                                                               navigator,
                                                                min_coverage_for_branch, 
                                                                min_coverage_ratio,
                                                                ED_SENSE);
 
                 std::string left_extensions = 
                     get_valid_dbg_neighbors_coverage_and_ratio(kmer, 
-                                                               index_set,
+                                                               navigator,
                                                                min_coverage_for_branch, 
                                                                min_coverage_ratio,
                                                                ED_ANTISENSE);
@@ -1274,6 +1269,7 @@ void generate_pe_fragment_sizes(JSONWriter* pJSONWriter, const BWTIndexSet& inde
         end_kmer = reverseComplement(end_kmer);
 
         // Aggressively walk the de Bruijn graph starting from k_start until k_end is found or we give up
+        DBGNavigator navigator(index_set.pBWT, NULL, index_set.pCache);
         size_t steps = 0;
         bool found = false;
         while(!found && steps < MAX_INSERT)
@@ -1281,7 +1277,7 @@ void generate_pe_fragment_sizes(JSONWriter* pJSONWriter, const BWTIndexSet& inde
             // A coverage ratio of 1.0 will force use to only use the highest-coverage branch
             // This may generate erroneous insert sizes in (rare?) cases but will give a good approximation
             // to the real distribution
-            std::string extensions = get_valid_dbg_neighbors_ratio(start_kmer, index_set, 1.0f);
+            std::string extensions = get_valid_dbg_neighbors_ratio(start_kmer, navigator, 1.0f);
             if(extensions.empty())
                 break;
 
@@ -2048,6 +2044,7 @@ void unipath_length_distribution(JSONWriter* pWriter,
             continue;
         
         HashMap<std::string, bool> loop_check;
+        DBGNavigator navigator(index_set.pBWT, NULL, index_set.pCache);
         std::string start_kmer = s.substr(0, k);
         std::string curr_kmer = start_kmer;
 
@@ -2056,7 +2053,7 @@ void unipath_length_distribution(JSONWriter* pWriter,
         while(!done)
         {
             loop_check[curr_kmer] = true;
-            std::string extensions = get_valid_dbg_neighbors_ratio(curr_kmer, index_set, coverage_ratio_threshold);
+            std::string extensions = get_valid_dbg_neighbors_ratio(curr_kmer, navigator, coverage_ratio_threshold);
             if(extensions.size() == 1)
             {
                 curr_kmer.erase(0, 1);
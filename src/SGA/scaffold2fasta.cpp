@@ -17,6 +17,10 @@
 #include "OverlapTools.h"
 #include "ScaffoldSequenceCollection.h"
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 //
 void writeUnplaced(std::ostream* pWriter, StringGraph* pGraph, int minLength);
 
@@ -37,6 +41,7 @@ static const char *SCAFFOLD2FASTA_USAGE_MESSAGE =
 "\n"
 "      --help                           display this help and exit\n"
 "      -v, --verbose                    display verbose output\n"
+"      -t, --threads=NUM                use NUM threads to resolve the gaps of the scaffolds (default: 1)\n"
 "      -f, --contig-file=FILE           read the contig sequences from FILE\n"
 "      -a, --asqg-file=FILE             read the contig string graph from FILE. This supercedes --contig-file\n"
 "                                       this is usually the output from the sga-assemble step\n"
@@ -83,14 +88,17 @@ namespace opt
     static bool bWriteNames = false;
     static int minScaffoldLength = 200;
     static float distanceFactor = 3.0f;
+    static int numThreads = 1;
+    static size_t batchSize = 1000;
 }
 
-static const char* shortopts = "vm:o:f:a:g:d:";
+static const char* shortopts = "vm:o:f:a:g:d:t:";
 
 enum { OPT_HELP = 1, OPT_VERSION, OPT_NOSINGLETON, OPT_USEOVERLAP, OPT_MINGAPLENGTH, OPT_WRITEUNPLACED, OPT_WRITENAMES };
 
 static const struct option longopts[] = {
     { "verbose",        no_argument,       NULL, 'v' },
+    { "threads",        required_argument, NULL, 't' },
     { "min-length",     required_argument, NULL, 'm' },
     { "outfile",        required_argument, NULL, 'o' },
     { "contig-file",    required_argument, NULL, 'f' },
@@ -147,17 +155,68 @@ int scaffold2fastaMain(int argc, char** argv)
     resolveParams.distanceFactor = opt::distanceFactor;
     resolveParams.pStats = &stats;
 
+    // Each thread resolves gaps against a private cache of the contig sequences and a
+    // private stats object. The cached collections buffer the placed contigs, which are
+    // applied to the shared collection after each batch
+    std::vector<ResolveParams> threadParams(opt::numThreads, resolveParams);
+    std::vector<ResolveStats> threadStats(opt::numThreads);
+    std::vector<CachedSequenceCollection*> threadCollections(opt::numThreads);
+    for(int i = 0; i < opt::numThreads; ++i)
+    {
+        threadCollections[i] = new CachedSequenceCollection(resolveParams.pSequenceCollection);
+        threadParams[i].pSequenceCollection = threadCollections[i];
+        threadParams[i].pStats = &threadStats[i];
+    }
+
+#if HAVE_OPENMP
+    omp_set_num_threads(opt::numThreads);
+#endif
+
     std::string line;
     size_t idx = 0;
-    while(getline(*pReader, line))
+    while(true)
     {
-        ScaffoldRecord record;
-        record.parse(line);
-        if(record.getNumComponents() > 1 || !opt::bNoSingletons)
+        // Read a batch of scaffold records
+        std::vector<ScaffoldRecord> records;
+        while(records.size() < opt::batchSize && getline(*pReader, line))
         {
-            StringVector ids;
-            std::string sequence = record.generateString(resolveParams, ids);
-            
+            ScaffoldRecord record;
+            record.parse(line);
+            if(record.getNumComponents() > 1 || !opt::bNoSingletons)
+                records.push_back(record);
+        }
+
+        if(records.empty())
+            break;
+
+        // Resolve the gaps of the scaffolds in parallel. The graph is not modified 
+        // during this step so it can be shared between the threads
+        int numRecords = records.size();
+        StringVector sequences(numRecords);
+        std::vector<StringVector> recordIDs(numRecords);
+#if HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for(int i = 0; i < numRecords; ++i)
+        {
+            int threadID = 0;
+#if HAVE_OPENMP
+            threadID = omp_get_thread_num();
+#endif
+            sequences[i] = records[i].generateString(threadParams[threadID], recordIDs[i]);
+        }
+
+        for(int i = 0; i < opt::numThreads; ++i)
+        {
+            threadCollections[i]->flushPlaced(resolveParams.pSequenceCollection);
+            threadCollections[i]->clearCache();
+        }
+
+        // Write the scaffolds in the order they were read
+        for(int i = 0; i < numRecords; ++i)
+        {
+            const StringVector& ids = recordIDs[i];
+
             // Write out the sequence of contigs to a stringstream
             std::stringstream contig_ss;
             contig_ss << "Contigs=";
@@ -170,11 +229,17 @@ int scaffold2fastaMain(int argc, char** argv)
             if(opt::bWriteNames)
                 id_ss << "\t" << contig_ss.str();
             
-            writeFastaRecord(pWriter, id_ss.str(), sequence);
+            writeFastaRecord(pWriter, id_ss.str(), sequences[i]);
             ++idx;
         }
     }
 
+    for(int i = 0; i < opt::numThreads; ++i)
+    {
+        stats.add(threadStats[i]);
+        delete threadCollections[i];
+    }
+
     if(opt::bWriteUnplaced)
         resolveParams.pSequenceCollection->writeUnplaced(pWriter, opt::minScaffoldLength);
 
@@ -184,6 +249,8 @@ int scaffold2fastaMain(int argc, char** argv)
 
     delete pReader;
     delete pWriter;
+
+    stats.print();
     return 0;
 }
 
@@ -200,6 +267,7 @@ void parseScaffold2fastaOptions(int argc, char** argv)
         {
             case '?': die = true; break;
             case 'v': opt::verbose++; break;
+            case 't': arg >> opt::numThreads; break;
             case 'm': arg >> opt::minScaffoldLength; break;
             case 'f': arg >> opt::contigFile; break;
             case 'a': arg >> opt::asqgFile; break;
@@ -231,6 +299,12 @@ void parseScaffold2fastaOptions(int argc, char** argv)
         die = true;
     }
 
+    if(opt::numThreads <= 0)
+    {
+        std::cerr << SUBPROGRAM ": invalid number of threads: " << opt::numThreads << "\n";
+        die = true;
+    }
+
     if (die) 
     {
         std::cout << "\n" << SCAFFOLD2FASTA_USAGE_MESSAGE;
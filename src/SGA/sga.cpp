@@ -39,6 +39,11 @@
 #include "graph-concordance.h"
 #include "somatic-variant-filters.h"
 #include "kmer-count.h"
+#include "bench-fm.h"
+#include "bench-sort.h"
+#include "Profiler.h"
+#include "ResourceReport.h"
+#include "MemoryPolicy.h"
 
 #define PROGRAM_BIN "sga"
 #define AUTHOR "Jared Simpson"
@@ -53,7 +58,12 @@ static const char *SGA_USAGE_MESSAGE =
 "Program: " PACKAGE_NAME "\n"
 "Version: " PACKAGE_VERSION "\n"
 "Contact: " AUTHOR " [" PACKAGE_BUGREPORT "]\n"
-"Usage: " PROGRAM_BIN " <command> [options]\n\n"
+"Usage: " PROGRAM_BIN " [--report-json=FILE] [--hugepages=MODE] [--numa=MODE] [--pin-threads] <command> [options]\n\n"
+"      --report-json=FILE               write a JSON report of the time, memory and I/O used by the command to FILE\n"
+"      --hugepages=MODE                 back the FM-index arrays with huge pages. MODE is none (default), transparent\n"
+"                                       or explicit (the reserved pool, falling back to transparent)\n"
+"      --numa=MODE                      place the FM-index arrays on the NUMA nodes. MODE is local (default) or interleave\n"
+"      --pin-threads                    pin each worker thread to a processor\n\n"
 "Commands:\n"
 "           preprocess               filter and quality-trim reads\n"
 "           index                    build the BWT and FM-index for a set of reads\n"
@@ -83,11 +93,94 @@ static const char *SGA_USAGE_MESSAGE =
 "           filterBAM             filter out contaminating mate-pair data in a BAM file\n"
 "           cluster               find clusters of reads belonging to the same connected component in an assembly graph\n"
 "           kmer-count            extract all kmers from a BWT file\n"
+"           bench-fm              measure the speed of the FM-index queries\n"
+"           bench-sort            measure the scaling of the parallel suffix sort\n"
 //"           connect         resolve the complete sequence of a paired-end fragment\n"
+"\nEnvironment:\n"
+"           SGA_PROFILE_FILE=FILE    write the internal profiling metrics to FILE as JSON on exit\n"
+"                                    or when the process receives SIGUSR1\n"
+"           SGA_PROFILE_COUNTERS=1   also record the hardware performance counters (cycles, instructions,\n"
+"                                    cache and TLB misses) for each timed scope, per thread\n"
 "\nReport bugs to " PACKAGE_BUGREPORT "\n\n";
 
+// Parse an option of the form --name=VALUE or --name VALUE from the
+// front of the argument list, removing it from the list. Returns false
+// if the first argument is not this option.
+static bool parseGlobalOption(const std::string& name, int& argc, char**& argv, std::string& outValue)
+{
+    outValue.clear();
+    std::string arg(argv[1]);
+    if(arg.compare(0, name.size(), name) != 0)
+        return false;
+
+    if(arg.size() > name.size() && arg[name.size()] == '=')
+    {
+        outValue = arg.substr(name.size() + 1);
+        argc -= 1;
+        argv += 1;
+    }
+    else if(arg == name && argc > 2)
+    {
+        outValue = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+    else if(arg != name)
+    {
+        return false;
+    }
+
+    if(outValue.empty())
+    {
+        std::cerr << PROGRAM_BIN ": " << name << " requires a value\n";
+        exit(EXIT_FAILURE);
+    }
+    return true;
+}
+
 int main(int argc, char** argv)
 {
+    // Parse the options that apply to every command
+    std::string reportFile;
+    std::string value;
+    while(argc > 1)
+    {
+        if(parseGlobalOption("--report-json", argc, argv, value))
+        {
+            reportFile = value;
+        }
+        else if(parseGlobalOption("--hugepages", argc, argv, value))
+        {
+            MemoryPolicy::HugePagePolicy policy;
+            if(!MemoryPolicy::parseHugePagePolicy(value, policy))
+            {
+                std::cerr << PROGRAM_BIN ": invalid huge page mode: " << value << "\n";
+                return 1;
+            }
+            MemoryPolicy::setHugePagePolicy(policy);
+        }
+        else if(parseGlobalOption("--numa", argc, argv, value))
+        {
+            MemoryPolicy::NUMAPolicy policy;
+            if(!MemoryPolicy::parseNUMAPolicy(value, policy))
+            {
+                std::cerr << PROGRAM_BIN ": invalid NUMA mode: " << value << "\n";
+                return 1;
+            }
+            MemoryPolicy::setNUMAPolicy(policy);
+        }
+        else if(std::string(argv[1]) == "--pin-threads")
+        {
+            MemoryPolicy::setPinThreads(true);
+            argc -= 1;
+            argv += 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
     if(argc <= 1)
     {
         std::cout << SGA_USAGE_MESSAGE;
@@ -107,6 +200,10 @@ int main(int argc, char** argv)
             return 0;
         }
 
+        Profiler::initialize();
+        if(!reportFile.empty())
+            ResourceReport::start(reportFile, argc - 1, argv + 1);
+
         if(command == "preprocess")
             preprocessMain(argc - 1, argv + 1);
         else if(command == "index")
@@ -167,6 +264,10 @@ int main(int argc, char** argv)
             graphConcordanceMain(argc - 1, argv + 1);
         else if(command == "somatic-variant-filters")
             somaticVariantFiltersMain(argc - 1, argv + 1);
+        else if(command == "bench-fm")
+            benchFMMain(argc - 1, argv + 1);
+        else if(command == "bench-sort")
+            benchSortMain(argc - 1, argv + 1);
         else if(command == "kmer-count")
             kmerCountMain(argc - 1, argv + 1);
         else
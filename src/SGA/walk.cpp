@@ -124,6 +124,7 @@ void walk()
     // file and builds a vector with their lengths. The second pass
     // writes a SAM file of the reads making up the walk
     StringVector walkNames;
+    std::string str;
     for(size_t i = 0; i < walkVector.size(); ++i)
     {
         SGWalk& walk = walkVector[i];
@@ -137,7 +138,7 @@ void walk()
         std::string walkID = idSS.str();
         walkNames.push_back(walkID);
 
-        std::string str = walk.getString(SGWT_START_TO_END);
+        walk.getString(SGWT_START_TO_END, str);
         if(opt::verbose > 0)
         {
             std::cout << walkID << "\n";
@@ -159,7 +160,7 @@ void walk()
         {
             SGWalk& walk = walkVector[i];
             SGWalkVertexPlacementVector placementVector;
-            walk.getString(SGWT_START_TO_END, &placementVector);
+            walk.getString(SGWT_START_TO_END, str, &placementVector);
 
             for(size_t j = 0; j < placementVector.size(); ++j)
             {
@@ -276,39 +277,50 @@ void componentWalk(StringGraph* pGraph, SGWalkVector& outWalks)
 
     std::cout << "selected component has " << terminals.size() << " terminal vertices\n";
 
-    // Find walks between all-pairs of terminal vertices
-    SGWalkVector tempWalks;
+    // Find walks between all-pairs of terminal vertices. The unique walks
+    // are kept ordered by decreasing length, then by sequence. When only the
+    // longest walks are output, a walk that is shorter than all of the walks
+    // kept so far is discarded before its sequence is built.
+    typedef std::pair<int, std::string> WalkKey; // negated length, sequence
+    typedef std::map<WalkKey, SGWalk> WalkMap;
+    WalkMap walkMap;
+
+    SGWalkVector pairWalks;
+    std::string walkString;
+    SGSearchNodePool searchPool;
     for(size_t i = 0; i < terminals.size(); ++i)
     {
         for(size_t j = i + 1; j < terminals.size(); j++)
         {
             Vertex* pX = terminals[i];
             Vertex* pY = terminals[j];
-            SGSearch::findWalks(pX, pY, ED_SENSE, opt::maxDistance, 1000000, false, tempWalks);
-            SGSearch::findWalks(pX, pY, ED_ANTISENSE, opt::maxDistance, 1000000, false, tempWalks);   
-        }
-    }
+            pairWalks.clear();
+            SGSearch::findWalks(pX, pY, ED_SENSE, opt::maxDistance, 1000000, false, pairWalks, &searchPool);
+            SGSearch::findWalks(pX, pY, ED_ANTISENSE, opt::maxDistance, 1000000, false, pairWalks, &searchPool);
 
-    // Remove duplicate walks
-    std::map<std::string, SGWalk> walkMap;
-    for(size_t i = 0; i < tempWalks.size(); ++i)
-    {
-        std::string walkString = tempWalks[i].getString(SGWT_START_TO_END);
-        walkMap.insert(std::make_pair(walkString, tempWalks[i]));
+            for(size_t k = 0; k < pairWalks.size(); ++k)
+            {
+                bool isFull = opt::numOutputWalks > 0 && (int)walkMap.size() >= opt::numOutputWalks;
+                int negLength = -pairWalks[k].getStartToEndDistance();
+                if(isFull && negLength > walkMap.rbegin()->first.first)
+                    continue;
+
+                pairWalks[k].getString(SGWT_START_TO_END, walkString);
+                WalkKey key(negLength, walkString);
+                if(isFull && !(key < walkMap.rbegin()->first))
+                    continue;
+
+                // Remove duplicate walks and the walk that is no longer among the longest
+                bool inserted = walkMap.insert(std::make_pair(key, pairWalks[k])).second;
+                if(inserted && isFull)
+                    walkMap.erase(--walkMap.end());
+            }
+        }
     }
 
     // Copy unique walks to the output
-    for(std::map<std::string, SGWalk>::iterator mapIter = walkMap.begin(); mapIter != walkMap.end(); ++mapIter)
+    for(WalkMap::iterator mapIter = walkMap.begin(); mapIter != walkMap.end(); ++mapIter)
         outWalks.push_back(mapIter->second);
-
-    // Sort the walks by string length
-    std::sort(outWalks.begin(), outWalks.end(), SGWalk::compareByTotalLength);
-
-    if(opt::numOutputWalks > 0 && opt::numOutputWalks < (int)outWalks.size())
-    {
-        assert(outWalks.begin() + opt::numOutputWalks < outWalks.end());
-        outWalks.erase(outWalks.begin() + opt::numOutputWalks, outWalks.end());
-    }
 }
 
 // 
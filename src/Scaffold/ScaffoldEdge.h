@@ -49,6 +49,23 @@ class ScaffoldEdge
         //
         friend std::ostream& operator<<(std::ostream& out, const ScaffoldEdge& edge);
 
+        // Memory management
+        // Allocated from the arena of the scaffold graph
+        void* operator new(size_t size, Arena* pArena)
+        {
+            return pArena->alloc(size);
+        }
+
+        void operator delete(void* target, Arena* /*pArena*/)
+        {
+            Arena::dealloc(target);
+        }
+
+        void operator delete(void* target)
+        {
+            Arena::dealloc(target);
+        }
+
     private:
         ScaffoldVertex* m_pEnd;
         ScaffoldEdge* m_pTwin;
@@ -13,6 +13,7 @@
 ScaffoldGraph::ScaffoldGraph()
 {
     m_vertices.set_deleted_key("");
+    m_pArena = new Arena();
 }
 
 //
@@ -25,6 +26,7 @@ ScaffoldGraph::~ScaffoldGraph()
         delete iter->second;
         iter->second = NULL;
     }
+    delete m_pArena;
 }
 
 //
@@ -123,7 +125,7 @@ void ScaffoldGraph::loadVertices(const std::string& filename, int minLength)
         int contigLength = sr.seq.length();
         if(contigLength >= minLength)
         {
-            ScaffoldVertex* pVertex = new ScaffoldVertex(sr.id, sr.seq.length());
+            ScaffoldVertex* pVertex = new(m_pArena) ScaffoldVertex(sr.id, sr.seq.length());
             addVertex(pVertex);
         }
     }    
@@ -207,8 +209,8 @@ void ScaffoldGraph::loadDistanceEstimateEdges(const std::string& filename, bool
                 }
                 else
                 {
-                    ScaffoldEdge* pEdge1 = new ScaffoldEdge(pVertex2, link1);
-                    ScaffoldEdge* pEdge2 = new ScaffoldEdge(pVertex1, link2);
+                    ScaffoldEdge* pEdge1 = new(m_pArena) ScaffoldEdge(pVertex2, link1);
+                    ScaffoldEdge* pEdge2 = new(m_pArena) ScaffoldEdge(pVertex1, link2);
 
                     pEdge1->setTwin(pEdge2);
                     pEdge2->setTwin(pEdge1);
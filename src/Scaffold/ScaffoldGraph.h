@@ -61,12 +61,16 @@ class ScaffoldGraph
 
         void writeDot(const std::string& outFile) const;
 
+        // Returns the allocator for the vertices and edges of the graph
+        Arena* getArena() { return m_pArena; }
+
     private:
 
         void parseDERecord(const std::string& record, std::string& id, 
                            EdgeComp& comp, int& distance, int& numPairs, double& stdDev);
 
         ScaffoldVertexMap m_vertices;
+        Arena* m_pArena;
 
 };
 
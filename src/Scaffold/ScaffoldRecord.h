@@ -32,8 +32,21 @@ struct ResolveStats
         overlapFailed = 0;
     }
 
-    ~ResolveStats() { print(); }
-    
+    // Add the counts of another stats object to this one
+    void add(const ResolveStats& other)
+    {
+        numGapsResolved += other.numGapsResolved;
+        numGapsAttempted += other.numGapsAttempted;
+        numScaffolds += other.numScaffolds;
+
+        graphWalkFound += other.graphWalkFound;
+        graphWalkTooMany += other.graphWalkTooMany;
+        graphWalkNoPath += other.graphWalkNoPath;
+
+        overlapFound += other.overlapFound;
+        overlapFailed += other.overlapFailed;
+    }
+
     void print() const
     {
         printf("Num scaffolds: %d\n", numScaffolds);
@@ -49,10 +49,11 @@ void ScaffoldSearch::findVariantWalks(ScaffoldVertex* pX,
                                       EdgeDir initialDir, 
                                       int maxDistance,
                                       size_t maxWalks, 
-                                      ScaffoldWalkVector& outWalks)
+                                      ScaffoldWalkVector& outWalks,
+                                      ScaffoldSearchNodePool* pPool)
 {
     (void)maxWalks;
-    ScaffoldSearchTree searchTree(pX, NULL, initialDir, maxDistance, 10000);
+    ScaffoldSearchTree searchTree(pX, NULL, initialDir, maxDistance, 10000, pPool);
     // Iteravively perform the BFS using the search tree. After each step
     // we check if the search has collapsed to a single vertex.
     bool done = false;
@@ -106,9 +107,10 @@ void ScaffoldSearch::findPrimaryWalks(ScaffoldVertex* pX,
                                       EdgeDir initialDir,
                                       int maxDistance,
                                       size_t maxNodes, 
-                                      ScaffoldWalkVector& outWalks)
+                                      ScaffoldWalkVector& outWalks,
+                                      ScaffoldSearchNodePool* pPool)
 {
-    ScaffoldSearchTree searchTree(pX, pY, initialDir, maxDistance, maxNodes);
+    ScaffoldSearchTree searchTree(pX, pY, initialDir, maxDistance, maxNodes, pPool);
 
     // Iteravively perform the BFS using the search tree.
     while(searchTree.stepOnce()) { }
@@ -24,6 +24,7 @@ struct ScaffoldDistanceFunction
 
 //
 typedef GraphSearchTree<ScaffoldVertex, ScaffoldEdge, ScaffoldDistanceFunction> ScaffoldSearchTree;
+typedef ScaffoldSearchTree::NodePool ScaffoldSearchNodePool;
 
 //
 struct ScaffoldWalkBuilder
@@ -51,7 +52,8 @@ namespace ScaffoldSearch
                           EdgeDir initialDir, 
                           int maxDistance,
                           size_t maxWalks, 
-                          ScaffoldWalkVector& outWalks);
+                          ScaffoldWalkVector& outWalks,
+                          ScaffoldSearchNodePool* pPool = NULL);
 
     
     // Return the index of a walk in allWalks that every vertex in coverVector
@@ -66,7 +68,8 @@ namespace ScaffoldSearch
                           EdgeDir intialDir,
                           int maxDistance,
                           size_t maxNodes, 
-                          ScaffoldWalkVector& outWalks);
+                          ScaffoldWalkVector& outWalks,
+                          ScaffoldSearchNodePool* pPool = NULL);
 
     void printWalks(const ScaffoldWalkVector& walkVector);
 
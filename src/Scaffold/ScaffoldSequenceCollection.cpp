@@ -125,3 +125,49 @@ void MapSequenceCollection::writeUnplaced(std::ostream* pWriter, int minLength)
     }
 }
 
+
+//
+CachedSequenceCollection::CachedSequenceCollection(const ScaffoldSequenceCollection* pBase) : m_pBase(pBase)
+{
+
+}
+
+// Returns the sequence with the given ID, looking it up in the base collection
+// if it has not been cached yet
+std::string CachedSequenceCollection::getSequence(const std::string& id) const
+{
+    SequenceCacheMap::const_iterator iter = m_cache.find(id);
+    if(iter != m_cache.end())
+        return iter->second;
+
+    std::string sequence = m_pBase->getSequence(id);
+    m_cache.insert(std::make_pair(id, sequence));
+    return sequence;
+}
+
+// 
+void CachedSequenceCollection::setPlaced(const std::string& id)
+{
+    m_placed.push_back(id);
+}
+
+//
+void CachedSequenceCollection::writeUnplaced(std::ostream* /*pWriter*/, int /*minLength*/)
+{
+    std::cerr << "Error: writeUnplaced is not supported by CachedSequenceCollection\n";
+    exit(EXIT_FAILURE);
+}
+
+//
+void CachedSequenceCollection::flushPlaced(ScaffoldSequenceCollection* pTarget)
+{
+    for(size_t i = 0; i < m_placed.size(); ++i)
+        pTarget->setPlaced(m_placed[i]);
+    m_placed.clear();
+}
+
+//
+void CachedSequenceCollection::clearCache()
+{
+    m_cache.clear();
+}
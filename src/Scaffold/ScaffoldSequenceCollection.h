@@ -88,4 +88,41 @@ class MapSequenceCollection : public ScaffoldSequenceCollection
         SMPMap m_map;
 };
 
+// ScaffoldSequenceCollection that wraps another collection for use
+// by a single worker thread. Sequences read from the shared collection
+// are cached so each contig is only decoded once per batch of scaffolds
+// and requests to mark sequences as placed are buffered until
+// they are flushed to the shared collection by the owning thread.
+class CachedSequenceCollection : public ScaffoldSequenceCollection
+{
+    public:
+
+        //
+        CachedSequenceCollection(const ScaffoldSequenceCollection* pBase);
+        ~CachedSequenceCollection() {}
+
+        // Returns the sequence with the given ID
+        std::string getSequence(const std::string& id) const;
+
+        // Buffer the placement of the sequence
+        void setPlaced(const std::string& id);
+
+        // Unsupported, the unplaced sequences must be written from the base collection
+        void writeUnplaced(std::ostream* pWriter, int minLength);
+
+        // Mark all the buffered sequences as placed in pTarget and clear the buffer
+        void flushPlaced(ScaffoldSequenceCollection* pTarget);
+
+        // Discard the cached sequences
+        void clearCache();
+
+    private:
+
+        typedef std::map<std::string, std::string> SequenceCacheMap;
+
+        const ScaffoldSequenceCollection* m_pBase;
+        mutable SequenceCacheMap m_cache;
+        StringVector m_placed;
+};
+
 #endif
@@ -72,6 +72,23 @@ class ScaffoldVertex
         void writeDot(std::ostream* pWriter) const;
         void writeEdgesDot(std::ostream* pWriter) const;
 
+        // Memory management
+        // Allocated from the arena of the scaffold graph
+        void* operator new(size_t size, Arena* pArena)
+        {
+            return pArena->alloc(size);
+        }
+
+        void operator delete(void* target, Arena* /*pArena*/)
+        {
+            Arena::dealloc(target);
+        }
+
+        void operator delete(void* target)
+        {
+            Arena::dealloc(target);
+        }
+
     private:
         VertexID m_id;
         size_t m_seqLen;
@@ -212,7 +212,7 @@ void ScaffoldChainVisitor::previsit(ScaffoldGraph* /*pGraph*/)
 }
 
 // 
-bool ScaffoldChainVisitor::visit(ScaffoldGraph* /*pGraph*/, ScaffoldVertex* pVertex)
+bool ScaffoldChainVisitor::visit(ScaffoldGraph* pGraph, ScaffoldVertex* pVertex)
 {
     // Never try to make chains from a repeat
     if(pVertex->getClassification() == SVC_REPEAT)
@@ -276,8 +276,8 @@ bool ScaffoldChainVisitor::visit(ScaffoldGraph* /*pGraph*/, ScaffoldVertex* pVer
                 // Create the new edges
                 ScaffoldLink linkYZ(pZ->getID(), dir_yz, comp, dist, sd, 0, pZ->getSeqLen(), SLT_INFERRED);
                 ScaffoldLink linkZY(pY->getID(), dir_zy, comp, dist, sd, 0, pY->getSeqLen(), SLT_INFERRED);
-                ScaffoldEdge* pYZ = new ScaffoldEdge(pZ, linkYZ);
-                ScaffoldEdge* pZY = new ScaffoldEdge(pY, linkZY);
+                ScaffoldEdge* pYZ = new(pGraph->getArena()) ScaffoldEdge(pZ, linkYZ);
+                ScaffoldEdge* pZY = new(pGraph->getArena()) ScaffoldEdge(pY, linkZY);
                 pYZ->setTwin(pZY);
                 pZY->setTwin(pYZ);
 
@@ -360,7 +360,7 @@ bool ScaffoldTransitiveReductionVisitor::visit(ScaffoldGraph* /*pGraph*/, Scaffo
         // Search the graph for a variation walk that contains a common
         // endpoint for all links
         ScaffoldWalkVector walkVector;
-        ScaffoldSearch::findVariantWalks(pVertex, dir, 1000000, 100, walkVector);
+        ScaffoldSearch::findVariantWalks(pVertex, dir, 1000000, 100, walkVector, &m_searchPool);
 
         // Search the walks to see if one contains all the links.
         int walkIdx = -1;
@@ -538,7 +538,7 @@ bool ScaffoldSVVisitor::visit(ScaffoldGraph* /*pGraph*/, ScaffoldVertex* pVertex
         // Search the graph for a variation walk that contains a common
         // endpoint for all links
         ScaffoldWalkVector walkVector;
-        ScaffoldSearch::findVariantWalks(pVertex, dir, 50000, 100, walkVector);
+        ScaffoldSearch::findVariantWalks(pVertex, dir, 50000, 100, walkVector, &m_searchPool);
 
         // Search the walks to see if one contains all the links.
         ScaffoldVertexPtrVector linkedVertices;
@@ -12,6 +12,7 @@
 
 #include "ScaffoldGraph.h"
 #include "SGUtil.h"
+#include "ScaffoldSearch.h"
 
 //
 namespace ScaffoldAlgorithms
@@ -104,6 +105,8 @@ class ScaffoldTransitiveReductionVisitor
         bool visit(ScaffoldGraph* pGraph, ScaffoldVertex* pVertex);
         void postvisit(ScaffoldGraph* /*pGraph*/);
 
+    private:
+        ScaffoldSearchNodePool m_searchPool;
 };
 
 // Detect and remove polymorphmic vertices in the scaffold
@@ -134,6 +137,7 @@ class ScaffoldSVVisitor
     private:
         int m_maxSVSize;
         int m_numMarked;
+        ScaffoldSearchNodePool m_searchPool;
 };
 
 // Remove the vertices with conflicting distance estimates
@@ -12,21 +12,31 @@
 #include "CompleteOverlapSet.h"
 
 // 
-CompleteOverlapSet::CompleteOverlapSet(const Vertex* pVertex, double maxER, int minLength) : m_pX(pVertex), m_maxER(maxER), m_minLength(minLength)
+CompleteOverlapSet::CompleteOverlapSet(const Vertex* pVertex, double maxER, int minLength, ExploreBuffers* pBuffers) : m_pX(pVertex), m_maxER(maxER), m_minLength(minLength)
 {
     m_cost = 0;
     //iterativeConstruct();
-    constructBFS();
+    if(pBuffers != NULL)
+    {
+        constructBFS(*pBuffers);
+    }
+    else
+    {
+        ExploreBuffers buffers;
+        constructBFS(buffers);
+    }
     //constructMap();
 }
 
 // Perform a breadth-first search of the graph, accumulating all the valid
 // overlaps of reads to m_pX. 
 // Precondition: All vertices in the graph are colored GC_WHTE
-void CompleteOverlapSet::constructBFS()
+void CompleteOverlapSet::constructBFS(ExploreBuffers& buffers)
 {
-    EdgeDescList markedList;
-    ExploreQueue queue;
+    // The vertices are marked by color so the visited set of the buffers
+    // is not used. Every dequeued element is kept in the queue storage
+    // so the colors can be reset afterwards.
+    buffers.clear();
     EdgePtrVec edges = m_pX->getEdges();
     for(size_t i = 0; i < edges.size(); ++i)
     {
@@ -34,19 +44,17 @@ void CompleteOverlapSet::constructBFS()
         EdgeDesc ed = pEdge->getDesc();
         Overlap ovr = pEdge->getOverlap();
         ed.pVertex->setColor(GC_GRAY);
-        queue.push(ExploreElement(ed, ovr));
+        buffers.push(ExploreElement(ed, ovr));
     }
 
-    while(!queue.empty())
+    while(!buffers.empty())
     {
-        ExploreElement ee = queue.front();
-        queue.pop();
+        ExploreElement ee = buffers.pop();
         //
         EdgeDesc& edXY = ee.ed;
         Vertex* pY = edXY.pVertex;
         Overlap& ovrXY = ee.ovr;
         int overlapLen = ovrXY.getOverlapLength(0);
-        markedList.push_back(edXY);
         
         // Check if the overlap between this node and m_pX is valid
         if(overlapLen >= m_minLength)
@@ -81,21 +89,23 @@ void CompleteOverlapSet::constructBFS()
             // Check that this vertex actually overlaps pX
             if(SGAlgorithms::hasTransitiveOverlap(ovrXY, ovrYZ))
             {
+                ++m_cost;
                 Overlap ovrXZ = SGAlgorithms::inferTransitiveOverlap(ovrXY, ovrYZ);
                 EdgeDesc edXZ = SGAlgorithms::overlapToEdgeDesc(pZ, ovrXZ);
 
                 if(ovrXZ.getOverlapLength(0) >= m_minLength)
                 {
                     pZ->setColor(GC_GRAY);
-                    queue.push(ExploreElement(edXZ, ovrXZ));
+                    buffers.push(ExploreElement(edXZ, ovrXZ));
                 }
             }
         }
     }
+    buffers.cost += m_cost;
 
     // reset colors
-    for(EdgeDescList::iterator iter = markedList.begin(); iter != markedList.end(); ++iter)
-        iter->pVertex->setColor(GC_WHITE);
+    for(size_t i = 0; i < buffers.queue.size(); ++i)
+        buffers.queue[i].ed.pVertex->setColor(GC_WHITE);
 }
 
 // Perform a breadth-first search of the graph, accumulating all the valid
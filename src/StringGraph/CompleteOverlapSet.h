@@ -42,11 +42,43 @@ typedef std::priority_queue<ExploreElement,
 typedef std::list<EdgeDesc> EdgeDescList;
 typedef std::queue<ExploreElement> ExploreQueue;
 
+// Storage for the breadth-first explorations of the graph. The queue
+// is a vector that is consumed from the front and is only emptied by
+// clear() so that an object that is reused for many explorations, 
+// for instance one held by a visitor, does not reallocate.
+// An object must not be shared between threads.
+struct ExploreBuffers
+{
+    ExploreBuffers() : head(0), cost(0) {}
+
+    // Reset the queue and the visited set. The cost is not reset.
+    void clear()
+    {
+        queue.clear();
+        head = 0;
+        visited.clear();
+    }
+
+    bool empty() const { return head == queue.size(); }
+    void push(const ExploreElement& elem) { queue.push_back(elem); }
+    ExploreElement pop() { return queue[head++]; }
+
+    std::vector<ExploreElement> queue;
+    size_t head;
+
+    // The edges that have been enqueued
+    SGAlgorithms::EdgeDescHashSet visited;
+
+    // The number of overlaps inferred
+    size_t cost;
+};
+
 class CompleteOverlapSet
 {
     public:
 
-        CompleteOverlapSet(const Vertex* pVertex, double maxER, int minLength);
+        // If pBuffers is NULL, temporary storage is used for the exploration
+        CompleteOverlapSet(const Vertex* pVertex, double maxER, int minLength, ExploreBuffers* pBuffers = NULL);
 
         void getDiffMap(SGAlgorithms::EdgeDescOverlapMap& missingMap, SGAlgorithms::EdgeDescOverlapMap& extraMap);
         void removeOverlapsTo(Vertex* pRemove);
@@ -74,7 +106,7 @@ class CompleteOverlapSet
 
         // functions
         void iterativeConstruct();
-        void constructBFS();
+        void constructBFS(ExploreBuffers& buffers);
 
         // data
         SGAlgorithms::EdgeDescOverlapMap m_overlapMap;
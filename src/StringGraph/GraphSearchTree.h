@@ -10,58 +10,67 @@
 // and end vertices, up to a given distance. Used to search a
 // string graph or scaffold graph.
 //
+// The nodes of the tree are stored in a flat pool and refer
+// to their parent by index. As the tree is built breadth-first
+// the nodes waiting to be expanded are always the most recently
+// created ones, so the frontier is a range of the pool. A pool
+// can be passed in to reuse its memory across many searches.
+//
 #ifndef GRAPHSEARCHTREE_H
 #define GRAPHSEARCHTREE_H
 
 #include "Bigraph.h"
 #include "SGWalk.h"
-#include <deque>
+#include "BitVector.h"
 #include <queue>
 
-template<typename VERTEX, typename EDGE, typename DISTANCE>
-class GraphSearchNode
+template<typename VERTEX, typename EDGE>
+struct GraphSearchNode
 {
-    // Typedefs
-    public:
-        typedef std::deque<GraphSearchNode<VERTEX,EDGE,DISTANCE>* > GraphSearchNodePtrDeque;
-        typedef std::vector<EDGE*> _EDGEPtrVector;
+    VERTEX* pVertex;
+    EDGE* pEdgeFromParent;
+    int64_t distance;
 
-    public:
-        GraphSearchNode(VERTEX* pVertex, EdgeDir expandDir, GraphSearchNode* pParent, EDGE* pEdgeFromParent, int distance);
-        ~GraphSearchNode();
+    // The index of the parent node in the pool, -1 for the root
+    int parent;
+    EdgeDir expandDir;
+};
 
-        // Reduce the child count by 1
-        void decrementChildren();
+// Storage for the nodes of a search tree. The contents are
+// only valid during the search that is using the pool.
+template<typename VERTEX, typename EDGE>
+struct GraphSearchNodePool
+{
+    typedef GraphSearchNode<VERTEX,EDGE> _SearchNode;
 
-        // Create the children of this node and place pointers to their nodes
-        // on the queue. Returns the number of children created;
-        int createChildren(GraphSearchNodePtrDeque& outQueue, const DISTANCE& distanceFunc);
+    void clear()
+    {
+        nodes.clear();
+        goalLeaves.clear();
+        doneLeaves.clear();
+    }
 
-        GraphSearchNode* getParent() const { return m_pParent; }
-        VERTEX* getVertex() const { return m_pVertex; }
-        int64_t getDistance() const { return m_distance; }
-        EDGE* getEdgeFromParent() const { return m_pEdgeFromParent; }
-        int getNumChildren() const { return m_numChildren; }
+    std::vector<_SearchNode> nodes;
 
-    private:
+    // Leaves that represent the goal vertex and leaves
+    // that will not be expanded further
+    std::vector<int> goalLeaves;
+    std::vector<int> doneLeaves;
 
-        // data
-        VERTEX* m_pVertex;
-        EdgeDir m_expandDir;
-        GraphSearchNode* m_pParent;
-        EDGE* m_pEdgeFromParent;
+    // Per-node flags used while building walks. All bits
+    // are clear between uses.
+    BitVector visited;
 
-        int m_numChildren;
-        int64_t m_distance;
+    // Scratch space for building walks
+    std::vector<EDGE*> walk;
 };
 
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 class GraphSearchTree
 {
     // typedefs
-    typedef GraphSearchNode<VERTEX,EDGE,DISTANCE> _SearchNode;
-    typedef typename _SearchNode::GraphSearchNodePtrDeque _SearchNodePtrDeque;
-    typedef typename std::set<_SearchNode*> _SearchNodePtrSet;
+    typedef GraphSearchNode<VERTEX,EDGE> _SearchNode;
+    typedef std::vector<int> _SearchNodeIdxVector;
     typedef std::vector<EDGE*> WALK; // list of edges defines a walk through the graph
     typedef std::vector<WALK> WALKVector; // vector of walks
     
@@ -70,11 +79,15 @@ class GraphSearchTree
 
     public:
 
+        typedef GraphSearchNodePool<VERTEX,EDGE> NodePool;
+
+        // If pPool is NULL the tree uses its own pool
         GraphSearchTree(VERTEX* pStartVertex, 
                      VERTEX* pEndVertex,
                      EdgeDir searchDir,
                      int64_t distanceLimit,
-                     size_t nodeLimit);
+                     size_t nodeLimit,
+                     NodePool* pPool = NULL);
 
         ~GraphSearchTree();
 
@@ -114,36 +127,36 @@ class GraphSearchTree
 
     private:
 
-        // Search the branch from pNode to the root for pX.  
-        bool searchBranchForVertex(_SearchNode* pNode, VERTEX* pX, _SearchNode*& pFoundNode) const;
+        // Not copyable
+        GraphSearchTree(const GraphSearchTree&);
+        GraphSearchTree& operator=(const GraphSearchTree&);
 
-        // Build the walks from the root to the leaves in the queue
-        template<typename BUILDER>
-        void _buildWalksToLeaves(const _SearchNodePtrDeque& queue, BUILDER& walkBuilder);
+        // Search the branch from node idx to the root for pX. Returns the index of
+        // the furthest node from the root containing pX, or -1 if it is not found.
+        int searchBranchForVertex(int idx, VERTEX* pX) const;
 
-        //
-        void addEdgesFromBranch(_SearchNode* pNode, WALK& outEdges);
+        // Build the walks from the root to the given leaves
+        template<typename BUILDER>
+        void _buildWalksToLeaves(const _SearchNodeIdxVector& leaves, BUILDER& walkBuilder);
 
-        // Build a queue with all the leaves in it
-        void _makeFullLeafQueue(_SearchNodePtrDeque& completeQueue) const;
+        // Build a vector with all the leaves in it
+        void _makeFullLeafQueue(_SearchNodeIdxVector& completeQueue) const;
 
         // print the branch sequence
-        void printBranch(_SearchNode* pNode) const;
-
-        // We keep the pointers to the search nodes
-        // in one of three queues. 
-        // The goal queue contains the nodes representing the vertex we are searching for.
-        // The expand queue contains nodes that have not yet been explored.
-        // The done queue contains non-goal nodes that will not be expanded further.
-        // Together, they represent all leaves of the tree
-        _SearchNodePtrDeque m_goalQueue;
-        _SearchNodePtrDeque m_expandQueue;
-        _SearchNodePtrDeque m_doneQueue;
-        size_t m_totalNodes; // The total number of nodes in the search tree
+        void printBranch(int idx) const;
+
+        // The pool holding the nodes of the tree. The root is node 0.
+        NodePool m_localPool;
+        NodePool* m_pPool;
+
+        // The nodes waiting to be expanded are the pool
+        // entries in [m_expandBegin, m_expandEnd). Together with
+        // the goal and done leaves in the pool they represent all 
+        // leaves of the tree.
+        size_t m_expandBegin;
+        size_t m_expandEnd;
     
-        _SearchNode* m_pRootNode;
         VERTEX* m_pGoalVertex;
-        EdgeDir m_initialDir;
 
         int64_t m_distanceLimit;
         size_t m_nodeLimit;
@@ -155,70 +168,6 @@ class GraphSearchTree
         DISTANCE m_distanceFunc;
 };
 
-//
-template<typename VERTEX, typename EDGE, typename DISTANCE>
-GraphSearchNode<VERTEX,EDGE,DISTANCE>::GraphSearchNode(VERTEX* pVertex,
-                           EdgeDir expandDir,
-                           GraphSearchNode<VERTEX,EDGE,DISTANCE>* pParent,
-                           EDGE* pEdgeFromParent,
-                           int distance) : m_pVertex(pVertex),
-                                                    m_expandDir(expandDir),
-                                                    m_pParent(pParent), 
-                                                    m_pEdgeFromParent(pEdgeFromParent),
-                                                    m_numChildren(0)
-{
-    // Set the extension distance
-    if(m_pParent == NULL)
-    {
-        // this is the root node with distance 0
-        m_distance = 0;
-    }
-    else
-    {
-        assert(m_pEdgeFromParent != NULL);
-        m_distance = m_pParent->m_distance + distance;
-    }
-}
-
-// Delete this node and decrement the number of children
-// in the parent node. All children of a node must
-// be deleted before the parent
-template<typename VERTEX, typename EDGE, typename DISTANCE>
-GraphSearchNode<VERTEX,EDGE,DISTANCE>::~GraphSearchNode()
-{
-    assert(m_numChildren == 0);
-    if(m_pParent != NULL)
-        m_pParent->decrementChildren();
-}
-
-//
-template<typename VERTEX, typename EDGE, typename DISTANCE>
-void GraphSearchNode<VERTEX,EDGE,DISTANCE>::decrementChildren()
-{
-    assert(m_numChildren != 0);
-    m_numChildren -= 1;
-}
-
-// creates nodes for the children of this node
-// and place pointers to them in the queue.
-// Returns the number of nodes created
-template<typename VERTEX, typename EDGE, typename DISTANCE>
-int GraphSearchNode<VERTEX,EDGE,DISTANCE>::createChildren(GraphSearchNodePtrDeque& outDeque, const DISTANCE& distanceFunc)
-{
-    assert(m_numChildren == 0);
-
-    _EDGEPtrVector edges = m_pVertex->getEdges(m_expandDir);
-
-    for(size_t i = 0; i < edges.size(); ++i)
-    {
-        EdgeDir childExpandDir = !edges[i]->getTwin()->getDir();
-        GraphSearchNode* pNode = new GraphSearchNode(edges[i]->getEnd(), childExpandDir, this, edges[i], distanceFunc(edges[i]));
-        outDeque.push_back(pNode);
-        m_numChildren += 1;
-    }
-    return edges.size();
-}
-
 //
 // GraphSearchTree
 //
@@ -227,67 +176,50 @@ GraphSearchTree<VERTEX,EDGE,DISTANCE>::GraphSearchTree(VERTEX* pStartVertex,
                                                        VERTEX* pEndVertex, 
                                                        EdgeDir searchDir,
                                                        int64_t distanceLimit,
-                                                       size_t nodeLimit) : m_pGoalVertex(pEndVertex),
-                                                                           m_distanceLimit(distanceLimit),
-                                                                           m_nodeLimit(nodeLimit),
-                                                                           m_searchAborted(false)
+                                                       size_t nodeLimit,
+                                                       NodePool* pPool) : m_pPool(pPool != NULL ? pPool : &m_localPool),
+                                                                          m_pGoalVertex(pEndVertex),
+                                                                          m_distanceLimit(distanceLimit),
+                                                                          m_nodeLimit(nodeLimit),
+                                                                          m_searchAborted(false)
 {
+    m_pPool->clear();
+
     // Create the root node of the search tree
-    m_pRootNode = new GraphSearchNode<VERTEX, EDGE, DISTANCE>(pStartVertex, searchDir, NULL, NULL, 0);
+    _SearchNode root;
+    root.pVertex = pStartVertex;
+    root.pEdgeFromParent = NULL;
+    root.distance = 0;
+    root.parent = -1;
+    root.expandDir = searchDir;
+    m_pPool->nodes.push_back(root);
 
     // add the root to the expand queue
-    m_expandQueue.push_back(m_pRootNode);
-
-    m_totalNodes = 1;
+    m_expandBegin = 0;
+    m_expandEnd = 1;
 }
 
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 GraphSearchTree<VERTEX,EDGE,DISTANCE>::~GraphSearchTree()
 {
-    // Delete the tree
-    // We delete each leaf and recurse up the tree iteratively deleting
-    // parents with a single child node. This ensure that each parent is
-    // deleted after all its children
-    _SearchNodePtrDeque completeLeafNodes;
-    _makeFullLeafQueue(completeLeafNodes);
-
-    size_t totalDeleted = 0;
-    for(typename _SearchNodePtrDeque::iterator iter = completeLeafNodes.begin(); 
-                                               iter != completeLeafNodes.end();
-                                               ++iter)    
-    {
-        _SearchNode* pCurr = *iter;
-
-        // loop invariant: pCurr is a deletable node
-        // the loop stops when the parent is NULL or has 
-        // a child other than pCurr
-        do
-        {
-            assert(pCurr->getNumChildren() == 0);
-            _SearchNode* pNext = pCurr->getParent();
-            
-            delete pCurr; // decrements pNext's child count
-            totalDeleted += 1;
-
-            pCurr = pNext;
-        } while(pCurr && pCurr->getNumChildren() == 0);
-    }
-
-    assert(totalDeleted == m_totalNodes);
+    // Release the nodes but keep the memory of the pool
+    m_pPool->clear();
 }
 
 // Perform one step of the BFS
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 bool GraphSearchTree<VERTEX,EDGE,DISTANCE>::stepOnce()
 {
-    if(m_expandQueue.empty())
+    if(m_expandBegin == m_expandEnd)
         return false;
 
-    if(m_totalNodes > m_nodeLimit)
+    std::vector<_SearchNode>& nodes = m_pPool->nodes;
+    if(nodes.size() > m_nodeLimit)
     {
         // Move all nodes in the expand queue to the done queue
-        m_doneQueue.insert(m_doneQueue.end(), m_expandQueue.begin(), m_expandQueue.end());
-        m_expandQueue.clear();
+        for(size_t i = m_expandBegin; i < m_expandEnd; ++i)
+            m_pPool->doneLeaves.push_back(i);
+        m_expandBegin = m_expandEnd;
 
         // Set a flag indicating the search was aborted
         m_searchAborted = true;
@@ -297,40 +229,49 @@ bool GraphSearchTree<VERTEX,EDGE,DISTANCE>::stepOnce()
     // Iterate over the expand queue. If the path to the node
     // is outside the depth limit, move that node to the done queue. It cannot
     // yield a valid path to the goal. Otherwise, add the children of the node 
-    // to the incoming queue
-    _SearchNodePtrDeque incomingQueue;
-    while(!m_expandQueue.empty())
+    // to the end of the pool, where they form the next expand queue
+    for(size_t i = m_expandBegin; i < m_expandEnd; ++i)
     {
-        _SearchNode* pNode = m_expandQueue.front();
-        m_expandQueue.pop_front();
+        // Copy the fields we need as adding children may reallocate the pool
+        VERTEX* pVertex = nodes[i].pVertex;
+        int64_t distance = nodes[i].distance;
         
-        if(pNode->getVertex() == m_pGoalVertex)
+        if(pVertex == m_pGoalVertex)
         {
             // This node represents the goal, add it to the goal queue
-            m_goalQueue.push_back(pNode);
+            m_pPool->goalLeaves.push_back(i);
             continue;
         }
 
-        if(pNode->getDistance() > m_distanceLimit)
+        if(distance > m_distanceLimit)
         {
             // Path to this node is too long, expand it no further
-            m_doneQueue.push_back(pNode);
+            m_pPool->doneLeaves.push_back(i);
+            continue;
         }
-        else
+
+        // Add the children of this node to the pool
+        std::vector<EDGE*> edges = pVertex->getEdges(nodes[i].expandDir);
+        for(size_t j = 0; j < edges.size(); ++j)
         {
-            // Add the children of this node to the queue
-            int numCreated = pNode->createChildren(incomingQueue, m_distanceFunc);
-            m_totalNodes += numCreated;
+            _SearchNode child;
+            child.pVertex = edges[j]->getEnd();
+            child.pEdgeFromParent = edges[j];
+            child.distance = distance + m_distanceFunc(edges[j]);
+            child.parent = i;
+            child.expandDir = !edges[j]->getTwin()->getDir();
+            nodes.push_back(child);
+        }
 
-            if(numCreated == 0)
-            {
-                // No children created, add this node to the done queue
-                m_doneQueue.push_back(pNode);
-            }
+        if(edges.empty())
+        {
+            // No children created, add this node to the done queue
+            m_pPool->doneLeaves.push_back(i);
         }
     }
 
-    m_expandQueue = incomingQueue;
+    m_expandBegin = m_expandEnd;
+    m_expandEnd = nodes.size();
     return true;
 }
 
@@ -340,30 +281,26 @@ bool GraphSearchTree<VERTEX,EDGE,DISTANCE>::stepOnce()
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 bool GraphSearchTree<VERTEX,EDGE,DISTANCE>::hasSearchConverged(VERTEX*& pConvergedVertex)
 {
+    const std::vector<_SearchNode>& nodes = m_pPool->nodes;
+
     // Construct a set of all the leaf nodes
-    _SearchNodePtrDeque completeLeafNodes;
+    _SearchNodeIdxVector completeLeafNodes;
     _makeFullLeafQueue(completeLeafNodes);
 
     // Search all the tree for all the nodes in the expand queue
-    for(typename _SearchNodePtrDeque::iterator iter = m_expandQueue.begin(); 
-                                               iter != m_expandQueue.end();
-                                               ++iter)
+    for(size_t i = m_expandBegin; i < m_expandEnd; ++i)
     {
-        _SearchNode* pNode = *iter;
         // If this node has the same vertex as the root skip it
         // We do not want to collapse at the root
-        if(pNode->getVertex() == m_pRootNode->getVertex())
+        VERTEX* pVertex = nodes[i].pVertex;
+        if(pVertex == nodes[0].pVertex)
             continue;
 
         bool isInAllBranches = true;
-        for(typename _SearchNodePtrDeque::iterator leafIter = completeLeafNodes.begin();
-                                                   leafIter != completeLeafNodes.end();
-                                                   ++leafIter)
+        for(size_t j = 0; j < completeLeafNodes.size(); ++j)
         {
             // Search the current branch from this leaf node to the root
-            _SearchNode* pFoundNode = NULL;
-            bool isInBranch = searchBranchForVertex(*leafIter, pNode->getVertex(), pFoundNode);
-            if(!isInBranch)
+            if(searchBranchForVertex(completeLeafNodes[j], pVertex) == -1)
             {
                 isInAllBranches = false;
                 break;
@@ -373,7 +310,7 @@ bool GraphSearchTree<VERTEX,EDGE,DISTANCE>::hasSearchConverged(VERTEX*& pConverg
         // search has converted
         if(isInAllBranches)
         {
-            pConvergedVertex = pNode->getVertex();
+            pConvergedVertex = pVertex;
             return true;
         }
     }
@@ -389,7 +326,7 @@ template<typename BUILDER>
 void GraphSearchTree<VERTEX,EDGE,DISTANCE>::buildWalksToAllLeaves(BUILDER& walkBuilder)
 {
     // Construct a queue with all leaf nodes in it
-    _SearchNodePtrDeque completeLeafNodes;
+    _SearchNodeIdxVector completeLeafNodes;
     _makeFullLeafQueue(completeLeafNodes);
 
     _buildWalksToLeaves(completeLeafNodes, walkBuilder);
@@ -400,7 +337,7 @@ template<typename VERTEX, typename EDGE, typename DISTANCE>
 template<typename BUILDER>
 void GraphSearchTree<VERTEX,EDGE,DISTANCE>::buildWalksToGoal(BUILDER& walkBuilder)
 {
-    _buildWalksToLeaves(m_goalQueue, walkBuilder);
+    _buildWalksToLeaves(m_pPool->goalLeaves, walkBuilder);
 }
 
 // Build all the walks that contain pTarget.
@@ -408,103 +345,91 @@ template<typename VERTEX, typename EDGE, typename DISTANCE>
 template<typename BUILDER>
 void GraphSearchTree<VERTEX,EDGE,DISTANCE>::buildWalksContainingVertex(VERTEX* pTarget, BUILDER& walkBuilder)
 {
-    _SearchNodePtrDeque completeLeafNodes;
+    _SearchNodeIdxVector completeLeafNodes;
     _makeFullLeafQueue(completeLeafNodes);
 
     // Search upwards from each leaf until pTarget is found.
-    // When it is found, insert the pointer to the search node
-    // in the set
-    _SearchNodePtrSet leafSet;
-
-    // Find pTarget in each branch of the graph
-    for(typename _SearchNodePtrDeque::const_iterator iter = completeLeafNodes.begin();
-                                                     iter != completeLeafNodes.end();
-                                                     ++iter)
+    // The visited bits are used to skip nodes found from
+    // an earlier leaf.
+    BitVector& visited = m_pPool->visited;
+    if(visited.size() < m_pPool->nodes.size())
+        visited.resize(m_pPool->nodes.size());
+
+    _SearchNodeIdxVector foundNodes;
+    for(size_t i = 0; i < completeLeafNodes.size(); ++i)
     {
-        _SearchNode* pFoundNode = NULL;
-        searchBranchForVertex(*iter, pTarget, pFoundNode);
-        assert(pFoundNode != NULL);
-        leafSet.insert(pFoundNode);
+        int foundIdx = searchBranchForVertex(completeLeafNodes[i], pTarget);
+        assert(foundIdx != -1);
+        if(!visited.test(foundIdx))
+        {
+            visited.set(foundIdx, true);
+            foundNodes.push_back(foundIdx);
+        }
     }
 
+    // Reset the flags for the next user of the pool
+    for(size_t i = 0; i < foundNodes.size(); ++i)
+        visited.set(foundNodes[i], false);
+
+    // The walks are built in the order the found nodes were created
+    std::sort(foundNodes.begin(), foundNodes.end());
+
     // Construct all the walks to the found leaves
-    completeLeafNodes.clear();
-    completeLeafNodes.insert(completeLeafNodes.end(), leafSet.begin(), leafSet.end());
-    _buildWalksToLeaves(completeLeafNodes, walkBuilder);
+    _buildWalksToLeaves(foundNodes, walkBuilder);
 }
 
 // Main function for constructing a vector of walks from a set of leaves
 template<typename VERTEX, typename EDGE, typename DISTANCE>
 template<typename BUILDER>
-void GraphSearchTree<VERTEX,EDGE,DISTANCE>::_buildWalksToLeaves(const _SearchNodePtrDeque& queue, BUILDER& walkBuilder)
+void GraphSearchTree<VERTEX,EDGE,DISTANCE>::_buildWalksToLeaves(const _SearchNodeIdxVector& leaves, BUILDER& walkBuilder)
 {
-    for(typename _SearchNodePtrDeque::const_iterator iter = queue.begin();
-                                                     iter != queue.end();
-                                                     ++iter)
+    const std::vector<_SearchNode>& nodes = m_pPool->nodes;
+    WALK& currWalk = m_pPool->walk;
+    for(size_t i = 0; i < leaves.size(); ++i)
     {
-
-        // Recursively travel the tree from the leaf to the root collecting the edges in the vector
-        WALK currWalk;
-        addEdgesFromBranch(*iter, currWalk);
+        // Travel the tree from the leaf to the root collecting the edges in the vector
+        currWalk.clear();
+        for(int idx = leaves[i]; nodes[idx].parent != -1; idx = nodes[idx].parent)
+            currWalk.push_back(nodes[idx].pEdgeFromParent);
 
         // Reverse the walk and write it to the output structure
-        walkBuilder.startNewWalk(m_pRootNode->getVertex());
+        walkBuilder.startNewWalk(nodes[0].pVertex);
         for(typename WALK::reverse_iterator iter = currWalk.rbegin(); iter != currWalk.rend(); ++iter)
             walkBuilder.addEdge(*iter);
         walkBuilder.finishCurrentWalk();
     }
 }
 
-// Return true if the vertex pX is found somewhere in the branch 
-// from pNode to the root. If it is found, pFoundNode is set
-// to the furtherest instance of pX from the root.
-template<typename VERTEX, typename EDGE, typename DISTANCE>
-bool GraphSearchTree<VERTEX,EDGE,DISTANCE>::searchBranchForVertex(_SearchNode* pNode, VERTEX* pX, _SearchNode*& pFoundNode) const
-{
-    if(pNode == NULL)
-    {
-        pFoundNode = NULL;
-        return false;
-    }
-
-    if(pNode->getVertex() == pX && pNode != m_pRootNode)
-    {
-        pFoundNode = pNode;
-        return true;
-    }
-    return searchBranchForVertex(pNode->getParent(), pX, pFoundNode);
-}
-
 //
 template<typename VERTEX, typename EDGE, typename DISTANCE>
-void GraphSearchTree<VERTEX,EDGE,DISTANCE>::addEdgesFromBranch(_SearchNode* pNode, WALK& outEdges)
+int GraphSearchTree<VERTEX,EDGE,DISTANCE>::searchBranchForVertex(int idx, VERTEX* pX) const
 {
-    // Terminate the recursion at the root node and dont add an edge
-    if(pNode->getParent() != NULL)
+    // The root node is not considered
+    const std::vector<_SearchNode>& nodes = m_pPool->nodes;
+    for(; idx > 0; idx = nodes[idx].parent)
     {
-        outEdges.push_back(pNode->getEdgeFromParent());
-        return addEdgesFromBranch(pNode->getParent(), outEdges);
+        if(nodes[idx].pVertex == pX)
+            return idx;
     }
+    return -1;
 }
 
 //
 template<typename VERTEX, typename EDGE, typename DISTANCE>
-void GraphSearchTree<VERTEX,EDGE,DISTANCE>::_makeFullLeafQueue(_SearchNodePtrDeque& completeQueue) const
+void GraphSearchTree<VERTEX,EDGE,DISTANCE>::_makeFullLeafQueue(_SearchNodeIdxVector& completeQueue) const
 {
-    completeQueue.insert(completeQueue.end(), m_expandQueue.begin(), m_expandQueue.end());
-    completeQueue.insert(completeQueue.end(), m_goalQueue.begin(), m_goalQueue.end());
-    completeQueue.insert(completeQueue.end(), m_doneQueue.begin(), m_doneQueue.end());
+    for(size_t i = m_expandBegin; i < m_expandEnd; ++i)
+        completeQueue.push_back(i);
+    completeQueue.insert(completeQueue.end(), m_pPool->goalLeaves.begin(), m_pPool->goalLeaves.end());
+    completeQueue.insert(completeQueue.end(), m_pPool->doneLeaves.begin(), m_pPool->doneLeaves.end());
 }
 
 //
 template<typename VERTEX, typename EDGE, typename DISTANCE>
-void GraphSearchTree<VERTEX,EDGE,DISTANCE>::printBranch(_SearchNode* pNode) const
+void GraphSearchTree<VERTEX,EDGE,DISTANCE>::printBranch(int idx) const
 {
-    if(pNode != NULL)
-    {
-        std::cout << pNode->getVertex()->getID() << ",";
-        printBranch(pNode->getParent());
-    }
+    for(; idx != -1; idx = m_pPool->nodes[idx].parent)
+        std::cout << m_pPool->nodes[idx].pVertex->getID() << ",";
 }
 
 template<typename VERTEX, typename EDGE, typename DISTANCE>
@@ -14,22 +14,25 @@
 #include "RemovalAlgorithm.h"
 
 //
-SGAlgorithms::EdgeDescOverlapMap RemovalAlgorithm::computeRequiredOverlaps(const Vertex* pVertex, const Edge* pRemovalEdge, double maxER, int minLength)
+SGAlgorithms::EdgeDescOverlapMap RemovalAlgorithm::computeRequiredOverlaps(const Vertex* pVertex, const Edge* pRemovalEdge, double maxER, int minLength, ExploreBuffers* pBuffers)
 {
     // this procedure is only valid for proper overlaps, the edge cannot be a containment
     assert(!pRemovalEdge->getOverlap().isContainment());
+    ExploreBuffers localBuffers;
+    ExploreBuffers& buffers = pBuffers != NULL ? *pBuffers : localBuffers;
+
     SGAlgorithms::EdgeDescOverlapMap outMap;
-    findPotentialOverlaps(pVertex, pRemovalEdge, maxER, minLength, outMap);
-    eliminateReachableEdges(pVertex, pRemovalEdge, maxER, minLength, outMap);   
+    findPotentialOverlaps(pVertex, pRemovalEdge, maxER, minLength, buffers, outMap);
+    eliminateReachableEdges(pVertex, pRemovalEdge, maxER, minLength, buffers, outMap);   
     return outMap;
 }
 
 // Find edges of pRemovalEdge->getEnd() that are potentially irreducible edges of pX once pRemovalEdge
 // has been eliminated from the graph
 void RemovalAlgorithm::findPotentialOverlaps(const Vertex* pX, const Edge* pRemovalEdge, 
-                                             double maxER, int minLength, SGAlgorithms::EdgeDescOverlapMap& outMap)
+                                             double maxER, int minLength, ExploreBuffers& buffers, SGAlgorithms::EdgeDescOverlapMap& outMap)
 {
-    ExploreQueue queue;
+    buffers.clear();
     Vertex* pY = pRemovalEdge->getEnd();
     Overlap ovrXY = pRemovalEdge->getOverlap();
     EdgeDesc edXY = pRemovalEdge->getDesc();
@@ -38,15 +41,13 @@ void RemovalAlgorithm::findPotentialOverlaps(const Vertex* pX, const Edge* pRemo
     // New edges of pX must be in this direction. Edges in the direction of X
     // must have a longer overlap with X than Y does and therefore cannot be transitive
     // wrt to Y.
-    EdgeDescSet visitedSet;
     EdgeDir dirY = !pRemovalEdge->getTwin()->getDir();
-    enqueueEdges(pY, dirY, ovrXY, edXY, minLength, queue, &visitedSet);
+    enqueueEdges(pY, dirY, ovrXY, edXY, minLength, buffers);
 
     int extra_extension = 0;
-    while(!queue.empty())
+    while(!buffers.empty())
     {
-        ExploreElement ee = queue.front();
-        queue.pop();
+        ExploreElement ee = buffers.pop();
         
         // If the overlap between this element and X is valid, add it to the output map
         // and proceed no further. If the overlap is above minLength but the error rate
@@ -71,7 +72,7 @@ void RemovalAlgorithm::findPotentialOverlaps(const Vertex* pX, const Edge* pRemo
             {
                 // Enqueue neighbors of pZ
                 EdgeDir dirZ = edXZ.getTransitiveDir();
-                enqueueEdges(pZ, dirZ, ovrXZ, edXZ, minLength, queue, &visitedSet);
+                enqueueEdges(pZ, dirZ, ovrXZ, edXZ, minLength, buffers);
                 ++extra_extension;
             }
         }
@@ -83,7 +84,7 @@ void RemovalAlgorithm::findPotentialOverlaps(const Vertex* pX, const Edge* pRemo
 
 // Using the edges of pVertex, eliminate edges from outMap if they are transitive
 void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge* pRemovalEdge,
-                                               double maxER, int minLength, SGAlgorithms::EdgeDescOverlapMap& outMap)
+                                               double maxER, int minLength, ExploreBuffers& buffers, SGAlgorithms::EdgeDescOverlapMap& outMap)
 {
     // During the enqueue process, edges may have been added to outMap that are transitive to another
     // edge in outMap. We get rid of these first.
@@ -105,8 +106,7 @@ void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge
     }
     
     // Avoid loops by only enqueuing vertices that have not been visited before
-    EdgeDescSet visitedSet;
-    ExploreQueue queue;
+    buffers.clear();
 
     // Enqueue the initial overlaps of pX to the queue if they are longer than the shortest overlap
     EdgeDir dirX = pRemovalEdge->getDir();
@@ -123,8 +123,8 @@ void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge
         Overlap ovr = pEdge->getOverlap();
         if(ovr.getOverlapLength(0) >= shortestOverlap && !ovr.isContainment())
         {
-            queue.push(ExploreElement(ed, ovr));
-            visitedSet.insert(ed);
+            buffers.push(ExploreElement(ed, ovr));
+            buffers.visited.insert(ed);
         }
     }
 
@@ -132,13 +132,12 @@ void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge
     // that are transitive wrt the irreducible edges. If the edges in outMap are transitive
     // wrt to this edge set, remove them from the map. Any remaining edges are new irreducible edges.
     int num_ext = 0;
-    while(!queue.empty())
+    while(!buffers.empty())
     {
         if(outMap.empty())
             return;
 
-        ExploreElement ee = queue.front();
-        queue.pop();
+        ExploreElement ee = buffers.pop();
         
         // If the overlap between this element and X is valid, add it to the output map
         // and proceed no further. If the overlap is above minLength but the error rate
@@ -181,14 +180,14 @@ void RemovalAlgorithm::eliminateReachableEdges(const Vertex* pVertex, const Edge
         if(!outMap.empty())
         {
             num_ext++;
-            enqueueEdges(pY, edXY.getTransitiveDir(), ovrXY, edXY, shortestOverlap, queue, &visitedSet);
+            enqueueEdges(pY, edXY.getTransitiveDir(), ovrXY, edXY, shortestOverlap, buffers);
         }
     }
 }
 
 // Add the edges of pY in direction dirY to the explore queue if they have a valid overlap with X
 void RemovalAlgorithm::enqueueEdges(const Vertex* pY, EdgeDir dirY, const Overlap& ovrXY, const EdgeDesc& /*edXY*/, int minOverlap, 
-                                    ExploreQueue& outQueue, EdgeDescSet* pSeenSet)
+                                    ExploreBuffers& buffers)
 {
     EdgePtrVec edges = pY->getEdges(dirY);
     for(size_t i = 0; i < edges.size(); ++i)
@@ -201,15 +200,12 @@ void RemovalAlgorithm::enqueueEdges(const Vertex* pY, EdgeDir dirY, const Overla
 
         if(!ovrYZ.isContainment() && SGAlgorithms::hasTransitiveOverlap(ovrXY, ovrYZ))
         {
+            buffers.cost += 1;
             Overlap ovrXZ = SGAlgorithms::inferTransitiveOverlap(ovrXY, ovrYZ);
             EdgeDesc edXZ = SGAlgorithms::overlapToEdgeDesc(pZ, ovrXZ);
 
-            if((pSeenSet == NULL || pSeenSet->count(edXZ) == 0) && ovrXZ.getOverlapLength(0) >= minOverlap)
-            {
-                outQueue.push(ExploreElement(edXZ, ovrXZ));
-                if(pSeenSet != NULL)
-                    pSeenSet->insert(edXZ);
-            }
+            if(ovrXZ.getOverlapLength(0) >= minOverlap && buffers.visited.insert(edXZ).second)
+                buffers.push(ExploreElement(edXZ, ovrXZ));
         }
     }
 }
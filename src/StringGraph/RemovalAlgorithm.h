@@ -22,11 +22,14 @@ namespace RemovalAlgorithm
 {
     
 // Returns the set of overlaps that must be added to the graph
-// if the vertex at the end of pRemovalEdge is going to be deleted
-SGAlgorithms::EdgeDescOverlapMap computeRequiredOverlaps(const Vertex* pVertex, const Edge* pRemovalEdge, double maxER, int minLength);
-void findPotentialOverlaps(const Vertex* pX, const Edge* pRemovalEdge, double maxER, int minLength, SGAlgorithms::EdgeDescOverlapMap& outMap);
-void eliminateReachableEdges(const Vertex* pVertex, const Edge* pRemovalEdge, double maxER, int minLength, SGAlgorithms::EdgeDescOverlapMap& outMap);
-void enqueueEdges(const Vertex* pY, EdgeDir dirY, const Overlap& ovrXY, const EdgeDesc& edXY, int minOverlap, ExploreQueue& outQueue, EdgeDescSet* pSeenSet);
+// if the vertex at the end of pRemovalEdge is going to be deleted.
+// If pBuffers is NULL, temporary storage is used for the exploration.
+SGAlgorithms::EdgeDescOverlapMap computeRequiredOverlaps(const Vertex* pVertex, const Edge* pRemovalEdge, double maxER, int minLength, ExploreBuffers* pBuffers = NULL);
+void findPotentialOverlaps(const Vertex* pX, const Edge* pRemovalEdge, double maxER, int minLength, ExploreBuffers& buffers, SGAlgorithms::EdgeDescOverlapMap& outMap);
+void eliminateReachableEdges(const Vertex* pVertex, const Edge* pRemovalEdge, double maxER, int minLength, ExploreBuffers& buffers, SGAlgorithms::EdgeDescOverlapMap& outMap);
+
+// Enqueue the edges of pY that have not been visited yet
+void enqueueEdges(const Vertex* pY, EdgeDir dirY, const Overlap& ovrXY, const EdgeDesc& edXY, int minOverlap, ExploreBuffers& buffers);
 
 };
 
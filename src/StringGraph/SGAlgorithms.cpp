@@ -114,7 +114,7 @@ Edge* SGAlgorithms::createEdgesFromOverlap(StringGraph* pGraph, const Overlap& o
 }
 
 // Find new edges for pVertex that are required if pDeleteEdge is removed from the graph
-void SGAlgorithms::remodelVertexForExcision(StringGraph* pGraph, Vertex* pVertex, Edge* pDeleteEdge)
+void SGAlgorithms::remodelVertexForExcision(StringGraph* pGraph, Vertex* pVertex, Edge* pDeleteEdge, ExploreBuffers* pBuffers)
 {
     assert(pVertex == pDeleteEdge->getStart());
     // If the edge is a containment edge, nothing needs to be done. No edges can be transitive
@@ -125,7 +125,7 @@ void SGAlgorithms::remodelVertexForExcision(StringGraph* pGraph, Vertex* pVertex
     double maxER = pGraph->getErrorRate();
     int minLength = pGraph->getMinOverlap();
     
-    EdgeDescOverlapMap addMap = RemovalAlgorithm::computeRequiredOverlaps(pVertex, pDeleteEdge, maxER, minLength);
+    EdgeDescOverlapMap addMap = RemovalAlgorithm::computeRequiredOverlaps(pVertex, pDeleteEdge, maxER, minLength, pBuffers);
     for(EdgeDescOverlapMap::iterator iter = addMap.begin();
         iter != addMap.end(); ++iter)
     {
@@ -161,10 +161,38 @@ void SGAlgorithms::updateContainFlags(StringGraph* pGraph, Vertex* pVertex, cons
     pGraph->setContainmentFlag(true);
 }
 
+// Count the differences between the matched regions of two encoded sequences.
+// This is equivalent to Match::countDifferences but reads the bases in place
+// rather than decoding the sequences and copying the matched substrings.
+static int countMatchDifferences(const DNAEncodedString& s1, const DNAEncodedString& s2, const Match& match)
+{
+    int n1 = match.coord[0].length();
+    int n2 = match.coord[1].length();
+    int start1 = match.coord[0].interval.start;
+    int start2 = match.coord[1].interval.start;
+
+    int numDiff = 0;
+    for(int i = 0; i < n1; ++i)
+    {
+        // Positions past the end of the second region are counted as differences
+        if(i >= n2)
+        {
+            numDiff += n1 - i;
+            break;
+        }
+
+        char b1 = s1.get(start1 + i);
+        char b2 = match.isReverse ? complement(s2.get(start2 + n2 - 1 - i)) : s2.get(start2 + i);
+        if(b1 != b2)
+            numDiff++;
+    }
+    return numDiff;
+}
+
 // Calculate the error rate between the two vertices
 double SGAlgorithms::calcErrorRate(const Vertex* pX, const Vertex* pY, const Overlap& ovrXY)
 {
-    int num_diffs = ovrXY.match.countDifferences(pX->getSeq().toString(), pY->getSeq().toString());
+    int num_diffs = countMatchDifferences(pX->getSeq(), pY->getSeq(), ovrXY.match);
     return static_cast<double>(num_diffs) / static_cast<double>(ovrXY.match.getMinOverlapLength());
 }
 
@@ -12,8 +12,10 @@
 
 #include "Bigraph.h"
 #include "SGUtil.h"
+#include "HashMap.h"
 #include <queue>
 
+struct ExploreBuffers;
 
 namespace SGAlgorithms
 {
@@ -25,10 +27,12 @@ namespace SGAlgorithms
 typedef std::set<VertexID> VertexIDSet;
 typedef std::set<EdgeDesc> EdgeDescSet;
 typedef std::map<EdgeDesc, Overlap> EdgeDescOverlapMap;
+typedef HashSet<EdgeDesc, EdgeDescHasher> EdgeDescHashSet;
 
 // Remodel the graph by finding new edges for the given vertex to avoid
-// causing a disconnection when removing pDeleteEdge
-void remodelVertexForExcision(StringGraph* pGraph, Vertex* pVertex, Edge* pDeleteEdge);
+// causing a disconnection when removing pDeleteEdge. If pBuffers is not NULL
+// the exploration uses its storage and counts its cost there.
+void remodelVertexForExcision(StringGraph* pGraph, Vertex* pVertex, Edge* pDeleteEdge, ExploreBuffers* pBuffers = NULL);
 
 // Create the edges in pGraph described by the overlap
 // A pointer to the first edge of the edge/edge twin is returned or NULL
@@ -26,9 +26,11 @@ SGWalkBuilder::~SGWalkBuilder()
 }
 
 //
+// The walk is built in place at the end of the output vector
 void SGWalkBuilder::startNewWalk(Vertex* pStartVertex)
 {
-    m_pCurrWalk = new SGWalk(pStartVertex, m_bIndexWalk);
+    m_outWalks.push_back(SGWalk(pStartVertex, m_bIndexWalk));
+    m_pCurrWalk = &m_outWalks.back();
 }
 
 //
@@ -40,8 +42,6 @@ void SGWalkBuilder::addEdge(Edge* pEdge)
 //
 void SGWalkBuilder::finishCurrentWalk()
 {
-    m_outWalks.push_back(*m_pCurrWalk);
-    delete m_pCurrWalk;
     m_pCurrWalk = NULL;
 }
 
@@ -51,9 +51,10 @@ void SGWalkBuilder::finishCurrentWalk()
 // returned in outWalks even if the search is aborted.
 // Returns true if all the possible walks were found.
 bool SGSearch::findWalks(Vertex* pX, Vertex* pY, EdgeDir initialDir,
-                         int maxDistance, size_t maxNodes, bool exhaustive, SGWalkVector& outWalks)
+                         int maxDistance, size_t maxNodes, bool exhaustive, SGWalkVector& outWalks,
+                         SGSearchNodePool* pPool)
 {
-    SGSearchTree searchTree(pX, pY, initialDir, maxDistance, maxNodes);
+    SGSearchTree searchTree(pX, pY, initialDir, maxDistance, maxNodes, pPool);
 
     // Iteravively perform the BFS using the search tree.
     while(searchTree.stepOnce()) { }
@@ -83,9 +84,10 @@ void SGSearch::findVariantWalks(Vertex* pX,
                                 EdgeDir initialDir, 
                                 int maxDistance,
                                 size_t maxWalks, 
-                                SGWalkVector& outWalks)
+                                SGWalkVector& outWalks,
+                                SGSearchNodePool* pPool)
 {
-    findCollapsedWalks(pX, initialDir, maxDistance, 500, outWalks);
+    findCollapsedWalks(pX, initialDir, maxDistance, 500, outWalks, pPool);
 
     if(outWalks.size() <= 1 || outWalks.size() > maxWalks)
     {
@@ -175,9 +177,10 @@ bool SGSearch::checkEndpointsInSet(EdgePtrVec& epv, std::set<Vertex*>& vertexSet
 // If no such walk exists, an empty set is returned
 void SGSearch::findCollapsedWalks(Vertex* pX, EdgeDir initialDir, 
                                   int maxDistance, size_t maxNodes, 
-                                  SGWalkVector& outWalks)
+                                  SGWalkVector& outWalks,
+                                  SGSearchNodePool* pPool)
 {
-    SGSearchTree searchTree(pX, NULL, initialDir, maxDistance, maxNodes);
+    SGSearchTree searchTree(pX, NULL, initialDir, maxDistance, maxNodes, pPool);
 
     // Iteravively perform the BFS using the search tree. After each step
     // we check if the search has collapsed to a single vertex.
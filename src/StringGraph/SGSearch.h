@@ -28,6 +28,9 @@ struct SGDistanceFunction
 // 
 typedef GraphSearchTree<Vertex, Edge, SGDistanceFunction> SGSearchTree;
 
+// Node storage that can be shared by consecutive searches
+typedef SGSearchTree::NodePool SGSearchNodePool;
+
 //
 struct SGWalkBuilder
 {
@@ -50,6 +53,9 @@ struct SGWalkBuilder
 };
 
 // String Graph searching algorithms
+// The search functions optionally take a pool to store
+// the search tree in, which saves reallocating the tree
+// when many searches are performed.
 namespace SGSearch
 {
     //
@@ -59,17 +65,20 @@ namespace SGSearch
                    int maxDistance, 
                    size_t maxNodes, 
                    bool exhaustive,
-                   SGWalkVector& outWalks);
+                   SGWalkVector& outWalks,
+                   SGSearchNodePool* pPool = NULL);
 
     void findVariantWalks(Vertex* pX, 
                           EdgeDir initialDir, 
                           int maxDistance,
                           size_t maxWalks, 
-                          SGWalkVector& outWalks);
+                          SGWalkVector& outWalks,
+                          SGSearchNodePool* pPool = NULL);
 
     void findCollapsedWalks(Vertex* pX, EdgeDir initialDir, 
                             int maxDistance, size_t maxNodes,
-                            SGWalkVector& outWalks);
+                            SGWalkVector& outWalks,
+                            SGSearchNodePool* pPool = NULL);
 
     // Count the number of vertices that span the sequence junction
     // described by edge XY. Returns -1 if the search was not completed
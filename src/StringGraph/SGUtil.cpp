@@ -11,10 +11,12 @@
 #include "SeqReader.h"
 #include "SGAlgorithms.h"
 #include "SGVisitors.h"
+#include "Profiler.h"
 
 StringGraph* SGUtil::loadASQG(const std::string& filename, const unsigned int minOverlap, 
                               bool allowContainments, size_t maxEdges)
 {
+    PROFILE_FUNC("SGUtil::loadASQG")
     // Initialize graph
     StringGraph* pGraph = new StringGraph;
 
@@ -81,7 +83,7 @@ StringGraph* SGUtil::loadASQG(const std::string& filename, const unsigned int mi
                 ASQG::VertexRecord vertexRecord(recordLine);
                 const SQG::IntTag& ssTag = vertexRecord.getSubstringTag();
 
-                Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(vertexRecord.getID(), vertexRecord.getSeq());
+                Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(vertexRecord.getID(), vertexRecord.getSeq(), pGraph->getVertexAllocator());
                 if(ssTag.isInitialized() && ssTag.get() == 1)
                 {
                     // Vertex is a substring of some other vertex, mark it as contained
@@ -151,7 +153,7 @@ StringGraph* SGUtil::loadFASTA(const std::string& filename)
 
     while(reader.get(record))
     {
-        Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(record.id, record.seq.toString());
+        Vertex* pVertex = new(pGraph->getVertexAllocator()) Vertex(record.id, record.seq.toString(), pGraph->getVertexAllocator());
         pGraph->addVertex(pVertex);
     }
     return pGraph;
@@ -13,6 +13,10 @@
 #include "SGSearch.h"
 #include "stdaln.h"
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 //
 // SGFastaVisitor - output the vertices in the graph in 
 // fasta format
@@ -236,7 +240,8 @@ bool SGContainRemoveVisitor::visit(StringGraph* pGraph, Vertex* pVertex)
             Edge* pRemodelEdge = neighborEdges[j]->getTwin();
             SGAlgorithms::remodelVertexForExcision(pGraph, 
                                                    pRemodelVert, 
-                                                   pRemodelEdge);
+                                                   pRemodelEdge,
+                                                   &m_exploreBuffers);
         }
     }
             
@@ -269,7 +274,7 @@ bool SGValidateStructureVisitor::visit(StringGraph* pGraph, Vertex* pVertex)
     SGAlgorithms::EdgeDescOverlapMap transitiveMap;
     
     // Construct the set of overlaps reachable within the current parameters
-    CompleteOverlapSet vertexOverlapSet(pVertex, pGraph->getErrorRate(), pGraph->getMinOverlap());
+    CompleteOverlapSet vertexOverlapSet(pVertex, pGraph->getErrorRate(), pGraph->getMinOverlap(), &m_exploreBuffers);
     vertexOverlapSet.computeIrreducible(NULL, NULL);
 
     SGAlgorithms::EdgeDescOverlapMap missingMap;
@@ -529,16 +534,55 @@ void SGSmoothingVisitor::previsit(StringGraph* pGraph)
     pGraph->setColors(GC_WHITE);
     m_simpleBubblesRemoved = 0;
     m_complexBubblesRemoved = 0;
+
+    // Find the candidate bubbles from every branching vertex. The graph
+    // is not modified until all the candidates have been found so the
+    // searches can run in parallel.
+    m_vertices = pGraph->getAllVertices();
+    m_candidates.clear();
+    m_candidates.resize(m_vertices.size());
+    m_visitIdx = 0;
+
+#if HAVE_OPENMP
+    #pragma omp parallel num_threads(m_numThreads)
+#endif
+    {
+        // Reused by the searches made by this thread
+        SGSearchNodePool searchPool;
+
+#if HAVE_OPENMP
+        #pragma omp for schedule(dynamic, 64)
+#endif
+        for(int64_t i = 0; i < (int64_t)m_vertices.size(); ++i)
+        {
+            Vertex* pVertex = m_vertices[i];
+            for(size_t idx = 0; idx < ED_COUNT; idx++)
+            {
+                EdgeDir dir = EDGE_DIRECTIONS[idx];
+                if(pVertex->countEdges(dir) <= 1)
+                    continue;
+
+                SmoothingCandidate candidate;
+                if(findCandidate(pVertex, dir, &searchPool, candidate))
+                    m_candidates[i].push_back(candidate);
+            }
+        }
+    }
 }
 
-//
+// Remove the bubbles found from this vertex unless they
+// conflict with a bubble that has already been removed
 bool SGSmoothingVisitor::visit(StringGraph* pGraph, Vertex* pVertex)
 {
     (void)pGraph;
+    size_t vertexIdx = m_visitIdx++;
+    assert(vertexIdx < m_vertices.size() && m_vertices[vertexIdx] == pVertex);
     if(pVertex->getColor() == GC_RED)
         return false;
 
-    bool found = false;
+    const SmoothingCandidateVector& candidates = m_candidates[vertexIdx];
+    size_t candidateIdx = 0;
+    bool removed = false;
     for(size_t idx = 0; idx < ED_COUNT; idx++)
     {
         EdgeDir dir = EDGE_DIRECTIONS[idx];
@@ -549,236 +593,247 @@ bool SGSmoothingVisitor::visit(StringGraph* pGraph, Vertex* pVertex)
         for(size_t i = 0; i < edges.size(); ++i)
         {
             if(edges[i]->getEnd()->getColor() == GC_RED)
-                return false;
+                return removed;
         }
 
-        //std::cout << "Smoothing " << pVertex->getID() << "\n";
+        if(candidateIdx < candidates.size() && candidates[candidateIdx].dir == dir)
+        {
+            removeCandidate(candidates[candidateIdx++]);
+            removed = true;
+        }
+    }
+    return removed;
+}
 
-        const int MAX_WALKS = 10;
-        const int MAX_DISTANCE = 5000;
-        bool bIsDegenerate = false;
-        bool bFailGapCheck = false;
-        bool bFailDivergenceCheck = false;
-        bool bFailIndelSizeCheck = false;
+//
+bool SGSmoothingVisitor::findCandidate(Vertex* pVertex, EdgeDir dir, SGSearchNodePool* pPool, SmoothingCandidate& candidate) const
+{
+    const int MAX_WALKS = 10;
+    const int MAX_DISTANCE = 5000;
+    bool bIsDegenerate = false;
+    bool bFailGapCheck = false;
+    bool bFailDivergenceCheck = false;
+    bool bFailIndelSizeCheck = false;
 
-        SGWalkVector variantWalks;
-        SGSearch::findVariantWalks(pVertex, dir, MAX_DISTANCE, MAX_WALKS, variantWalks);
+    SGWalkVector& variantWalks = candidate.walks;
+    SGSearch::findVariantWalks(pVertex, dir, MAX_DISTANCE, MAX_WALKS, variantWalks, pPool);
+    if(variantWalks.empty())
+        return false;
 
-        if(variantWalks.size() > 0)
-        {
-            found = true;
-            size_t selectedIdx = -1;
-            size_t selectedCoverage = 0;
+    size_t selectedIdx = -1;
+    size_t selectedCoverage = 0;
 
-            // Calculate the minimum amount overlapped on the start/end vertex.
-            // This is used to properly extract the sequences from walks that represent the variation.
-            int minOverlapX = std::numeric_limits<int>::max();
-            int minOverlapY = std::numeric_limits<int>::max();
+    // Calculate the minimum amount overlapped on the start/end vertex.
+    // This is used to properly extract the sequences from walks that represent the variation.
+    int minOverlapX = std::numeric_limits<int>::max();
+    int minOverlapY = std::numeric_limits<int>::max();
 
-            for(size_t i = 0; i < variantWalks.size(); ++i)
-            {
-                if(variantWalks[i].getNumEdges() <= 1)
-                    bIsDegenerate = true;
+    for(size_t i = 0; i < variantWalks.size(); ++i)
+    {
+        if(variantWalks[i].getNumEdges() <= 1)
+            bIsDegenerate = true;
 
-                // Calculate the walk coverage using the internal vertices of the walk. 
-                // The walk with the highest coverage will be retained
-                size_t walkCoverage = 0;
-                for(size_t j = 1; j < variantWalks[i].getNumVertices() - 1; ++j)
-                    walkCoverage += variantWalks[i].getVertex(j)->getCoverage();
+        // Calculate the walk coverage using the internal vertices of the walk. 
+        // The walk with the highest coverage will be retained
+        size_t walkCoverage = 0;
+        for(size_t j = 1; j < variantWalks[i].getNumVertices() - 1; ++j)
+            walkCoverage += variantWalks[i].getVertex(j)->getCoverage();
 
-                if(walkCoverage > selectedCoverage || selectedCoverage == 0)
-                {
-                    selectedIdx = i;
-                    selectedCoverage = walkCoverage;
-                }
-                
-                Edge* pFirstEdge = variantWalks[i].getFirstEdge();
-                Edge* pLastEdge = variantWalks[i].getLastEdge();
+        if(walkCoverage > selectedCoverage || selectedCoverage == 0)
+        {
+            selectedIdx = i;
+            selectedCoverage = walkCoverage;
+        }
+        
+        Edge* pFirstEdge = variantWalks[i].getFirstEdge();
+        Edge* pLastEdge = variantWalks[i].getLastEdge();
 
-                if((int)pFirstEdge->getMatchLength() < minOverlapX)
-                    minOverlapX = pFirstEdge->getMatchLength();
+        if((int)pFirstEdge->getMatchLength() < minOverlapX)
+            minOverlapX = pFirstEdge->getMatchLength();
 
-                if((int)pLastEdge->getTwin()->getMatchLength() < minOverlapY)
-                    minOverlapY = pLastEdge->getTwin()->getMatchLength();
-            }
+        if((int)pLastEdge->getTwin()->getMatchLength() < minOverlapY)
+            minOverlapY = pLastEdge->getTwin()->getMatchLength();
+    }
 
-            // Calculate the strings for each walk that represent the region of variation
-            StringVector walkStrings;
-            for(size_t i = 0; i < variantWalks.size(); ++i)
-            {
-                Vertex* pStartVertex = variantWalks[i].getStartVertex();
-                Vertex* pLastVertex = variantWalks[i].getLastVertex();
-                assert(pStartVertex != NULL && pLastVertex != NULL);
-                
-                std::string full = variantWalks[i].getString(SGWT_START_TO_END);
-                int posStart = 0;
-                int posEnd = 0;
-
-                if(dir == ED_ANTISENSE)
-                {
-                    // pLast   -----------
-                    // pStart          ------------
-                    // full    --------------------
-                    // out             ----
-                    posStart = pLastVertex->getSeqLen() - minOverlapY;
-                    posEnd = full.size() - (pStartVertex->getSeqLen() - minOverlapX);
-                }
-                else
-                {
-                    // pStart         --------------
-                    // pLast   -----------
-                    // full    ---------------------
-                    // out            ----
-                    posStart = pStartVertex->getSeqLen() - minOverlapX; // match start position
-                    posEnd = full.size() - (pLastVertex->getSeqLen() - minOverlapY); // match end position
-                }
-                
-                std::string out;
-                if(posEnd > posStart)
-                    out = full.substr(posStart, posEnd - posStart);
-                walkStrings.push_back(out);
-            }
+    // Calculate the strings for each walk that represent the region of variation
+    StringVector walkStrings;
+    for(size_t i = 0; i < variantWalks.size(); ++i)
+    {
+        Vertex* pStartVertex = variantWalks[i].getStartVertex();
+        Vertex* pLastVertex = variantWalks[i].getLastVertex();
+        assert(pStartVertex != NULL && pLastVertex != NULL);
+        
+        std::string full = variantWalks[i].getString(SGWT_START_TO_END);
+        int posStart = 0;
+        int posEnd = 0;
 
-            assert(selectedIdx != (size_t)-1);
-            SGWalk& selectedWalk = variantWalks[selectedIdx];
-            assert(selectedWalk.isIndexed());
+        if(dir == ED_ANTISENSE)
+        {
+            // pLast   -----------
+            // pStart          ------------
+            // full    --------------------
+            // out             ----
+            posStart = pLastVertex->getSeqLen() - minOverlapY;
+            posEnd = full.size() - (pStartVertex->getSeqLen() - minOverlapX);
+        }
+        else
+        {
+            // pStart         --------------
+            // pLast   -----------
+            // full    ---------------------
+            // out            ----
+            posStart = pStartVertex->getSeqLen() - minOverlapX; // match start position
+            posEnd = full.size() - (pLastVertex->getSeqLen() - minOverlapY); // match end position
+        }
+        
+        std::string out;
+        if(posEnd > posStart)
+            out = full.substr(posStart, posEnd - posStart);
+        walkStrings.push_back(out);
+    }
 
-            // Check the divergence of the other walks to this walk
-            StringVector cigarStrings;
-            std::vector<int> maxIndel;
-            std::vector<double> gapPercent; // percentage of matching that is gaps
-            std::vector<double> totalPercent; // percent of total alignment that is mismatch or gap
+    assert(selectedIdx != (size_t)-1);
+    assert(variantWalks[selectedIdx].isIndexed());
 
-            cigarStrings.resize(variantWalks.size());
-            gapPercent.resize(variantWalks.size());
-            totalPercent.resize(variantWalks.size());
-            maxIndel.resize(variantWalks.size());
+    // Check the divergence of the other walks to this walk
+    candidate.cigarStrings.resize(variantWalks.size());
+    candidate.gapPercent.resize(variantWalks.size()); // percentage of matching that is gaps
+    candidate.totalPercent.resize(variantWalks.size()); // percent of total alignment that is mismatch or gap
+    candidate.maxIndel.resize(variantWalks.size());
 
-            for(size_t i = 0; i < variantWalks.size(); ++i)
+    for(size_t i = 0; i < variantWalks.size(); ++i)
+    {
+        if(i == selectedIdx)
+            continue;
+
+        // We want to compute the total gap length, total mismatches and percent
+        // divergence between the two paths.
+        int matchLen = 0;
+        int totalDiff = 0;
+        int gapLength = 0;
+        int maxGapLength = 0;
+        // We have to handle the degenerate case where one internal string has zero length
+        // this can happen when there is an isolated insertion/deletion and the walks are like:
+        // x -> y -> z
+        // x -> z
+        if(walkStrings[selectedIdx].empty() || walkStrings[i].empty())
+        {
+            matchLen = std::max(walkStrings[selectedIdx].size(), walkStrings[i].size());
+            totalDiff = matchLen;
+            gapLength = matchLen;
+        }
+        else
+        {
+            AlnAln *aln_global;
+            aln_global = aln_stdaln(walkStrings[selectedIdx].c_str(), walkStrings[i].c_str(), &aln_param_blast, 1, 1);
+
+            // Calculate the alignment parameters
+            while(aln_global->outm[matchLen] != '\0')
             {
-                if(i == selectedIdx)
-                    continue;
+                if(aln_global->outm[matchLen] == ' ')
+                    totalDiff += 1;
+                matchLen += 1;
+            }
 
-                // We want to compute the total gap length, total mismatches and percent
-                // divergence between the two paths.
-                int matchLen = 0;
-                int totalDiff = 0;
-                int gapLength = 0;
-                int maxGapLength = 0;
-                // We have to handle the degenerate case where one internal string has zero length
-                // this can happen when there is an isolated insertion/deletion and the walks are like:
-                // x -> y -> z
-                // x -> z
-                if(walkStrings[selectedIdx].empty() || walkStrings[i].empty())
+            std::stringstream cigarSS;
+            for (int j = 0; j != aln_global->n_cigar; ++j)
+            {
+                char cigarOp = "MID"[aln_global->cigar32[j]&0xf];
+                int cigarLen = aln_global->cigar32[j]>>4;
+                if(cigarOp == 'I' || cigarOp == 'D')
                 {
-                    matchLen = std::max(walkStrings[selectedIdx].size(), walkStrings[i].size());
-                    totalDiff = matchLen;
-                    gapLength = matchLen;
+                    gapLength += cigarLen;
+                    if(gapLength > maxGapLength)
+                        maxGapLength = gapLength;
                 }
-                else
-                {
-                    AlnAln *aln_global;
-                    aln_global = aln_stdaln(walkStrings[selectedIdx].c_str(), walkStrings[i].c_str(), &aln_param_blast, 1, 1);
 
-                    // Calculate the alignment parameters
-                    while(aln_global->outm[matchLen] != '\0')
-                    {
-                        if(aln_global->outm[matchLen] == ' ')
-                            totalDiff += 1;
-                        matchLen += 1;
-                    }
+                cigarSS << cigarLen;
+                cigarSS << cigarOp;
+            }
+            candidate.cigarStrings[i] = cigarSS.str();
+            aln_free_AlnAln(aln_global);
+        }
 
-                    std::stringstream cigarSS;
-                    for (int j = 0; j != aln_global->n_cigar; ++j)
-                    {
-                        char cigarOp = "MID"[aln_global->cigar32[j]&0xf];
-                        int cigarLen = aln_global->cigar32[j]>>4;
-                        if(cigarOp == 'I' || cigarOp == 'D')
-                        {
-                            gapLength += cigarLen;
-                            if(gapLength > maxGapLength)
-                                maxGapLength = gapLength;
-                        }
+        double percentDiff = (double)totalDiff / matchLen;
+        double percentGap = (double)gapLength / matchLen;
 
-                        cigarSS << cigarLen;
-                        cigarSS << cigarOp;
-                    }
-                    cigarStrings[i] = cigarSS.str();
-                    aln_free_AlnAln(aln_global);
-                }
+        if(percentDiff > m_maxTotalDivergence)
+            bFailDivergenceCheck = true;
+        
+        if(percentGap > m_maxGapDivergence)
+            bFailGapCheck = true;
 
-                double percentDiff = (double)totalDiff / matchLen;
-                double percentGap = (double)gapLength / matchLen;
+        if(maxGapLength > m_maxIndelLength)
+            bFailIndelSizeCheck = true;
 
-                if(percentDiff > m_maxTotalDivergence)
-                    bFailDivergenceCheck = true;
-                
-                if(percentGap > m_maxGapDivergence)
-                    bFailGapCheck = true;
+        candidate.gapPercent[i] = percentGap;
+        candidate.totalPercent[i] = percentDiff;
+        candidate.maxIndel[i] = maxGapLength;
+    }
 
-                if(maxGapLength > m_maxIndelLength)
-                    bFailIndelSizeCheck = true;
+    if(bIsDegenerate || bFailGapCheck || bFailDivergenceCheck || bFailIndelSizeCheck)
+        return false;
 
-                gapPercent[i] = percentGap;
-                totalPercent[i] = percentDiff;
-                maxIndel[i] = maxGapLength;
-            }
+    candidate.dir = dir;
+    candidate.selectedIdx = selectedIdx;
+    return true;
+}
 
-            if(bIsDegenerate || bFailGapCheck || bFailDivergenceCheck || bFailIndelSizeCheck)
-                continue;
+//
+void SGSmoothingVisitor::removeCandidate(const SmoothingCandidate& candidate)
+{
+    const SGWalkVector& variantWalks = candidate.walks;
+    const SGWalk& selectedWalk = variantWalks[candidate.selectedIdx];
 
-            // Write the selected path to the variants file as variant 0
-            int variantIdx = 0;
-            std::string selectedSequence = selectedWalk.getString(SGWT_START_TO_END);
-            std::stringstream ss;
-            ss << "variant-" << m_numRemovedTotal << "/" << variantIdx++;
-            writeFastaRecord(&m_outFile, ss.str(), selectedSequence);
+    // Write the selected path to the variants file as variant 0
+    int variantIdx = 0;
+    std::string selectedSequence = selectedWalk.getString(SGWT_START_TO_END);
+    std::stringstream ss;
+    ss << "variant-" << m_numRemovedTotal << "/" << variantIdx++;
+    writeFastaRecord(&m_outFile, ss.str(), selectedSequence);
 
+    // The vertex set for each walk is not necessarily disjoint,
+    // the selected walk may contain vertices that are part
+    // of other paths. We handle this be initially marking all
+    // vertices of the 
+    for(size_t i = 0; i < variantWalks.size(); ++i)
+    {
+        if(i == candidate.selectedIdx)
+            continue;
 
-            // The vertex set for each walk is not necessarily disjoint,
-            // the selected walk may contain vertices that are part
-            // of other paths. We handle this be initially marking all
-            // vertices of the 
-            for(size_t i = 0; i < variantWalks.size(); ++i)
+        const SGWalk& currWalk = variantWalks[i];
+        for(size_t j = 0; j < currWalk.getNumEdges() - 1; ++j)
+        {
+            Edge* currEdge = currWalk.getEdge(j);
+            
+            // If the vertex is also on the selected path, do not mark it
+            Vertex* currVertex = currEdge->getEnd();
+            if(!selectedWalk.containsVertex(currVertex->getID()))
             {
-                if(i == selectedIdx)
-                    continue;
-
-                SGWalk& currWalk = variantWalks[i];
-                for(size_t j = 0; j < currWalk.getNumEdges() - 1; ++j)
-                {
-                    Edge* currEdge = currWalk.getEdge(j);
-                    
-                    // If the vertex is also on the selected path, do not mark it
-                    Vertex* currVertex = currEdge->getEnd();
-                    if(!selectedWalk.containsVertex(currVertex->getID()))
-                    {
-                        currEdge->getEnd()->setColor(GC_RED);
-                    }
-                }
-
-                // Write the variant to a file
-                std::string variantSequence = currWalk.getString(SGWT_START_TO_END);
-                std::stringstream variantID;
-                std::stringstream ss;
-                ss << "variant-" << m_numRemovedTotal << "/" << variantIdx++;
-                ss << " IGD:" << (double)gapPercent[i] << " ITD:" << totalPercent[i] << " MID: " << maxIndel[i] << " InternalCigar:" << cigarStrings[i];
-                writeFastaRecord(&m_outFile, ss.str(), variantSequence);
+                currEdge->getEnd()->setColor(GC_RED);
             }
-
-            if(variantWalks.size() == 2)
-                m_simpleBubblesRemoved += 1;
-            else
-                m_complexBubblesRemoved += 1;
-            ++m_numRemovedTotal;
         }
+
+        // Write the variant to a file
+        std::string variantSequence = currWalk.getString(SGWT_START_TO_END);
+        std::stringstream ss;
+        ss << "variant-" << m_numRemovedTotal << "/" << variantIdx++;
+        ss << " IGD:" << (double)candidate.gapPercent[i] << " ITD:" << candidate.totalPercent[i] << " MID: " << candidate.maxIndel[i] << " InternalCigar:" << candidate.cigarStrings[i];
+        writeFastaRecord(&m_outFile, ss.str(), variantSequence);
     }
-    return found;
+
+    if(variantWalks.size() == 2)
+        m_simpleBubblesRemoved += 1;
+    else
+        m_complexBubblesRemoved += 1;
+    ++m_numRemovedTotal;
 }
 
 // Remove all the marked edges
 void SGSmoothingVisitor::postvisit(StringGraph* pGraph)
 {
+    m_vertices.clear();
+    m_candidates.clear();
     pGraph->sweepVertices(GC_RED);
     assert(pGraph->checkColors(GC_WHITE));
 
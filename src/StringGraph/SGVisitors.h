@@ -10,6 +10,8 @@
 //
 #include "SGAlgorithms.h"
 #include "SGUtil.h"
+#include "SGSearch.h"
+#include "CompleteOverlapSet.h"
 
 #ifndef SGVISITORS_H
 #define SGVISITORS_H
@@ -59,6 +61,11 @@ struct SGContainRemoveVisitor
     void previsit(StringGraph* pGraph);
     bool visit(StringGraph* pGraph, Vertex* pVertex);
     void postvisit(StringGraph* pGraph);
+
+    // The number of overlaps inferred while remodelling the graph, over all visits
+    size_t getCost() const { return m_exploreBuffers.cost; }
+
+    ExploreBuffers m_exploreBuffers;
 };
 
 // Validate that the graph does not contain
@@ -69,6 +76,11 @@ struct SGValidateStructureVisitor
     void previsit(StringGraph*) {}
     bool visit(StringGraph* pGraph, Vertex* pVertex);
     void postvisit(StringGraph*) {}
+
+    // The number of overlaps inferred while validating, over all visits
+    size_t getCost() const { return m_exploreBuffers.cost; }
+
+    ExploreBuffers m_exploreBuffers;
 };
 
 // Remodel the graph to infer missing edges or remove erroneous edges
@@ -131,22 +143,53 @@ struct SGSuperRepeatVisitor
     size_t m_num_superrepeats;
 };
 
+// A bubble found from a vertex that passes the divergence checks
+struct SmoothingCandidate
+{
+    EdgeDir dir;
+    SGWalkVector walks;
+    size_t selectedIdx;
+
+    // Alignment of each walk to the selected walk
+    StringVector cigarStrings;
+    std::vector<int> maxIndel;
+    std::vector<double> gapPercent;
+    std::vector<double> totalPercent;
+};
+typedef std::vector<SmoothingCandidate> SmoothingCandidateVector;
+
 // Smooth out variation in the graph
+// The bubbles are found and scored in parallel in previsit,
+// which does not modify the graph. The bubbles are then
+// removed in visit in the order the vertices are visited,
+// skipping those that conflict with a bubble that has already
+// been removed. This gives the same graph as finding the
+// bubbles one vertex at a time, for any number of threads.
 struct SGSmoothingVisitor
 {
     SGSmoothingVisitor(std::string filename, 
                        double maxGapDiv, 
                        double maxTotalDiv, 
-                       int maxIndelLength) : m_numRemovedTotal(0), 
+                       int maxIndelLength,
+                       int numThreads = 1) : m_numRemovedTotal(0), 
                                              m_maxGapDivergence(maxGapDiv),
                                              m_maxTotalDivergence(maxTotalDiv),
                                              m_maxIndelLength(maxIndelLength),
+                                             m_numThreads(numThreads),
                                              m_outFile(filename.c_str()) {}
 
     void previsit(StringGraph* pGraph);
     bool visit(StringGraph* pGraph, Vertex* pVertex);
     void postvisit(StringGraph*);
 
+    // Find the bubble starting from pVertex in direction dir. Returns false
+    // if there is no bubble or it fails the divergence checks.
+    bool findCandidate(Vertex* pVertex, EdgeDir dir, SGSearchNodePool* pPool, SmoothingCandidate& candidate) const;
+
+    // Write the walks of the candidate to the variants file and mark
+    // the vertices that are not on the selected walk for removal
+    void removeCandidate(const SmoothingCandidate& candidate);
+
     int m_simpleBubblesRemoved;
     int m_complexBubblesRemoved;
     int m_numRemovedTotal;
@@ -154,7 +197,13 @@ struct SGSmoothingVisitor
     double m_maxGapDivergence;
     double m_maxTotalDivergence;
     int m_maxIndelLength;
+    int m_numThreads;
     std::ofstream m_outFile;
+
+    // The vertices in visit order and the candidates found for each
+    VertexPtrVec m_vertices;
+    std::vector<SmoothingCandidateVector> m_candidates;
+    size_t m_visitIdx;
 };
 
 // Compile summary statistics for the graph
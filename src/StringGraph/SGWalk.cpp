@@ -74,9 +74,11 @@ SGWalk& SGWalk::operator=(const SGWalk& other)
     m_pStartVertex = other.m_pStartVertex;
     m_edges = other.m_edges;
     m_extensionDistance = other.m_extensionDistance;
+    m_extensionFinished = other.m_extensionFinished;
     
     if(m_pWalkIndex != NULL)
         delete m_pWalkIndex;
+    m_pWalkIndex = NULL;
     
     if(other.m_pWalkIndex != NULL)
         m_pWalkIndex = new WalkIndex(*other.m_pWalkIndex);
@@ -161,11 +163,23 @@ void SGWalk::truncate(const VertexID& id)
 std::string SGWalk::getString(SGWalkType type, SGWalkVertexPlacementVector* pPlacementVector) const
 {
     std::string out;
+    getString(type, out, pPlacementVector);
+    return out;
+}
+
+//
+void SGWalk::getString(SGWalkType type, std::string& out, SGWalkVertexPlacementVector* pPlacementVector) const
+{
+    PieceVector pieces;
+    pieces.reserve(m_edges.size() + 1);
+    int length = 0;
 
     // Append the full length of the starting vertex to the walk
     if(type == SGWT_START_TO_END || type == SGWT_INTERNAL)
     {
-        out.append(m_pStartVertex->getSeq().toString());
+        Piece first = { m_pStartVertex, 0, (int)m_pStartVertex->getSeqLen(), false };
+        pieces.push_back(first);
+        length += first.length;
 
         // Add the first record to the placement vector if required
         if(pPlacementVector != NULL)
@@ -178,36 +192,15 @@ std::string SGWalk::getString(SGWalkType type, SGWalkVertexPlacementVector* pPla
         }
     }
 
-    // Determine if the string should go to the end of the last vertex
-    // in the path
-    size_t stop = m_edges.size();
-
     // The first edge is always in correct frame of reference 
     // so the comp is EC_SAME. This variable tracks where the 
     // string that is being added is different from the starting sequence
     // and needs to be flipped
     EdgeComp currComp = EC_SAME;
 
-    // If the walk direction is antisense, we reverse every component and then
-    // reverse the entire string to generate the final string
-    bool reverseAll = !m_edges.empty() && m_edges[0]->getDir() == ED_ANTISENSE;
-    if(reverseAll)
-        out = reverse(out);
-    
-    for(size_t i = 0; i < stop; ++i)
+    for(size_t i = 0; i < m_edges.size(); ++i)
     {
         Edge* pYZ = m_edges[i];
-        // Append in the extension string
-        std::string edge_str = pYZ->getLabel();
-        assert(edge_str.size() != 0);
-
-        // Determine whether this node is reverse complement wrt the string
-        // we are building
-        if(currComp == EC_REVERSE)
-            edge_str = reverseComplement(edge_str);
-
-        if(reverseAll)
-            edge_str = reverse(edge_str);
 
         // Calculate the next comp, between X and Z
         EdgeComp ecYZ = pYZ->getComp();
@@ -217,7 +210,14 @@ std::string SGWalk::getString(SGWalkType type, SGWalkVertexPlacementVector* pPla
         else
             ecXZ = !currComp;
 
-        out.append(edge_str);
+        // The extension is the part of Z that is not matched by Y. It is
+        // reverse complemented if Z is reverse complement wrt the string
+        // we are building
+        SeqCoord unmatched = pYZ->getTwin()->getMatchCoord().complement();
+        assert(!unmatched.isEmpty());
+        Piece piece = { pYZ->getEnd(), unmatched.interval.start, unmatched.length(), ecXZ == EC_REVERSE };
+        pieces.push_back(piece);
+        length += piece.length;
         
         // Add this record into the placement vector
         if(pPlacementVector != NULL)
@@ -225,15 +225,19 @@ std::string SGWalk::getString(SGWalkType type, SGWalkVertexPlacementVector* pPla
             SGWalkVertexPlacement placement;
             placement.pVertex = pYZ->getEnd();
             placement.isRC = ecXZ == EC_REVERSE;
-            placement.position = out.size() - pYZ->getEnd()->getSeqLen();
+            placement.position = length - pYZ->getEnd()->getSeqLen();
             pPlacementVector->push_back(placement);
         }
 
         currComp = ecXZ;
     }
 
+    // If the walk direction is antisense the pieces are written in reverse order
+    bool reverseAll = !m_edges.empty() && m_edges[0]->getDir() == ED_ANTISENSE;
+    writePieces(pieces, reverseAll, out);
+
     // If we want the internal portion of the string (which does not contain the endpoints
-    // perform the truncation now. This needs to be done before the reversal.
+    // perform the truncation now. The coordinates are on the unreversed string.
     if(type == SGWT_INTERNAL)
     {
         if(pPlacementVector != NULL)
@@ -256,11 +260,19 @@ std::string SGWalk::getString(SGWalkType type, SGWalkVertexPlacementVector* pPla
             int end = out.size() - (pLast->getSeqLen() - pLastEdge->getMatchLength());
 
             if(end <= start)
+            {
                 out.clear();
+            }
+            else if(reverseAll)
+            {
+                int total = out.size();
+                out.erase(total - start);
+                out.erase(0, total - end);
+            }
             else
             {
-                std::string ss = out.substr(start, end - start);
-                out = ss;
+                out.erase(end);
+                out.erase(0, start);
             }
         }
     }
@@ -268,23 +280,47 @@ std::string SGWalk::getString(SGWalkType type, SGWalkVertexPlacementVector* pPla
     if(out.empty())
         std::cout << "No output for walk: " << pathSignature() << "\n";
 
-    if(reverseAll)
+    // Reverse the placement vector too, including flipping the alignment coordinates
+    if(reverseAll && pPlacementVector != NULL)
     {
-        out = reverse(out);
-
-        // Reverse the placement vector too, including flipping the alignment coordinates
-        if(pPlacementVector != NULL)
+        std::reverse(pPlacementVector->begin(), pPlacementVector->end());
+        for(size_t i = 0; i < pPlacementVector->size(); ++i)
         {
-            std::reverse(pPlacementVector->begin(), pPlacementVector->end());
-            for(size_t i = 0; i < pPlacementVector->size(); ++i)
-            {
-                SGWalkVertexPlacement& item = pPlacementVector->at(i);
-                item.position = out.size() - item.position - item.pVertex->getSeqLen();
-            }
+            SGWalkVertexPlacement& item = pPlacementVector->at(i);
+            item.position = out.size() - item.position - item.pVertex->getSeqLen();
         }
     }
+}
 
-    return out;
+// Decode each piece directly from the vertex into the output buffer.
+// Reversing the whole string reverses the order of the pieces
+// but not their sequence, so each piece is written to the
+// mirrored position of the buffer.
+void SGWalk::writePieces(const PieceVector& pieces, bool reverseAll, std::string& out)
+{
+    size_t total = 0;
+    for(size_t i = 0; i < pieces.size(); ++i)
+        total += pieces[i].length;
+    out.resize(total);
+
+    size_t pos = 0; // position on the unreversed string
+    for(size_t i = 0; i < pieces.size(); ++i)
+    {
+        const Piece& piece = pieces[i];
+        if(piece.length == 0)
+            continue;
+
+        const DNAEncodedString& seq = piece.pVertex->getSeq();
+        char* pOut = &out[reverseAll ? total - pos - piece.length : pos];
+        for(int j = 0; j < piece.length; ++j)
+        {
+            char b = seq.get(piece.start + j);
+            if(piece.isRC)
+                b = complement(b);
+            pOut[piece.isRC ? piece.length - j - 1 : j] = b;
+        }
+        pos += piece.length;
+    }
 }
 
 // Returns a vector of EdgeComps of the orientation of each
@@ -321,7 +357,37 @@ std::string SGWalk::getFragmentString(const Vertex* pX, const Vertex* pY,
                                       EdgeDir dirX, EdgeDir dirY) const
 {
     std::string out;
+    PieceVector pieces;
+    if(!getFragmentPieces(pX, pY, fromX, toY, dirX, dirY, pieces))
+        return out;
+
+    // If the walk direction is antisense the pieces are written in reverse order
+    bool reverseAll = !m_edges.empty() && m_edges[0]->getDir() == ED_ANTISENSE;
+    writePieces(pieces, reverseAll, out);
+    return out;
+}
+
+//
+int SGWalk::getFragmentLength(const Vertex* pX, const Vertex* pY,
+                              int fromX, int toY, 
+                              EdgeDir dirX, EdgeDir dirY) const
+{
+    PieceVector pieces;
+    if(!getFragmentPieces(pX, pY, fromX, toY, dirX, dirY, pieces))
+        return 0;
 
+    int length = 0;
+    for(size_t i = 0; i < pieces.size(); ++i)
+        length += pieces[i].length;
+    return length;
+}
+
+//
+bool SGWalk::getFragmentPieces(const Vertex* pX, const Vertex* pY,
+                               int fromX, int toY, 
+                               EdgeDir dirX, EdgeDir dirY,
+                               PieceVector& pieces) const
+{
     // Calculate the portion of X that we should include in the string
     // If dirX is SENSE, we take the everything after position fromX
     // otherwise we take everything up to and including fromX
@@ -352,14 +418,11 @@ std::string SGWalk::getFragmentString(const Vertex* pX, const Vertex* pY,
     }
 
     if(!xCoord.isValid())
-        return "";
+        return false;
 
     //
-    out.append(m_pStartVertex->getSeq().substr(xCoord.interval.start, xCoord.length()));
-
-    // Determine if the string should go to the end of the last vertex
-    // in the path
-    size_t stop = m_edges.size();
+    Piece first = { m_pStartVertex, xCoord.interval.start, xCoord.length(), false };
+    pieces.push_back(first);
 
     // The first edge is always in correct frame of reference 
     // so the comp is EC_SAME. This variable tracks where the 
@@ -367,37 +430,33 @@ std::string SGWalk::getFragmentString(const Vertex* pX, const Vertex* pY,
     // and needs to be flipped
     EdgeComp currComp = EC_SAME;
 
-    // If the walk direction is antisense, we reverse every component and then
-    // reverse the entire string to generate the final string
-    bool reverseAll = !m_edges.empty() && m_edges[0]->getDir() == ED_ANTISENSE;
-    if(reverseAll)
-        out = reverse(out);
-
+    size_t stop = m_edges.size();
     for(size_t i = 0; i < stop; ++i)
     {
         Edge* pYZ = m_edges[i];
         bool isLast = i == (stop - 1);
 
+        // Calculate the next comp, between X and Z
+        EdgeComp ecYZ = pYZ->getComp();
+        EdgeComp ecXZ;
+        if(ecYZ == EC_SAME)
+            ecXZ = currComp;
+        else
+            ecXZ = !currComp;
+
+        // get the unmatched coordinates on the end vertex
+        const Edge* pZY = pYZ->getTwin();
+        SeqCoord unmatched = pZY->getMatchCoord().complement();
+
         if(!isLast)
         {
             // Append the extension string without modification
-            std::string edge_str = pYZ->getLabel();
-            assert(edge_str.size() != 0);
-            if(currComp == EC_REVERSE)
-                edge_str = reverseComplement(edge_str);
-
-            if(reverseAll)
-                edge_str = reverse(edge_str);
-            out.append(edge_str);
+            assert(!unmatched.isEmpty());
+            Piece piece = { pYZ->getEnd(), unmatched.interval.start, unmatched.length(), ecXZ == EC_REVERSE };
+            pieces.push_back(piece);
         }
         else
         {
-            // 
-            const Edge* pZY = pYZ->getTwin();
-            
-            // get the unmatched coordinates on pY
-            SeqCoord unmatched = pZY->getMatchCoord().complement();
-
             // Now, we have to shrink the unmatched interval on Y to
             // only incude up to toY
             if(dirY == ED_SENSE)
@@ -406,31 +465,15 @@ std::string SGWalk::getFragmentString(const Vertex* pX, const Vertex* pY,
                 unmatched.interval.end = toY;
 
             if(!unmatched.isValid())
-                return "";
-
-            std::string seq = unmatched.getSubstring(pY->getStr());
-            if(pYZ->getComp() != currComp)
-                seq = reverseComplement(seq);
-            
-            if(reverseAll)
-                seq = reverse(seq);
-            out.append(seq);
-        }
+                return false;
 
-        // Calculate the next comp, between X and Z
-        EdgeComp ecYZ = pYZ->getComp();
-        EdgeComp ecXZ;
-        if(ecYZ == EC_SAME)
-            ecXZ = currComp;
-        else
-            ecXZ = !currComp;
+            Piece piece = { pY, unmatched.interval.start, unmatched.length(), ecXZ == EC_REVERSE };
+            pieces.push_back(piece);
+        }
 
         currComp = ecXZ;
     }
-
-    if(reverseAll)
-        out = reverse(out);
-    return out;
+    return true;
 }
 
 //
@@ -76,6 +76,10 @@ class SGWalk
         // (see the enum description). If the pointer to the VertexPlacementVector is not NULL,
         // the position of the vertices within the walk are written there.
         std::string getString(SGWalkType type, SGWalkVertexPlacementVector* pPlacementVector = NULL) const;
+
+        // As above but the string is written into out, reusing its storage.
+        // The sequence is decoded directly from the vertices into the buffer.
+        void getString(SGWalkType type, std::string& out, SGWalkVertexPlacementVector* pPlacementVector = NULL) const;
         
         // Get the substring of the full path string starting from position fromX
         // to position toY on the first and last vertices, respectively
@@ -83,6 +87,11 @@ class SGWalk
                                       int fromX, int toY, 
                                       EdgeDir dirX, EdgeDir dirY) const;
 
+        // Return the length of the string getFragmentString would return, without building it
+        int getFragmentLength(const Vertex* pX, const Vertex* pY,
+                              int fromX, int toY, 
+                              EdgeDir dirX, EdgeDir dirY) const;
+
         // Return a string identifying the path through the graph this walk represents
         std::string pathSignature() const;
 
@@ -100,6 +109,28 @@ class SGWalk
         void printSimple() const;
 
     private:
+
+        // A substring of a vertex sequence that is part of the walk string.
+        // If isRC is set the substring is reverse complemented.
+        struct Piece
+        {
+            const Vertex* pVertex;
+            int start;
+            int length;
+            bool isRC;
+        };
+        typedef std::vector<Piece> PieceVector;
+
+        // Add the pieces of the fragment string to pieces. Returns false
+        // if the coordinates do not describe a valid fragment.
+        bool getFragmentPieces(const Vertex* pX, const Vertex* pY,
+                               int fromX, int toY, 
+                               EdgeDir dirX, EdgeDir dirY,
+                               PieceVector& pieces) const;
+
+        // Write the concatenation of the pieces into out. If reverseAll
+        // is set the pieces are written in reverse order.
+        static void writePieces(const PieceVector& pieces, bool reverseAll, std::string& out);
         
         Vertex* m_pStartVertex;
         EdgePtrVec m_edges;
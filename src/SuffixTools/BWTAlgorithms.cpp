@@ -7,6 +7,8 @@
 // bwt_algorithms.cpp - Algorithms for aligning to a bwt structure
 //
 #include "BWTAlgorithms.h"
+#include "Profiler.h"
+#include "DBGNavigator.h"
 
 // Find the interval in pBWT corresponding to w
 // If w does not exist in the BWT, the interval 
@@ -64,6 +66,7 @@ BWTInterval BWTAlgorithms::findIntervalWithCache(const BWT* pBWT, const BWTInter
 // Delegate the findInterval call based on what indices are loaded
 BWTInterval BWTAlgorithms::findInterval(const BWTIndexSet& indices, const std::string& w)
 {
+    PROFILE_COUNT("BWTAlgorithms::findInterval", 1);
     if(indices.pCache != NULL)
         return findIntervalWithCache(indices.pBWT, indices.pCache, w);
     else
@@ -221,64 +224,9 @@ AlphaCount64 BWTAlgorithms::calculateDeBruijnExtensions(const std::string str,
                                                         const BWTIntervalCache* pFwdCache,
                                                         const BWTIntervalCache* pRevCache)
 {
-    size_t k = str.size();
-    size_t p = k - 1;
-    
-    std::string pmer;
-
-    // In the sense direction, we extend from the 3' end
-    if(direction == ED_SENSE)
-        pmer = str.substr(1, p);
-    else
-        pmer = str.substr(0, p);
-    assert(pmer.length() == p);
-    std::string rc_pmer = reverseComplement(pmer);
-
-    // Get the interval for the p-mer and its reverse complement
-    BWTIntervalPair ip;
-    BWTIntervalPair rc_ip;
-
-    // If pointers to interval caches are available, use them
-    // to speed up the initial calculation
-    if(pFwdCache != NULL && pRevCache != NULL)
-    {
-        ip = BWTAlgorithms::findIntervalPairWithCache(pBWT, pRevBWT, pFwdCache, pRevCache, pmer);
-        rc_ip = BWTAlgorithms::findIntervalPairWithCache(pBWT, pRevBWT, pFwdCache, pRevCache, rc_pmer);
-    }
-    else
-    {
-        ip = BWTAlgorithms::findIntervalPair(pBWT, pRevBWT, pmer);
-        rc_ip = BWTAlgorithms::findIntervalPair(pBWT, pRevBWT, rc_pmer);
-    }
-
-    assert(ip.isValid() || rc_ip.isValid());
-
-    // Get the extension bases
-    AlphaCount64 extensions;
-    AlphaCount64 rc_extensions;
-
-    // Calculate the interval to use to find the extensions. If extending in the sense
-    // direction this is the reverse interval/reverse bwt for the forward bwt and the forward
-    // interval for the reverse BWT. Vice-versa for anti-sense
-    size_t fwdIdx;
-    if(direction == ED_SENSE)
-        fwdIdx = 1;
-    else
-        fwdIdx = 0;
-    size_t revIdx = 1 - fwdIdx;
-    const BWT* bwts[2];
-    bwts[0] = pBWT;
-    bwts[1] = pRevBWT;
-
-    if(ip.interval[fwdIdx].isValid())
-        extensions += BWTAlgorithms::getExtCount(ip.interval[fwdIdx], bwts[fwdIdx]);
-    if(rc_ip.interval[revIdx].isValid())
-        rc_extensions = BWTAlgorithms::getExtCount(rc_ip.interval[revIdx], bwts[revIdx]);
-
-    // Switch the reverse-complement extensions to the same strand as the str
-    rc_extensions.complement();
-    extensions += rc_extensions;
-    return extensions;
+    assert(pRevBWT != NULL);
+    DBGNavigator navigator(pBWT, pRevBWT, pFwdCache, pRevCache);
+    return navigator.getExtensions(str, direction);
 }
 
 //
@@ -287,92 +235,8 @@ AlphaCount64 BWTAlgorithms::calculateDeBruijnExtensionsSingleIndex(const std::st
                                                                    EdgeDir direction,
                                                                    const BWTIntervalCache* pFwdCache)
 {
-    size_t k = str.size();
-    size_t p = k - 1;
-    
-    std::string pmer;
-
-    // In the sense direction, we extend from the 3' end
-    if(direction == ED_SENSE)
-        pmer = str.substr(1, p);
-    else
-        pmer = str.substr(0, p);
-    assert(pmer.length() == p);
-    std::string rc_pmer = reverseComplement(pmer);
-
-    // As we only have a single index, we can only directly look up
-    // the extensions for either the pmer or its reverse complement
-    // In the SENSE extension direction, we directly look up for
-    // the reverse complement. In ANTISENSE we directly look up for
-    // the pmer.
-    
-    // Get the extension bases
-    AlphaCount64 extensions;
-    AlphaCount64 rc_extensions;
-
-    // Set up pointers to the data to fill in/query
-    // depending on the direction of the extension
-    AlphaCount64* pDirectEC;
-    AlphaCount64* pIndirectEC;
-    std::string* pDirectStr;
-    std::string* pIndirectStr;
-    if(direction == ED_SENSE)
-    {
-        pDirectEC = &rc_extensions;
-        pDirectStr = &rc_pmer;
-
-        pIndirectEC = &extensions;
-        pIndirectStr = &pmer;
-    }
-    else
-    {
-        pDirectEC = &extensions;
-        pDirectStr = &pmer;
-
-        pIndirectEC = &rc_extensions;
-        pIndirectStr = &rc_pmer;
-    }
-
-    // Get the interval for the direct query string
-    BWTInterval interval;
-
-    // Use interval cache if available
-    if(pFwdCache)
-        interval = BWTAlgorithms::findIntervalWithCache(pBWT, pFwdCache, *pDirectStr);
-    else
-        interval = BWTAlgorithms::findInterval(pBWT, *pDirectStr);
-
-    // Fill in the direct count
-    if(interval.isValid())
-        *pDirectEC = BWTAlgorithms::getExtCount(interval, pBWT);
-
-    // Now, for the non-direct index, query the 4 possible k-mers that are adjacent to the pmer
-    // Setup the query sequence
-    std::string query(k, 'A');
-    int varIdx = query.size() - 1;
-    query.replace(0, p, *pIndirectStr);
-
-    for(int i = 0; i < BWT_ALPHABET::size; ++i)
-    {
-        // Transform the query
-        char b = BWT_ALPHABET::getChar(i);
-        query[varIdx] = b;
-
-        // Perform lookup
-        if(pFwdCache)
-            interval = BWTAlgorithms::findIntervalWithCache(pBWT, pFwdCache, query);
-        else
-            interval = BWTAlgorithms::findInterval(pBWT, query);
-        
-        // Update the extension count
-        if(interval.isValid())
-            pIndirectEC->add(b, interval.size());
-    }
-
-    // Switch the reverse-complement extensions to the same strand as the str
-    rc_extensions.complement();
-    extensions += rc_extensions;
-    return extensions;
+    DBGNavigator navigator(pBWT, NULL, pFwdCache);
+    return navigator.getExtensions(str, direction);
 }
 
 // Return a random string from the BWT
@@ -404,6 +268,7 @@ std::string BWTAlgorithms::sampleRandomSubstring(const BWT* pBWT, size_t len)
 // Return the string from the BWT at idx
 std::string BWTAlgorithms::extractString(const BWT* pBWT, size_t idx)
 {
+    PROFILE_FUNC("BWTAlgorithms::extractString")
     assert(idx < pBWT->getNumStrings());
 
     // The range [0,n) in the BWT contains all the terminal
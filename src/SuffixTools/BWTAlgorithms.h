@@ -150,6 +150,7 @@ AlphaCount64 calculateExactExtensions(const unsigned int overlapLen, const std::
 
 // Calculate de Bruijn graph extensions of the given sequence using an index pair
 // Returns an AlphaCount64 with the count of each extension base
+// Code that walks the graph should use a DBGNavigator, which remembers the nodes it visits.
 // This function optionally takes in an interval cache to speed up the computation
 AlphaCount64 calculateDeBruijnExtensions(const std::string str, 
                                          const BWT* pBWT, 
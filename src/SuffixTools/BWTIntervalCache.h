@@ -12,6 +12,7 @@
 
 #include "BWT.h"
 #include "BWTInterval.h"
+#include "MemoryPolicy.h"
 
 class BWTIntervalCache
 {
@@ -52,7 +53,7 @@ class BWTIntervalCache
         std::string int2string(size_t i) const;
 
         size_t m_kmer;
-        std::vector<BWTInterval> m_table;
+        std::vector<BWTInterval, MemoryPolicy::IndexAllocator<BWTInterval> > m_table;
 };
 
 #endif
@@ -0,0 +1,176 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// DBGNavigator - Walk the implicit de Bruijn graph
+// of an FM-index.
+//
+#include "DBGNavigator.h"
+#include <cstring>
+
+//
+DBGNavigator::DBGNavigator(const BWT* pBWT,
+                           const BWT* pRevBWT,
+                           const BWTIntervalCache* pFwdCache,
+                           const BWTIntervalCache* pRevCache) : m_pBWT(pBWT),
+                                                                m_pRevBWT(pRevBWT),
+                                                                m_pFwdCache(pFwdCache),
+                                                                m_pRevCache(pRevCache)
+{
+    assert(m_pBWT != NULL);
+}
+
+//
+AlphaCount64 DBGNavigator::getExtensions(const std::string& kmer, EdgeDir direction)
+{
+    assert(kmer.size() >= 2);
+    size_t p = kmer.size() - 1;
+
+    // In the sense direction, we extend from the 3' end
+    if(direction == ED_SENSE)
+        return getNodeExtensions(kmer.substr(1, p), direction);
+    else
+        return getNodeExtensions(kmer.substr(0, p), direction);
+}
+
+//
+AlphaCount64 DBGNavigator::getNodeExtensions(const std::string& pmer, EdgeDir direction)
+{
+    // Strings that cannot be encoded are not memoized
+    if(!encodeKey(pmer, m_key))
+    {
+        Node tmp;
+        return calculateExtensions(tmp, pmer, direction);
+    }
+
+    Node& node = m_nodes[m_key];
+    if(!node.hasExtensions[direction])
+    {
+        node.extensions[direction] = calculateExtensions(node, pmer, direction);
+        node.hasExtensions[direction] = true;
+    }
+    return node.extensions[direction];
+}
+
+//
+void DBGNavigator::clear()
+{
+    m_nodes.clear();
+}
+
+// The key is the length of the string followed by
+// the bases packed 4 to a byte
+bool DBGNavigator::encodeKey(const std::string& pmer, std::string& key)
+{
+    size_t n = pmer.size();
+    key.assign(sizeof(uint32_t) + (n + 3) / 4, 0);
+
+    uint32_t len = n;
+    memcpy(&key[0], &len, sizeof(len));
+    for(size_t i = 0; i < n; ++i)
+    {
+        uint8_t code;
+        switch(pmer[i])
+        {
+            case 'A': code = 0; break;
+            case 'C': code = 1; break;
+            case 'G': code = 2; break;
+            case 'T': code = 3; break;
+            default: return false;
+        }
+        key[sizeof(uint32_t) + i / 4] |= code << 2 * (i % 4);
+    }
+    return true;
+}
+
+// Calculate the interval pairs of the (k-1)-mer and its reverse complement.
+// This is only used when both indices are available.
+void DBGNavigator::calculateIntervals(Node& node, const std::string& pmer, const std::string& rc_pmer) const
+{
+    assert(m_pRevBWT != NULL);
+    if(m_pFwdCache != NULL && m_pRevCache != NULL)
+    {
+        node.ip = BWTAlgorithms::findIntervalPairWithCache(m_pBWT, m_pRevBWT, m_pFwdCache, m_pRevCache, pmer);
+        node.rc_ip = BWTAlgorithms::findIntervalPairWithCache(m_pBWT, m_pRevBWT, m_pFwdCache, m_pRevCache, rc_pmer);
+    }
+    else
+    {
+        node.ip = BWTAlgorithms::findIntervalPair(m_pBWT, m_pRevBWT, pmer);
+        node.rc_ip = BWTAlgorithms::findIntervalPair(m_pBWT, m_pRevBWT, rc_pmer);
+    }
+    node.hasIntervals = true;
+}
+
+//
+AlphaCount64 DBGNavigator::calculateExtensions(Node& node, const std::string& pmer, EdgeDir direction) const
+{
+    std::string rc_pmer = reverseComplement(pmer);
+
+    AlphaCount64 extensions;
+    AlphaCount64 rc_extensions;
+
+    if(m_pRevBWT != NULL)
+    {
+        // The interval pairs are shared by both directions
+        if(!node.hasIntervals)
+            calculateIntervals(node, pmer, rc_pmer);
+        assert(node.ip.isValid() || node.rc_ip.isValid());
+
+        // If extending in the sense direction the extensions of the (k-1)-mer are
+        // found in the reverse index and those of its reverse complement in the
+        // forward index. Vice-versa for anti-sense.
+        size_t fwdIdx = direction == ED_SENSE ? RIGHT_INT_IDX : LEFT_INT_IDX;
+        size_t revIdx = 1 - fwdIdx;
+        const BWT* bwts[2];
+        bwts[LEFT_INT_IDX] = m_pBWT;
+        bwts[RIGHT_INT_IDX] = m_pRevBWT;
+
+        if(node.ip.interval[fwdIdx].isValid())
+            extensions = BWTAlgorithms::getExtCount(node.ip.interval[fwdIdx], bwts[fwdIdx]);
+        if(node.rc_ip.interval[revIdx].isValid())
+            rc_extensions = BWTAlgorithms::getExtCount(node.rc_ip.interval[revIdx], bwts[revIdx]);
+    }
+    else
+    {
+        // With a single index the extensions of only one of the strings can be
+        // looked up directly: the reverse complement when extending in the sense
+        // direction and the (k-1)-mer in the antisense direction. The other strand
+        // is counted by querying the four adjacent k-mers.
+        AlphaCount64* pDirectEC = direction == ED_SENSE ? &rc_extensions : &extensions;
+        AlphaCount64* pIndirectEC = direction == ED_SENSE ? &extensions : &rc_extensions;
+        const std::string& directStr = direction == ED_SENSE ? rc_pmer : pmer;
+        const std::string& indirectStr = direction == ED_SENSE ? pmer : rc_pmer;
+
+        BWTInterval interval = findInterval(directStr);
+        if(interval.isValid())
+            *pDirectEC = BWTAlgorithms::getExtCount(interval, m_pBWT);
+
+        std::string query(indirectStr);
+        query.push_back('A');
+        size_t varIdx = query.size() - 1;
+        for(int i = 0; i < BWT_ALPHABET::size; ++i)
+        {
+            char b = BWT_ALPHABET::getChar(i);
+            query[varIdx] = b;
+            interval = findInterval(query);
+            if(interval.isValid())
+                pIndirectEC->add(b, interval.size());
+        }
+    }
+
+    // Switch the reverse-complement extensions to the same strand as the (k-1)-mer
+    rc_extensions.complement();
+    extensions += rc_extensions;
+    return extensions;
+}
+
+//
+BWTInterval DBGNavigator::findInterval(const std::string& w) const
+{
+    if(m_pFwdCache != NULL)
+        return BWTAlgorithms::findIntervalWithCache(m_pBWT, m_pFwdCache, w);
+    else
+        return BWTAlgorithms::findInterval(m_pBWT, w);
+}
@@ -0,0 +1,95 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// DBGNavigator - Walk the implicit de Bruijn graph
+// of an FM-index.
+//
+// A node of the graph is a (k-1)-mer. The edges of a
+// k-mer in the sense direction are the out-edges of its
+// last k-1 bases and the edges in the antisense direction
+// are the in-edges of its first k-1 bases, so the
+// successor of a k-mer and the predecessor of the next
+// k-mer share a node. The navigator memoizes the nodes it
+// visits, keyed by their 2-bit encoding, along with the
+// intervals of the (k-1)-mer and its reverse complement.
+// Once a node is known its extensions in either direction
+// cost a single occurrence lookup when the reverse index
+// is available and four k-mer lookups when it is not.
+//
+// A navigator is intended to be used for a single search
+// and is not thread safe.
+//
+#ifndef DBGNAVIGATOR_H
+#define DBGNAVIGATOR_H
+
+#include "BWTAlgorithms.h"
+#include "HashMap.h"
+
+class DBGNavigator
+{
+    public:
+
+        // If pRevBWT is NULL the extensions are calculated
+        // with the single index algorithm
+        DBGNavigator(const BWT* pBWT,
+                     const BWT* pRevBWT = NULL,
+                     const BWTIntervalCache* pFwdCache = NULL,
+                     const BWTIntervalCache* pRevCache = NULL);
+
+        // Return the counts of the bases that extend the k-mer in the given direction,
+        // including the reverse complement strand. The result is the same as
+        // BWTAlgorithms::calculateDeBruijnExtensions(SingleIndex)
+        AlphaCount64 getExtensions(const std::string& kmer, EdgeDir direction);
+
+        // Return the counts of the bases that extend the (k-1)-mer node in the given direction
+        AlphaCount64 getNodeExtensions(const std::string& pmer, EdgeDir direction);
+
+        // Discard the memoized nodes
+        void clear();
+
+        // The number of nodes that have been memoized
+        size_t getNumNodes() const { return m_nodes.size(); }
+
+    private:
+
+        struct Node
+        {
+            Node() : hasIntervals(false) { hasExtensions[0] = hasExtensions[1] = false; }
+
+            // The intervals of the (k-1)-mer and its reverse complement.
+            // With a single index only the LEFT_INT_IDX intervals are set.
+            BWTIntervalPair ip;
+            BWTIntervalPair rc_ip;
+            bool hasIntervals;
+
+            // Extension counts, indexed by EdgeDir
+            AlphaCount64 extensions[2];
+            bool hasExtensions[2];
+        };
+
+        typedef HashMap<std::string, Node, StringHasher> NodeMap;
+
+        // Encode the (k-1)-mer into key using 2 bits per base.
+        // Returns false if the string contains a non-DNA symbol.
+        static bool encodeKey(const std::string& pmer, std::string& key);
+
+        //
+        void calculateIntervals(Node& node, const std::string& pmer, const std::string& rc_pmer) const;
+        AlphaCount64 calculateExtensions(Node& node, const std::string& pmer, EdgeDir direction) const;
+
+        // Find the interval of w in the forward index
+        BWTInterval findInterval(const std::string& w) const;
+
+        const BWT* m_pBWT;
+        const BWT* m_pRevBWT;
+        const BWTIntervalCache* m_pFwdCache;
+        const BWTIntervalCache* m_pRevCache;
+
+        NodeMap m_nodes;
+        std::string m_key;
+};
+
+#endif
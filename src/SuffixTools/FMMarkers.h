@@ -10,11 +10,22 @@
 #ifndef FMMARKERS_H
 #define FMMARKERS_H
 
+#include <string.h>
+#include "Alphabet.h"
+#include "MemoryPolicy.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FMMARKERS_USE_SSE2 1
+#endif
+
 // LargeMarker - To allow random access to the 
 // BWT symbols and implement the occurrence array
 // we keep a vector of symbol counts every D1 symbols.
 // These counts are the absolute number of times each
 // symbol has been seen up to that point.
+// The markers are stored as PackedLargeMarkers, this
+// is the unpacked form that the queries work with.
 // 
 struct LargeMarker
 {
@@ -59,38 +70,139 @@ struct LargeMarker
     // a valid index if there is a marker after the last symbol in the BWT
     size_t unitIndex;
 };
-typedef std::vector<LargeMarker> LargeMarkerVector;
 
 // SmallMarker - Small markers contain the counts
 // within an individual block of the BWT. In other words
 // the small marker contains the count for the last D2 symbols
+// The counts and the unit count are stored in one array
+// so they can be loaded together when interpolating.
 // 
 struct SmallMarker
 {
-    SmallMarker() : unitCount(0) {}
+    SmallMarker() { memset(values, 0, sizeof(values)); }
+
+    //
+    inline void set(const AlphaCount16& counts, uint16_t unitCount)
+    {
+        for(int i = 0; i < ALPHABET_SIZE; ++i)
+            values[i] = counts.getByIdx(i);
+        values[ALPHABET_SIZE] = unitCount;
+    }
+
+    inline uint16_t getCountByIdx(int i) const { return values[i]; }
+    inline uint16_t getUnitCount() const { return values[ALPHABET_SIZE]; }
 
     // Calculate the actual position in the uncompressed BWT of this marker
     // This is the number of symbols preceding this marker
     inline size_t getCountSum() const
     {
-        return counts.getSum();
+        size_t sum = 0;
+        for(int i = 0; i < ALPHABET_SIZE; ++i)
+            sum += values[i];
+        return sum;
     }
 
     void print() const
     {
         for(int i = 0; i < ALPHABET_SIZE; ++i)
         {
-            std::cout << (int)counts.getByIdx(i) << " ";
+            std::cout << (int)values[i] << " ";
         }
         std::cout << "\n";
     }
 
-    // The number of times each symbol has been seen up to this marker
-    AlphaCount16 counts; 
+    // The number of times each symbol has been seen up to this marker,
+    // followed by the number of RL units in this block
+    uint16_t values[ALPHABET_SIZE + 1];
+};
+typedef std::vector<SmallMarker, MemoryPolicy::IndexAllocator<SmallMarker> > SmallMarkerVector;
+
+// PackedLargeMarker - The stored form of a LargeMarker.
+// Each count, and the unit index, is split into its low 32 bits
+// and a high byte so the marker takes 32 bytes instead of 48.
+// This limits the BWT to 2^40 symbols. The split layout lets
+// the low words and high bytes be recombined and added to a
+// SmallMarker with a few SSE2 instructions.
+// 
+struct PackedLargeMarker
+{
+    // The largest count or unit index that can be stored
+    static const uint64_t MAX_VALUE = ((uint64_t)1 << 40) - 1;
+
+    PackedLargeMarker() { memset(this, 0, sizeof(*this)); }
+
+    //
+    inline void set(const LargeMarker& marker)
+    {
+        for(int i = 0; i < ALPHABET_SIZE; ++i)
+            setValue(i, marker.counts.getByIdx(i));
+        setValue(ALPHABET_SIZE, marker.unitIndex);
+    }
+
+    //
+    inline LargeMarker get() const
+    {
+        LargeMarker marker;
+        for(int i = 0; i < ALPHABET_SIZE; ++i)
+            marker.counts.setByIdx(i, getValue(i));
+        marker.unitIndex = getValue(ALPHABET_SIZE);
+        return marker;
+    }
+
+    // Return the marker with the relative counts of the small marker added
+    inline LargeMarker interpolate(const SmallMarker& relative) const
+    {
+        uint64_t sum[ALPHABET_SIZE + 1];
+#if FMMARKERS_USE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+
+        // Rebuild the 64 bit values by interleaving the low words with the high bytes
+        __m128i low0123 = _mm_loadu_si128((const __m128i*)lowWords);
+        __m128i low45 = _mm_loadl_epi64((const __m128i*)(lowWords + 4));
+        __m128i high16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)highBytes), zero);
+        __m128i high0123 = _mm_unpacklo_epi16(high16, zero);
+        __m128i high45 = _mm_unpackhi_epi16(high16, zero);
+
+        // Widen the 16 bit relative values
+        uint32_t last;
+        memcpy(&last, relative.values + 4, sizeof(last));
+        __m128i rel0123 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)relative.values), zero);
+        __m128i rel45 = _mm_unpacklo_epi16(_mm_cvtsi32_si128(last), zero);
+
+        __m128i sum01 = _mm_add_epi64(_mm_unpacklo_epi32(low0123, high0123), _mm_unpacklo_epi32(rel0123, zero));
+        __m128i sum23 = _mm_add_epi64(_mm_unpackhi_epi32(low0123, high0123), _mm_unpackhi_epi32(rel0123, zero));
+        __m128i sum45 = _mm_add_epi64(_mm_unpacklo_epi32(low45, high45), _mm_unpacklo_epi32(rel45, zero));
+        _mm_storeu_si128((__m128i*)sum, sum01);
+        _mm_storeu_si128((__m128i*)(sum + 2), sum23);
+        _mm_storeu_si128((__m128i*)(sum + 4), sum45);
+#else
+        for(int i = 0; i <= ALPHABET_SIZE; ++i)
+            sum[i] = getValue(i) + relative.values[i];
+#endif
+        LargeMarker marker;
+        for(int i = 0; i < ALPHABET_SIZE; ++i)
+            marker.counts.setByIdx(i, sum[i]);
+        marker.unitIndex = sum[ALPHABET_SIZE];
+        return marker;
+    }
+
+    inline uint64_t getValue(int i) const
+    {
+        return lowWords[i] | ((uint64_t)highBytes[i] << 32);
+    }
+
+    inline void setValue(int i, uint64_t v)
+    {
+        assert(v <= MAX_VALUE);
+        lowWords[i] = (uint32_t)v;
+        highBytes[i] = (uint8_t)(v >> 32);
+    }
 
-    // The number of RL units in this block
-    uint16_t unitCount;
+    // The counts are at indices [0, ALPHABET_SIZE), the unit index follows them
+    uint32_t lowWords[ALPHABET_SIZE + 1];
+    uint8_t highBytes[ALPHABET_SIZE + 1];
+    uint8_t padding[2];
 };
-typedef std::vector<SmallMarker> SmallMarkerVector;
+typedef std::vector<PackedLargeMarker, MemoryPolicy::IndexAllocator<PackedLargeMarker> > LargeMarkerVector;
 
 #endif
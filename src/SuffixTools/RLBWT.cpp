@@ -9,6 +9,7 @@
 #include "RLBWT.h"
 #include "Timer.h"
 #include "BWTReader.h"
+#include "Profiler.h"
 #include "BWTWriter.h"
 #include "BWTReader.h"
 #include <istream>
@@ -25,12 +26,19 @@ RLBWT::RLBWT(const std::string& filename, int sampleRate) : m_numStrings(0),
                                                             m_largeSampleRate(DEFAULT_SAMPLE_RATE_LARGE),
                                                             m_smallSampleRate(sampleRate)
 {
+    PROFILE_FUNC("RLBWT::load")
     IBWTReader* pReader = BWTReader::createReader(filename);
     pReader->read(this);
     initializeFMIndex();
     delete pReader;
 }
 
+//
+RLBWT::~RLBWT()
+{
+    profileMemory(-1);
+}
+
 // Construct the BWT from a suffix array
 RLBWT::RLBWT(const SuffixArray* pSA, const ReadTable* pRT)
 {
@@ -121,14 +129,22 @@ void RLBWT::initializeFMIndex()
     m_largeMarkers.resize(num_large_markers);
     m_smallMarkers.resize(num_small_markers);
 
+    // The large markers store the counts and unit indices in 40 bits
+    if(m_numSymbols > PackedLargeMarker::MAX_VALUE)
+    {
+        std::cerr << "Error: the BWT contains " << m_numSymbols << " symbols, the FM-index supports at most " 
+                  << PackedLargeMarker::MAX_VALUE << "\n";
+        exit(EXIT_FAILURE);
+    }
+
     // Fill in the marker values
     // We wish to place markers every sampleRate symbols however since a run may
     // not end exactly on sampleRate boundaries, we place the markers AFTER
     // the run crossing the boundary ends
 
     // Place a blank markers at the start of the data
-    m_largeMarkers[0].unitIndex = 0;
-    m_smallMarkers[0].unitCount = 0;
+    m_largeMarkers[0].set(LargeMarker());
+    m_smallMarkers[0].set(AlphaCount16(), 0);
 
     // State variables for the number of markers placed,
     // the next marker to place, etc
@@ -169,9 +185,10 @@ void RLBWT::initializeFMIndex()
             assert(curr_large_marker_index < num_large_markers);
             assert(running_ac.getSum() == running_total);
 
-            LargeMarker& marker = m_largeMarkers[curr_large_marker_index];
+            LargeMarker marker;
             marker.unitIndex = i + 1;
             marker.counts = running_ac;
+            m_largeMarkers[curr_large_marker_index].set(marker);
 
             next_large_marker += m_largeSampleRate;
             curr_large_marker_index += 1;
@@ -207,7 +224,7 @@ void RLBWT::initializeFMIndex()
             // be the second-previous in the case that we placed the last large marker.
             size_t large_marker_index = expected_marker_pos >> m_largeShiftValue;
             assert(large_marker_index < curr_large_marker_index); // ensure the last has ben placed
-            LargeMarker& prev_large_marker = m_largeMarkers[large_marker_index];
+            LargeMarker prev_large_marker = m_largeMarkers[large_marker_index].get();
 
             // Set the 8bit AlphaCounts as the sum since the last large (superblock) marker
             AlphaCount16 smallAC;
@@ -224,9 +241,7 @@ void RLBWT::initializeFMIndex()
             }
             
             // Set the small marker
-            SmallMarker& small_marker = m_smallMarkers[curr_small_marker_index];
-            small_marker.unitCount = curr_unit_index - prev_large_marker.unitIndex;
-            small_marker.counts = smallAC;
+            m_smallMarkers[curr_small_marker_index].set(smallAC, curr_unit_index - prev_large_marker.unitIndex);
 
             // Update state variables
             next_small_marker += m_smallSampleRate;
@@ -245,6 +260,15 @@ void RLBWT::initializeFMIndex()
     m_predCount.set('C', m_predCount.get('A') + running_ac.get('A'));
     m_predCount.set('G', m_predCount.get('C') + running_ac.get('C'));
     m_predCount.set('T', m_predCount.get('G') + running_ac.get('G'));
+    profileMemory(1);
+}
+
+//
+void RLBWT::profileMemory(int sign) const
+{
+    PROFILE_MEMORY("RLBWT::runs", sign * (int64_t)(m_rlString.capacity() * sizeof(RLUnit)));
+    PROFILE_MEMORY("RLBWT::markers", sign * (int64_t)(m_smallMarkers.capacity() * sizeof(SmallMarker) + 
+                                                      m_largeMarkers.capacity() * sizeof(PackedLargeMarker)));
 }
 
 // get the number of markers required to cover the n symbols at sample rate of d
@@ -278,7 +302,7 @@ void RLBWT::print() const
 void RLBWT::printInfo() const
 {
     size_t small_m_size = m_smallMarkers.capacity() * sizeof(SmallMarker);
-    size_t large_m_size = m_largeMarkers.capacity() * sizeof(LargeMarker);
+    size_t large_m_size = m_largeMarkers.capacity() * sizeof(PackedLargeMarker);
     size_t total_marker_size = small_m_size + large_m_size;
 
     size_t bwStr_size = m_rlString.capacity() * sizeof(RLUnit);
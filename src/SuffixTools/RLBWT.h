@@ -32,6 +32,7 @@ class RLBWT
         // Constructors
         RLBWT(const std::string& filename, int sampleRate = DEFAULT_SAMPLE_RATE_SMALL);
         RLBWT(const SuffixArray* pSA, const ReadTable* pRT);
+        ~RLBWT();
 
         //    
         void initializeFMIndex();
@@ -108,11 +109,7 @@ class RLBWT
             size_t target_position = target_small_idx << m_smallShiftValue;
             size_t curr_large_idx = target_position >> m_largeShiftValue;
 
-            LargeMarker absoluteMarker = m_largeMarkers[curr_large_idx];
-            const SmallMarker& relative = m_smallMarkers[target_small_idx];
-            alphacount_add16(absoluteMarker.counts, relative.counts);
-            absoluteMarker.unitIndex += relative.unitCount;
-            return absoluteMarker;
+            return m_largeMarkers[curr_large_idx].interpolate(m_smallMarkers[target_small_idx]);
         }
 
         inline BaseCount getPC(char b) const { return m_predCount.get(b); }
@@ -273,6 +270,10 @@ class RLBWT
         // Calculate the number of markers to place
         size_t getNumRequiredMarkers(size_t n, size_t d) const;
 
+        // Add (sign = 1) or remove (sign = -1) the memory used by this
+        // BWT from the totals tracked by the Profiler
+        void profileMemory(int sign) const;
+
         // The C(a) array
         AlphaCount64 m_predCount;
         
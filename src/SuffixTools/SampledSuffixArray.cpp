@@ -12,6 +12,7 @@
 #include "SampledSuffixArray.h"
 #include "SAReader.h"
 #include "SAWriter.h"
+#include "Profiler.h"
 #include "config.h"
 
 #if HAVE_OPENMP
@@ -33,6 +34,7 @@ SampledSuffixArray::SampledSuffixArray()
 
 SampledSuffixArray::SampledSuffixArray(const std::string& filename, SSAFileType filetype)
 {
+    PROFILE_FUNC("SampledSuffixArray::load")
     // Read the sampled suffix array from a file - either from a .ssa or .sai file
     if(filetype == SSA_FT_SSA)
         readSSA(filename);
@@ -40,6 +42,19 @@ SampledSuffixArray::SampledSuffixArray(const std::string& filename, SSAFileType
         readSAI(filename);
 }
 
+//
+SampledSuffixArray::~SampledSuffixArray()
+{
+    profileMemory(-1);
+}
+
+//
+void SampledSuffixArray::profileMemory(int sign) const
+{
+    PROFILE_MEMORY("SampledSuffixArray", sign * (int64_t)(m_saLexoIndex.capacity() * sizeof(SSA_INT_TYPE) + 
+                                                          m_saSamples.capacity() * sizeof(SAElem)));
+}
+
 // 
 SAElem SampledSuffixArray::calcSA(int64_t idx, const BWT* pBWT) const
 {
@@ -76,6 +91,7 @@ SAElem SampledSuffixArray::calcSA(int64_t idx, const BWT* pBWT) const
         }
     }
 
+    PROFILE_HISTOGRAM("SampledSuffixArray::calcSABacktrackSteps", offset);
     elem.setPos(elem.getPos() + offset);
     return elem;
 }
@@ -89,6 +105,7 @@ size_t SampledSuffixArray::lookupLexoRank(size_t r) const
 // 
 void SampledSuffixArray::build(const BWT* pBWT, const ReadInfoTable* pRIT, int sampleRate)
 {
+    profileMemory(-1);
     m_sampleRate = sampleRate;
 
     size_t numStrings = pRIT->getCount();
@@ -152,11 +169,13 @@ void SampledSuffixArray::build(const BWT* pBWT, const ReadInfoTable* pRIT, int s
             }
         }
     }
+    profileMemory(1);
 }
 
 // A streamlined version of the above function
 void SampledSuffixArray::buildLexicoIndex(const BWT* pBWT, int num_threads)
 {
+    profileMemory(-1);
     int64_t numStrings = pBWT->getNumStrings();
     m_saLexoIndex.resize(numStrings);
     int64_t MAX_ELEMS = std::numeric_limits<SSA_INT_TYPE>::max();
@@ -187,6 +206,7 @@ void SampledSuffixArray::buildLexicoIndex(const BWT* pBWT, int num_threads)
             }
         }
     }
+    profileMemory(1);
 }
 
 // Validate the sampled suffix array values are correct
@@ -260,6 +280,7 @@ void SampledSuffixArray::writeLexicoIndex(const std::string& filename)
 
 void SampledSuffixArray::readSSA(std::string filename)
 {
+    profileMemory(-1);
     std::istream* pReader = createReader(filename, std::ios::binary);
     
     // Write a magic number
@@ -287,10 +308,12 @@ void SampledSuffixArray::readSSA(std::string filename)
     SSA_READ_N(m_saSamples.front(), sizeof(SAElem) * n)
 
     delete pReader;
+    profileMemory(1);
 }
 
 void SampledSuffixArray::readSAI(std::string filename)
 {
+    profileMemory(-1);
     SAReader reader(filename);
     size_t num_strings, num_elems;
     reader.readHeader(num_strings, num_elems);
@@ -300,6 +323,7 @@ void SampledSuffixArray::readSAI(std::string filename)
 
     // Set the sample rate to zero to signify there are no samples
     m_sampleRate = 0;
+    profileMemory(1);
 }
 
 // Print memory usage information
@@ -15,8 +15,10 @@
 #include "SuffixArray.h"
 #include "BWT.h"
 #include "ReadInfoTable.h"
+#include "MemoryPolicy.h"
 
 typedef uint32_t SSA_INT_TYPE;
+typedef std::vector<SAElem, MemoryPolicy::IndexAllocator<SAElem> > SSASampleVector;
 
 enum SSAFileType
 {
@@ -30,6 +32,7 @@ class SampledSuffixArray
 
         SampledSuffixArray();
         SampledSuffixArray(const std::string& filename, SSAFileType filetype = SSA_FT_SSA);
+        ~SampledSuffixArray();
         
         // Calculate the suffix array element for the given index
         SAElem calcSA(int64_t idx, const BWT* pBWT) const;
@@ -55,6 +58,10 @@ class SampledSuffixArray
 
     private:
 
+        // Add (sign = 1) or remove (sign = -1) the memory used by this
+        // suffix array from the totals tracked by the Profiler
+        void profileMemory(int sign) const;
+
         // Unsigned integers indicating the start of every read in the
         // sequence collection. These elements are in lexicographic order
         // based on the whole read sequence. Tracing a read backwards through
@@ -68,7 +75,7 @@ class SampledSuffixArray
 
         static const int DEFAULT_SA_SAMPLE_RATE = 64;
         int m_sampleRate;
-        SAElemVector m_saSamples;
+        SSASampleVector m_saSamples;
 };
 
 #endif
@@ -48,12 +48,17 @@ void SuffixCompareRadix::initializeNumSuffixLUT()
 
 // Get the bucket for a particular SAElem
 int SuffixCompareRadix::getBucket(SAElem x) const
+{
+    return getBucket(x, m_bucketOffset / m_bucketLen);
+}
+
+// Get the bucket for a particular SAElem at a given depth
+int SuffixCompareRadix::getBucket(SAElem x, int level) const
 {
     //std::cout << "Finding bucket for " << x << "\n";
     const DNAString& read = m_pRT->getRead(x.getID()).seq;
 
-    size_t suffix_start = x.getPos() + m_bucketOffset;
-    const char* suffix = read.getSuffix(suffix_start);
+    size_t suffix_start = x.getPos() + level * m_bucketLen;
     size_t suffix_len = read.getSuffixLength(suffix_start);
 
     size_t stop = std::min(m_bucketLen, suffix_len);
@@ -61,7 +66,7 @@ int SuffixCompareRadix::getBucket(SAElem x) const
     int rank = 0;
     for(size_t i = 0; i < stop; ++i)
     {
-        char b = suffix[i];
+        char b = read.get(suffix_start + i);
         rank += numPredSuffixes(b, m_bucketLen - i);
     }
 
@@ -26,12 +26,35 @@ class SuffixCompareRadix
         // Bucket function
         int getBucket(SAElem x) const;
 
+        // Get the bucket of the symbols starting at level * getBucketLen().
+        // Unlike setBucketDepth this does not modify the object so it 
+        // can be used by multiple threads at once.
+        int getBucket(SAElem x, int level) const;
+
         // Get the character at position d for the SAElem
         inline char getChar(SAElem& x, int d) const
         {
             return m_pRT->getChar(x.getID(), x.getPos() + d);
         }
 
+        // Compare the suffixes of x and y starting d symbols in.
+        // Returns a negative value, zero or a positive value if the
+        // suffix of x is less than, equal to or greater than that of y
+        inline int compareSuffixes(SAElem& x, SAElem& y, int d) const
+        {
+            const DNAString& sx = m_pRT->getRead(x.getID()).seq;
+            const DNAString& sy = m_pRT->getRead(y.getID()).seq;
+            size_t i = x.getPos() + d;
+            size_t j = y.getPos() + d;
+            char cx, cy;
+            while((cx = sx.get(i)) == (cy = sy.get(j)) && cx != 0)
+            {
+                ++i;
+                ++j;
+            }
+            return cx - cy;
+        }
+
         // Calculate the number of possible suffixes
         int calcNumSuffixes(int maxLen) const;
 
@@ -41,12 +64,6 @@ class SuffixCompareRadix
             return m_pNumSuffixLUT[maxLen];
         }
 
-        // Get the suffix character string corresponding to this element
-        inline const char* getChrPtr(SAElem& x) const
-        {
-            return m_pRT->getRead(x.getID()).seq.getSuffix(x.getPos());
-        }
-
         // Calculate the number of suffixes that precede the first instance of b for a 
         // given maximum suffix length
         inline int numPredSuffixes(char b, int maxLen) const
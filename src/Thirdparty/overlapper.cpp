@@ -32,6 +32,12 @@
 #include <limits>
 #include <stdio.h>
 #include <inttypes.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define OVERLAPPER_USE_SSE2 1
+#endif
 
 // 
 OverlapperParams default_params = { 2, -6, -3, -2, ALT_OVERLAP };
@@ -402,39 +408,23 @@ inline int _getBandedCellScore(const DPCells& cells, int i, int j, int band_widt
     return (band_row_index >= 0 && band_row_index < band_width) ? cells[i * band_width + band_row_index] : invalid_score;
 }
 
-SequenceOverlap Overlapper::extendMatch(const std::string& s1, const std::string& s2, 
-                                        int start_1, int start_2, int band_width)
+// Scoring scheme used by extendMatch
+static const int EXTEND_MATCH_SCORE = 2;
+static const int EXTEND_GAP_PENALTY = -5;
+static const int EXTEND_MISMATCH_PENALTY = -3;
+
+// Fill in the banded scoring matrix for extendMatch one cell at a time.
+// The cells must be zero-initialized
+static void _fillBandedCellsScalar(const std::string& s1, const std::string& s2,
+                                   int band_width, int band_origin, DPCells& cells)
 {
-    SequenceOverlap output;
     int num_columns = s1.size() + 1;
     int num_rows = s2.size() + 1;
 
-    const int MATCH_SCORE = 2;
-    const int GAP_PENALTY = -5;
-    const int MISMATCH_PENALTY = -3;
-    
-    // Calculate the number of cells off the diagonal to compute
-    int half_width = band_width / 2;
-    band_width = half_width * 2 + 1; // the total number of cells per band
-
-    // Calculate the number of columns that we need to extend to for s1
-    size_t num_cells_required = num_columns * band_width;
-
-    // Allocate bands with uninitialized scores
+    const int MATCH_SCORE = EXTEND_MATCH_SCORE;
+    const int GAP_PENALTY = EXTEND_GAP_PENALTY;
+    const int MISMATCH_PENALTY = EXTEND_MISMATCH_PENALTY;
     int INVALID_SCORE = std::numeric_limits<int>::min();
-    DPCells cells(num_cells_required, 0);
-
-    // Calculate the band center coordinates in the first
-    // column of the multiple alignment. These are calculated by
-    // projecting the match diagonal onto the first column. It is possible
-    // that these are negative.
-    int band_center = start_2 - start_1 + 1;
-    int band_origin = band_center - (half_width + 1);
-#ifdef DEBUG_EXTEND
-    printf("Match start: [%d %d]\n", start_1, start_2);
-    printf("Band center, origin: [%d %d]\n", band_center, band_origin);
-    printf("Num cells: %zu\n", cells.size());
-#endif
 
     // Fill in the bands column by column
     for(int i = 1; i < num_columns; ++i) {
@@ -520,6 +510,160 @@ SequenceOverlap Overlapper::extendMatch(const std::string& s1, const std::string
 #endif        
         }
     }
+}
+
+#if OVERLAPPER_USE_SSE2
+// Fill in the banded scoring matrix for extendMatch eight cells at a time using 
+// saturating 16-bit scores. Each band is first scored from the previous column
+// (diagonal and left moves) in parallel. The dependency on the cell above
+// is then resolved with a prefix-maximum scan over the band, which is exact for
+// a linear gap penalty. Cells that are not computed keep a score of zero, 
+// exactly as in _fillBandedCellsScalar, so the backtrack is unchanged.
+// Returns false without touching the cells if the scores could
+// overflow 16 bits, in which case the scalar version must be used.
+static bool _fillBandedCellsSSE2(const std::string& s1, const std::string& s2,
+                                 int band_width, int band_origin, DPCells& cells)
+{
+    int num_columns = s1.size() + 1;
+    int num_rows = s2.size() + 1;
+
+    // The scores in column i are bounded by i times the largest score change 
+    // of a single step, check this cannot exceed the range of the lanes
+    int max_step = std::max(EXTEND_MATCH_SCORE, -std::min(EXTEND_GAP_PENALTY, EXTEND_MISMATCH_PENALTY));
+    if((int64_t)(num_columns + 16) * max_step >= std::numeric_limits<int16_t>::max())
+        return false;
+
+    const int LANES = 8;
+    const int16_t NEG_SCORE = std::numeric_limits<int16_t>::min();
+
+    // Band buffers for the previous and current column. Padded so that full vectors 
+    // can be read and written past the end of the band.
+    int padded_width = band_width + 2 * LANES;
+    std::vector<int16_t> band_buffer(2 * padded_width, 0);
+    int16_t* prev = &band_buffer[0];
+    int16_t* curr = &band_buffer[padded_width];
+
+    // Pad s2 so that a full vector of bases can be read at the end of the band
+    std::string padded_s2 = s2;
+    padded_s2.append(LANES, '\0');
+
+    const __m128i v_match = _mm_set1_epi16(EXTEND_MATCH_SCORE);
+    const __m128i v_mismatch = _mm_set1_epi16(EXTEND_MISMATCH_PENALTY);
+    const __m128i v_gap1 = _mm_set1_epi16(EXTEND_GAP_PENALTY);
+    const __m128i v_gap2 = _mm_set1_epi16(2 * EXTEND_GAP_PENALTY);
+    const __m128i v_gap4 = _mm_set1_epi16(4 * EXTEND_GAP_PENALTY);
+    const __m128i v_gap_ramp = _mm_setr_epi16(1 * EXTEND_GAP_PENALTY, 2 * EXTEND_GAP_PENALTY, 
+                                              3 * EXTEND_GAP_PENALTY, 4 * EXTEND_GAP_PENALTY,
+                                              5 * EXTEND_GAP_PENALTY, 6 * EXTEND_GAP_PENALTY, 
+                                              7 * EXTEND_GAP_PENALTY, 8 * EXTEND_GAP_PENALTY);
+
+    // Masks setting the lanes shifted in by the scan to the minimum score
+    const __m128i v_neg_shift1 = _mm_setr_epi16(NEG_SCORE, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i v_neg_shift2 = _mm_setr_epi16(NEG_SCORE, NEG_SCORE, 0, 0, 0, 0, 0, 0);
+    const __m128i v_neg_shift4 = _mm_setr_epi16(NEG_SCORE, NEG_SCORE, NEG_SCORE, NEG_SCORE, 0, 0, 0, 0);
+
+    for(int i = 1; i < num_columns; ++i) {
+        memset(curr, 0, padded_width * sizeof(int16_t));
+
+        int band_start = band_origin + i;
+        int j = band_start; // start row of this band
+        int end_row = j + band_width;
+
+        // Trim band coordinates to only compute valid positions
+        if(j < 1)
+            j = 1;
+        if(end_row > num_rows)
+            end_row = num_rows;
+
+        if(end_row > 0 && j < num_rows && j < end_row) {
+            int first_idx = j - band_start;
+            int last_idx = end_row - band_start - 1;
+            const __m128i v_base = _mm_set1_epi8(s1[i - 1]);
+
+            // Score the diagonal and left moves
+            for(int r = first_idx; r <= last_idx; r += LANES) {
+                __m128i v_s2 = _mm_loadl_epi64((const __m128i*)(padded_s2.data() + band_start + r - 1));
+                __m128i v_eq = _mm_cmpeq_epi8(v_s2, v_base);
+                v_eq = _mm_unpacklo_epi8(v_eq, v_eq);
+                __m128i v_sub = _mm_or_si128(_mm_and_si128(v_eq, v_match), _mm_andnot_si128(v_eq, v_mismatch));
+
+                __m128i v_diag = _mm_adds_epi16(_mm_loadu_si128((const __m128i*)(prev + r)), v_sub);
+                __m128i v_left = _mm_adds_epi16(_mm_loadu_si128((const __m128i*)(prev + r + 1)), v_gap1);
+                _mm_storeu_si128((__m128i*)(curr + r), _mm_max_epi16(v_diag, v_left));
+            }
+
+            // The last row of the band cannot use the cell to its left, unless
+            // it is also the first row and the left cell is within the band
+            if(last_idx != first_idx || last_idx + 1 >= band_width) {
+                int diagonal_score = prev[last_idx] + (s1[i - 1] == s2[band_start + last_idx - 1] ? EXTEND_MATCH_SCORE : EXTEND_MISMATCH_PENALTY);
+                curr[last_idx] = diagonal_score;
+            }
+
+            // Propagate the scores down the band (the move from the cell above)
+            int carry = NEG_SCORE;
+            for(int r = first_idx; r <= last_idx; r += LANES) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(curr + r));
+                v = _mm_max_epi16(v, _mm_adds_epi16(_mm_set1_epi16(carry), v_gap_ramp));
+                v = _mm_max_epi16(v, _mm_adds_epi16(_mm_or_si128(_mm_slli_si128(v, 2), v_neg_shift1), v_gap1));
+                v = _mm_max_epi16(v, _mm_adds_epi16(_mm_or_si128(_mm_slli_si128(v, 4), v_neg_shift2), v_gap2));
+                v = _mm_max_epi16(v, _mm_adds_epi16(_mm_or_si128(_mm_slli_si128(v, 8), v_neg_shift4), v_gap4));
+                _mm_storeu_si128((__m128i*)(curr + r), v);
+                carry = (int16_t)_mm_extract_epi16(v, 7);
+            }
+
+            // Clear the scores written past the end of the band and save the band
+            memset(curr + last_idx + 1, 0, LANES * sizeof(int16_t));
+            int* out = &cells[i * band_width];
+            for(int r = first_idx; r <= last_idx; ++r)
+                out[r] = curr[r];
+        }
+        std::swap(prev, curr);
+    }
+    return true;
+}
+#endif
+
+SequenceOverlap Overlapper::extendMatch(const std::string& s1, const std::string& s2, 
+                                        int start_1, int start_2, int band_width)
+{
+    SequenceOverlap output;
+    int num_columns = s1.size() + 1;
+    int num_rows = s2.size() + 1;
+
+    const int MATCH_SCORE = EXTEND_MATCH_SCORE;
+    const int GAP_PENALTY = EXTEND_GAP_PENALTY;
+    const int MISMATCH_PENALTY = EXTEND_MISMATCH_PENALTY;
+    
+    // Calculate the number of cells off the diagonal to compute
+    int half_width = band_width / 2;
+    band_width = half_width * 2 + 1; // the total number of cells per band
+
+    // Calculate the number of columns that we need to extend to for s1
+    size_t num_cells_required = num_columns * band_width;
+
+    // Allocate bands with uninitialized scores
+    int INVALID_SCORE = std::numeric_limits<int>::min();
+    DPCells cells(num_cells_required, 0);
+
+    // Calculate the band center coordinates in the first
+    // column of the multiple alignment. These are calculated by
+    // projecting the match diagonal onto the first column. It is possible
+    // that these are negative.
+    int band_center = start_2 - start_1 + 1;
+    int band_origin = band_center - (half_width + 1);
+#ifdef DEBUG_EXTEND
+    printf("Match start: [%d %d]\n", start_1, start_2);
+    printf("Band center, origin: [%d %d]\n", band_center, band_origin);
+    printf("Num cells: %zu\n", cells.size());
+#endif
+
+    // Fill in the bands column by column
+#if OVERLAPPER_USE_SSE2
+    if(!_fillBandedCellsSSE2(s1, s2, band_width, band_origin, cells))
+        _fillBandedCellsScalar(s1, s2, band_width, band_origin, cells);
+#else
+    _fillBandedCellsScalar(s1, s2, band_width, band_origin, cells);
+#endif
 
     // The location of the highest scoring match in the
     // last row or last column is the maximum scoring overlap
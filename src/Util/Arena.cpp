@@ -0,0 +1,290 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// Arena - Memory pool for the small objects of the
+// assembly graphs. See Arena.h for a description
+// of the allocation strategy.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <iostream>
+#include "Arena.h"
+#include "Profiler.h"
+
+// The header at the start of each chunk
+struct Arena::Chunk
+{
+    Arena* pArena;
+
+    // Links in the list of all the chunks of the arena
+    Chunk* pNext;
+    Chunk* pPrev;
+
+    // Links in the list of chunks of the class with free blocks
+    Chunk* pNextAvailable;
+    Chunk* pPrevAvailable;
+    bool isAvailable;
+
+    // Freed blocks form a singly-linked list through their first word.
+    // Blocks past pUnused have never been allocated.
+    void* pFreeList;
+    char* pUnused;
+
+    size_t sizeClass;
+    size_t bytes;
+    size_t capacity;
+    size_t numLive;
+};
+
+//
+Arena::Arena() : m_lock(0), m_pChunks(NULL), m_numChunks(0), m_reservedBytes(0), m_liveBytes(0), m_numLiveObjects(0)
+{
+    for(size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+    {
+        m_pAvailable[i] = NULL;
+        m_nextChunkSize[i] = MIN_CHUNK_SIZE;
+    }
+}
+
+//
+Arena::~Arena()
+{
+    Chunk* pChunk = m_pChunks;
+    while(pChunk != NULL)
+    {
+        Chunk* pNext = pChunk->pNext;
+        free(pChunk);
+        pChunk = pNext;
+    }
+    PROFILE_MEMORY("Arena", -(int64_t)m_reservedBytes);
+}
+
+//
+void* Arena::alloc(size_t bytes)
+{
+    size_t sizeClass = getSizeClass(bytes);
+    if(sizeClass >= NUM_SIZE_CLASSES)
+    {
+        std::cerr << "Arena: cannot allocate an object of " << bytes << " bytes, the maximum is " << MAX_OBJECT_SIZE << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    lock();
+    void* ptr = allocLocked(sizeClass);
+    unlock();
+    return ptr;
+}
+
+//
+void Arena::dealloc(void* ptr)
+{
+    if(ptr == NULL)
+        return;
+
+    Chunk* pChunk = getChunk(ptr);
+    Arena* pArena = pChunk->pArena;
+    pArena->lock();
+    pArena->deallocLocked(pChunk, ptr);
+    pArena->unlock();
+}
+
+//
+Arena* Arena::getOwner(void* ptr)
+{
+    return getChunk(ptr)->pArena;
+}
+
+//
+size_t Arena::getLiveBytes() const
+{
+    return m_liveBytes;
+}
+
+//
+size_t Arena::getReservedBytes() const
+{
+    return m_reservedBytes;
+}
+
+//
+size_t Arena::getNumLiveObjects() const
+{
+    return m_numLiveObjects;
+}
+
+//
+void Arena::printStats() const
+{
+    size_t reserved = getReservedBytes();
+    printf("arena: %zu objects using %zu bytes of %zu reserved bytes in %zu chunks (%.1lf%% used)\n",
+           m_numLiveObjects, m_liveBytes, reserved, m_numChunks, reserved > 0 ? 100.0 * m_liveBytes / reserved : 0.0);
+}
+
+//
+Arena::Chunk* Arena::getChunk(void* ptr)
+{
+    return (Chunk*)((uintptr_t)ptr & ~(uintptr_t)(CHUNK_SIZE - 1));
+}
+
+//
+Arena::Chunk* Arena::newChunk(size_t sizeClass)
+{
+    // The blocks start after the header. The chunk must hold at least one block
+    size_t headerSize = (sizeof(Chunk) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    size_t bytes = m_nextChunkSize[sizeClass];
+    while(bytes < CHUNK_SIZE && bytes < headerSize + sizeClass * ALIGNMENT)
+        bytes *= 2;
+    m_nextChunkSize[sizeClass] = bytes < CHUNK_SIZE ? bytes * 2 : CHUNK_SIZE;
+
+    void* pMemory = NULL;
+    if(posix_memalign(&pMemory, CHUNK_SIZE, bytes) != 0)
+    {
+        std::cerr << "Arena failed to allocate " << bytes << " bytes for memory pool, exiting\n";
+        exit(EXIT_FAILURE);
+    }
+
+    Chunk* pChunk = (Chunk*)pMemory;
+    pChunk->pArena = this;
+    pChunk->sizeClass = sizeClass;
+    pChunk->bytes = bytes;
+    pChunk->capacity = (bytes - headerSize) / (sizeClass * ALIGNMENT);
+    pChunk->numLive = 0;
+    pChunk->pFreeList = NULL;
+    pChunk->pUnused = (char*)pMemory + headerSize;
+
+    // Add to the list of all chunks
+    pChunk->pPrev = NULL;
+    pChunk->pNext = m_pChunks;
+    if(m_pChunks != NULL)
+        m_pChunks->pPrev = pChunk;
+    m_pChunks = pChunk;
+
+    // Add to the front of the available list
+    pChunk->isAvailable = true;
+    pChunk->pPrevAvailable = NULL;
+    pChunk->pNextAvailable = m_pAvailable[sizeClass];
+    if(m_pAvailable[sizeClass] != NULL)
+        m_pAvailable[sizeClass]->pPrevAvailable = pChunk;
+    m_pAvailable[sizeClass] = pChunk;
+
+    m_numChunks += 1;
+    m_reservedBytes += bytes;
+    PROFILE_MEMORY("Arena", (int64_t)bytes);
+    return pChunk;
+}
+
+// Remove a chunk from the available list of its class
+void Arena::removeAvailable(Chunk* pChunk)
+{
+    if(pChunk->pPrevAvailable != NULL)
+        pChunk->pPrevAvailable->pNextAvailable = pChunk->pNextAvailable;
+    else
+        m_pAvailable[pChunk->sizeClass] = pChunk->pNextAvailable;
+    if(pChunk->pNextAvailable != NULL)
+        pChunk->pNextAvailable->pPrevAvailable = pChunk->pPrevAvailable;
+    pChunk->pNextAvailable = NULL;
+    pChunk->pPrevAvailable = NULL;
+    pChunk->isAvailable = false;
+}
+
+//
+void Arena::releaseChunk(Chunk* pChunk)
+{
+    assert(pChunk->numLive == 0);
+    if(pChunk->isAvailable)
+        removeAvailable(pChunk);
+
+    if(pChunk->pPrev != NULL)
+        pChunk->pPrev->pNext = pChunk->pNext;
+    else
+        m_pChunks = pChunk->pNext;
+    if(pChunk->pNext != NULL)
+        pChunk->pNext->pPrev = pChunk->pPrev;
+
+    size_t bytes = pChunk->bytes;
+    free(pChunk);
+    m_numChunks -= 1;
+    m_reservedBytes -= bytes;
+    PROFILE_MEMORY("Arena", -(int64_t)bytes);
+}
+
+//
+void* Arena::allocLocked(size_t sizeClass)
+{
+    Chunk* pChunk = m_pAvailable[sizeClass];
+    if(pChunk == NULL)
+        pChunk = newChunk(sizeClass);
+
+    // Reuse a freed block if possible
+    size_t blockSize = sizeClass * ALIGNMENT;
+    void* ptr;
+    if(pChunk->pFreeList != NULL)
+    {
+        ptr = pChunk->pFreeList;
+        pChunk->pFreeList = *(void**)ptr;
+    }
+    else
+    {
+        ptr = pChunk->pUnused;
+        pChunk->pUnused += blockSize;
+    }
+
+    pChunk->numLive += 1;
+    if(pChunk->numLive == pChunk->capacity)
+        removeAvailable(pChunk);
+
+    m_liveBytes += blockSize;
+    m_numLiveObjects += 1;
+    return ptr;
+}
+
+//
+void Arena::deallocLocked(Chunk* pChunk, void* ptr)
+{
+    assert(pChunk->pArena == this && pChunk->numLive > 0);
+    *(void**)ptr = pChunk->pFreeList;
+    pChunk->pFreeList = ptr;
+    pChunk->numLive -= 1;
+
+    m_liveBytes -= pChunk->sizeClass * ALIGNMENT;
+    m_numLiveObjects -= 1;
+
+    size_t sizeClass = pChunk->sizeClass;
+    if(!pChunk->isAvailable)
+    {
+        // The chunk was full, it can now serve allocations again
+        pChunk->isAvailable = true;
+        pChunk->pPrevAvailable = NULL;
+        pChunk->pNextAvailable = m_pAvailable[sizeClass];
+        if(m_pAvailable[sizeClass] != NULL)
+            m_pAvailable[sizeClass]->pPrevAvailable = pChunk;
+        m_pAvailable[sizeClass] = pChunk;
+    }
+
+    // Release empty chunks back to the system, keeping one per class
+    // so that alternating allocations and deletions do not thrash
+    bool isOnlyAvailable = m_pAvailable[sizeClass] == pChunk && pChunk->pNextAvailable == NULL;
+    if(pChunk->numLive == 0 && !isOnlyAvailable)
+        releaseChunk(pChunk);
+}
+
+//
+void Arena::lock()
+{
+    while(__sync_lock_test_and_set(&m_lock, 1))
+    {
+        while(m_lock)
+            ;
+    }
+}
+
+//
+void Arena::unlock()
+{
+    __sync_lock_release(&m_lock);
+}
@@ -0,0 +1,117 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// Arena - Memory pool for the small objects of the
+// assembly graphs (vertices, edges and the scaffold
+// graph types).
+//
+// Objects are carved out of chunks. Each chunk serves one
+// size class, a multiple of ALIGNMENT bytes, and keeps a list
+// of its freed blocks so the memory released by the graph
+// simplification passes is reused. The first chunk of a class
+// is MIN_CHUNK_SIZE bytes and each new chunk of the class is
+// twice the size of the previous one, up to CHUNK_SIZE, so
+// small graphs do not reserve much more than they use.
+// A chunk that no longer holds any object is returned to the
+// system, unless it is the only chunk of its class with free
+// space. Every chunk is aligned to CHUNK_SIZE so the chunk, and
+// the arena, that owns a block can be found from its address.
+// This allows objects to be deleted without a reference to
+// their arena and without a per-object header.
+//
+// The arena is thread-safe.
+//
+// All the memory is released when the arena is destroyed,
+// whether or not the objects in it have been deleted.
+// The destructors of the remaining objects are not called.
+//
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+class Arena
+{
+    public:
+
+        // Each chunk holds blocks of a single size. CHUNK_SIZE is
+        // the size of the largest chunk and the alignment of all chunks
+        static const size_t MIN_CHUNK_SIZE = 4 * 1024;
+        static const size_t CHUNK_SIZE = 256 * 1024;
+
+        // Block sizes are rounded up to a multiple of this value
+        static const size_t ALIGNMENT = 16;
+
+        // The largest object that can be allocated from the arena
+        static const size_t MAX_OBJECT_SIZE = 1024;
+        static const size_t NUM_SIZE_CLASSES = MAX_OBJECT_SIZE / ALIGNMENT + 1;
+
+        Arena();
+        ~Arena();
+
+        // Allocate a block of at least bytes
+        void* alloc(size_t bytes);
+
+        // Return a block to the arena that allocated it
+        static void dealloc(void* ptr);
+
+        // Return the arena that allocated a block
+        static Arena* getOwner(void* ptr);
+
+        // The bytes in blocks that are in use
+        size_t getLiveBytes() const;
+
+        // The bytes in the chunks reserved from the system
+        size_t getReservedBytes() const;
+
+        //
+        size_t getNumLiveObjects() const;
+        void printStats() const;
+
+    private:
+
+        struct Chunk;
+
+        // Not copyable
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+
+        static inline size_t getSizeClass(size_t bytes)
+        {
+            return bytes == 0 ? 1 : (bytes + ALIGNMENT - 1) / ALIGNMENT;
+        }
+
+        static Chunk* getChunk(void* ptr);
+
+        // These functions must be called with the lock held
+        Chunk* newChunk(size_t sizeClass);
+        void releaseChunk(Chunk* pChunk);
+        void removeAvailable(Chunk* pChunk);
+        void* allocLocked(size_t sizeClass);
+        void deallocLocked(Chunk* pChunk, void* ptr);
+
+        void lock();
+        void unlock();
+
+        // Data
+        volatile int m_lock;
+
+        // The chunks of each class that have free blocks
+        Chunk* m_pAvailable[NUM_SIZE_CLASSES];
+
+        // The size of the next chunk to allocate for each class
+        size_t m_nextChunkSize[NUM_SIZE_CLASSES];
+
+        // Every chunk owned by the arena, so they can be released on destruction
+        Chunk* m_pChunks;
+
+        size_t m_numChunks;
+        size_t m_reservedBytes;
+        size_t m_liveBytes;
+        size_t m_numLiveObjects;
+};
+
+#endif
@@ -4,20 +4,22 @@
 // Released under the GPL license
 //-----------------------------------------------
 //
-// BitVector - Vector of bits 
+// BitVector - Vector of bits
 //
 #include "BitVector.h"
 #include <assert.h>
 #include <cstdlib>
 
+static const uint32_t BV_MAGIC_NUMBER = 8347;
+
 //
-BitVector::BitVector()
+BitVector::BitVector() : m_numBits(0)
 {
     initializeMutex();
 }
 
 //
-BitVector::BitVector(size_t n)
+BitVector::BitVector(size_t n) : m_numBits(0)
 {
     initializeMutex();
     resize(n);
@@ -47,8 +49,20 @@ BitVector::~BitVector()
 //
 void BitVector::resize(size_t n)
 {
-    size_t num_bytes = (n % 8 == 0) ? n / 8 : (n / 8) + 1;
-    m_data.resize(num_bytes);
+    size_t num_words = (n + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    m_words.resize(num_words, 0);
+
+    // Clear any bits past the new end so that counts and searches do not see them
+    if(n < m_numBits && n % BITS_PER_WORD != 0)
+        m_words.back() &= getMask(n) - 1;
+    m_numBits = n;
+    m_blockRanks.clear();
+}
+
+//
+size_t BitVector::getMemSize() const
+{
+    return m_words.capacity() * sizeof(uint64_t) + m_blockRanks.capacity() * sizeof(uint64_t);
 }
 
 //
@@ -66,27 +80,182 @@ void BitVector::unlock()
 //
 bool BitVector::updateCAS(size_t i, bool oldValue, bool newValue)
 {
-    size_t byte = i / 8;
-    assert(byte < m_data.size());
-    size_t offset = i - byte * 8;
-    return m_data[byte].updateCAS(offset, oldValue, newValue);
+    assert(i < m_numBits);
+    assert(oldValue != newValue);
+    volatile uint64_t* pWord = &m_words[i / BITS_PER_WORD];
+    uint64_t mask = getMask(i);
+
+    // Iterate attempts of the CAS operation until the desired bit has the correct value.
+    while(1)
+    {
+        uint64_t oldWord = *pWord;
+
+        // If the bit already has the new value, some other thread has updated it
+        bool currValue = (oldWord & mask) != 0;
+        if(currValue == newValue)
+            return false;
+
+        uint64_t newWord = newValue ? (oldWord | mask) : (oldWord & ~mask);
+        if(__sync_bool_compare_and_swap(pWord, oldWord, newWord))
+            return true;
+    }
 }
 
+//
+bool BitVector::testAndSet(size_t i)
+{
+    assert(i < m_numBits);
+    uint64_t mask = getMask(i);
+    uint64_t oldWord = __sync_fetch_and_or(&m_words[i / BITS_PER_WORD], mask);
+    return (oldWord & mask) == 0;
+}
 
 // Set bit at position i to value v
 void BitVector::set(size_t i, bool v)
 {
-    size_t byte = i / 8;
-    assert(byte < m_data.size());
-    size_t offset = i - byte * 8;
-    m_data[byte].set(offset, v);
+    assert(i < m_numBits);
+    uint64_t& word = m_words[i / BITS_PER_WORD];
+    if(v)
+        word |= getMask(i);
+    else
+        word &= ~getMask(i);
 }
 
 // Test bit i
 bool BitVector::test(size_t i) const
 {
-    size_t byte = i / 8;
-    size_t offset = i - byte * 8;
-    return m_data[byte].test(offset);
+    assert(i < m_numBits);
+    return (m_words[i / BITS_PER_WORD] & getMask(i)) != 0;
+}
+
+//
+size_t BitVector::count() const
+{
+    size_t n = 0;
+    for(size_t i = 0; i < m_words.size(); ++i)
+        n += __builtin_popcountll(m_words[i]);
+    return n;
+}
+
+//
+size_t BitVector::findNextSet(size_t i) const
+{
+    if(i >= m_numBits)
+        return m_numBits;
+
+    // Mask out the bits before i in the first word
+    size_t wordIdx = i / BITS_PER_WORD;
+    uint64_t word = m_words[wordIdx] & ~(getMask(i) - 1);
+    while(word == 0)
+    {
+        if(++wordIdx == m_words.size())
+            return m_numBits;
+        word = m_words[wordIdx];
+    }
+    return wordIdx * BITS_PER_WORD + __builtin_ctzll(word);
+}
+
+//
+void BitVector::buildRankIndex()
+{
+    size_t numBlocks = (m_words.size() + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK;
+    m_blockRanks.resize(numBlocks + 1);
+
+    uint64_t running = 0;
+    for(size_t i = 0; i < m_words.size(); ++i)
+    {
+        if(i % WORDS_PER_BLOCK == 0)
+            m_blockRanks[i / WORDS_PER_BLOCK] = running;
+        running += __builtin_popcountll(m_words[i]);
+    }
+    m_blockRanks[numBlocks] = running;
+}
+
+//
+size_t BitVector::rank(size_t i) const
+{
+    assert(i <= m_numBits);
+    assert(!m_blockRanks.empty());
+
+    size_t wordIdx = i / BITS_PER_WORD;
+    size_t blockStart = wordIdx - wordIdx % WORDS_PER_BLOCK;
+    size_t r = m_blockRanks[wordIdx / WORDS_PER_BLOCK];
+    for(size_t j = blockStart; j < wordIdx; ++j)
+        r += __builtin_popcountll(m_words[j]);
+
+    if(i % BITS_PER_WORD != 0)
+        r += __builtin_popcountll(m_words[wordIdx] & (getMask(i) - 1));
+    return r;
+}
+
+//
+size_t BitVector::select(size_t k) const
+{
+    assert(!m_blockRanks.empty());
+    if(k >= m_blockRanks.back())
+        return m_numBits;
+
+    // Find the last block that starts with at most k set bits before it
+    size_t lo = 0;
+    size_t hi = m_blockRanks.size() - 1;
+    while(hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+        if(m_blockRanks[mid] <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    // Scan the words of the block
+    size_t remaining = k - m_blockRanks[lo];
+    size_t wordIdx = lo * WORDS_PER_BLOCK;
+    size_t c;
+    while((c = __builtin_popcountll(m_words[wordIdx])) <= remaining)
+    {
+        remaining -= c;
+        ++wordIdx;
+    }
+
+    // Clear the lower set bits of the word until the target is the lowest
+    uint64_t word = m_words[wordIdx];
+    for(size_t j = 0; j < remaining; ++j)
+        word &= word - 1;
+    return wordIdx * BITS_PER_WORD + __builtin_ctzll(word);
+}
+
+//
+void BitVector::write(std::ostream& out) const
+{
+    out.write(reinterpret_cast<const char*>(&BV_MAGIC_NUMBER), sizeof(BV_MAGIC_NUMBER));
+    uint64_t numBits = m_numBits;
+    out.write(reinterpret_cast<const char*>(&numBits), sizeof(numBits));
+    if(!m_words.empty())
+        out.write(reinterpret_cast<const char*>(&m_words[0]), m_words.size() * sizeof(uint64_t));
 }
 
+//
+void BitVector::read(std::istream& in)
+{
+    uint32_t magic = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    if(magic != BV_MAGIC_NUMBER)
+    {
+        std::cerr << "Error: the input is not a BitVector (magic number " << magic << ")\n";
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t numBits = 0;
+    in.read(reinterpret_cast<char*>(&numBits), sizeof(numBits));
+    m_words.clear();
+    m_numBits = 0;
+    resize(numBits);
+    if(!m_words.empty())
+        in.read(reinterpret_cast<char*>(&m_words[0]), m_words.size() * sizeof(uint64_t));
+
+    if(!in)
+    {
+        std::cerr << "Error: the BitVector data is truncated\n";
+        exit(EXIT_FAILURE);
+    }
+}
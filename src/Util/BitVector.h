@@ -7,23 +7,31 @@
 // BitVector - Vector of bits. The structure
 // can be locked by a mutex to guarentee atomic access.
 //
+// The bits are stored in 64-bit words so that
+// counting and searching for bits can process a
+// word at a time. After buildRankIndex() has been
+// called, rank() takes constant time and select()
+// performs a binary search over blocks of 512 bits.
+//
 #ifndef BITVECTOR_H
 #define BITVECTOR_H
 
-#include "BitChar.h"
+#include <stdint.h>
+#include <pthread.h>
+#include <iostream>
 #include <vector>
 
 class BitVector
 {
     public:
-    
+
         BitVector();
         BitVector(size_t n);
         ~BitVector();
 
         // Functions to acquire/release the mutex
         // The client code is responsible for acquiring
-        // the lock before calling set(). Reading a bit with 
+        // the lock before calling set(). Reading a bit with
         // test() is ok however.
         void lock();
         void unlock();
@@ -32,17 +40,66 @@ class BitVector
         // compare and swap operation. Returns true if the update is successful.
         bool updateCAS(size_t i, bool oldValue, bool newValue);
 
+        // Atomically set the bit at position i. Returns true if this call
+        // changed the bit, false if it was already set.
+        bool testAndSet(size_t i);
+
         void resize(size_t n);
         void set(size_t i, bool v);
         bool test(size_t i) const;
 
-        size_t capacity() const { return m_data.size() * 8; }
+        // The number of bits in the vector
+        size_t size() const { return m_numBits; }
+        size_t capacity() const { return m_words.size() * BITS_PER_WORD; }
+        size_t getMemSize() const;
+
+        // Count the set bits. This scans the vector and may be
+        // called while other threads update it.
+        size_t count() const;
+
+        // Return the position of the first set bit at or
+        // after i, or size() if there is no such bit
+        size_t findNextSet(size_t i) const;
+
+        // Calculate the rank samples used by rank() and select().
+        // This must be called again after the vector is modified.
+        void buildRankIndex();
+
+        // Return the number of set bits in [0, i)
+        size_t rank(size_t i) const;
+
+        // Return the position of the k-th set bit, counting from zero.
+        // Returns size() if fewer than k + 1 bits are set.
+        size_t select(size_t k) const;
+
+        // I/O
+        void write(std::ostream& out) const;
+        void read(std::istream& in);
 
     private:
 
+        static const size_t BITS_PER_WORD = 64;
+
+        // The rank index stores a cumulative count every WORDS_PER_BLOCK words
+        static const size_t WORDS_PER_BLOCK = 8;
+
+        static inline uint64_t getMask(size_t i)
+        {
+            return (uint64_t)1 << (i % BITS_PER_WORD);
+        }
+
         void initializeMutex();
 
-        std::vector<BitChar> m_data;
+        // Not copyable
+        BitVector(const BitVector&);
+        BitVector& operator=(const BitVector&);
+
+        std::vector<uint64_t> m_words;
+        size_t m_numBits;
+
+        // The number of set bits preceding each block, with
+        // the total count as the last entry
+        std::vector<uint64_t> m_blockRanks;
         pthread_mutex_t m_mutex;
 };
 
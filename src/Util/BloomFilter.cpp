@@ -88,16 +88,14 @@ bool BloomFilter::test(const void* key, int num_bytes) const
 //
 void BloomFilter::printOccupancy() const
 {
-    size_t set_count = 0;
-    for(size_t i = 0; i < m_width; ++i)
-        set_count += m_bitvector.test(i);
+    size_t set_count = m_bitvector.count();
     printf("%zu out of %zu bits are set\n", set_count, m_width);
 }
 
 //
 void BloomFilter::printMemory() const
 {
-    size_t bytes = m_bitvector.capacity();
+    size_t bytes = m_bitvector.getMemSize();
     double mb = (double)bytes / (1 << 20);
     printf("BloomFilter using %.1lf MB\n", mb);
 }
@@ -4,25 +4,54 @@
 // Released under the GPL
 //-----------------------------------------------
 //
-// DNAString 
+// DNAString
 //
 #include <iostream>
 #include "DNAString.h"
 #include "Util.h"
 
-DNAString::DNAString() : m_len(0), m_data(0) {}
+// Indexed by the offset of a base within its byte and the byte
+const char DNAString::s_unpackLUT[4][257] = {
+    {
+        "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+        "CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC"
+        "GGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGGG"
+        "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT"
+    },
+    {
+        "AAAAAAAAAAAAAAAACCCCCCCCCCCCCCCCGGGGGGGGGGGGGGGGTTTTTTTTTTTTTTTT"
+        "AAAAAAAAAAAAAAAACCCCCCCCCCCCCCCCGGGGGGGGGGGGGGGGTTTTTTTTTTTTTTTT"
+        "AAAAAAAAAAAAAAAACCCCCCCCCCCCCCCCGGGGGGGGGGGGGGGGTTTTTTTTTTTTTTTT"
+        "AAAAAAAAAAAAAAAACCCCCCCCCCCCCCCCGGGGGGGGGGGGGGGGTTTTTTTTTTTTTTTT"
+    },
+    {
+        "AAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTT"
+        "AAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTT"
+        "AAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTT"
+        "AAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTTAAAACCCCGGGGTTTT"
+    },
+    {
+        "ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT"
+        "ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT"
+        "ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT"
+        "ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGT"
+    }
+};
+
+DNAString::DNAString() : m_isPacked(false), m_inArena(false), m_len(0), m_pData(0) {}
 
 //
 DNAString::DNAString(std::string seq)
 {
-    _alloc(seq.c_str(), seq.length());
+    _alloc(seq.c_str(), seq.length(), NULL);
 }
 
 //
 DNAString::DNAString(const DNAString& other)
 {
     // Deep copy
-    _alloc(other.m_data, other.m_len);
+    m_pData = NULL;
+    assign(other, NULL);
 }
 
 //
@@ -31,8 +60,7 @@ DNAString& DNAString::operator=(const DNAString& dna)
     if(&dna == this)
         return *this; // self-assign
 
-    _dealloc();
-    _alloc(dna.m_data, dna.m_len);
+    assign(dna, NULL);
     return *this;
 }
 
@@ -40,35 +68,103 @@ DNAString& DNAString::operator=(const DNAString& dna)
 DNAString& DNAString::operator=(const std::string& str)
 {
     _dealloc();
-    _alloc(str.c_str(), str.length());
+    _alloc(str.c_str(), str.length(), NULL);
     return *this;
 }
 
 //
 bool DNAString::operator==(const DNAString& other)
 {
-    if(m_len != other.m_len)
+    // A string is packed if and only if it only contains ACGT
+    // so equal strings are stored in the same way
+    if(m_len != other.m_len || m_isPacked != other.m_isPacked)
         return false;
-    return strncmp(m_data, other.m_data, m_len) == 0;
+    return m_len == 0 || memcmp(m_pData, other.m_pData, _getNumBytes(m_len, m_isPacked)) == 0;
 }
 
 //
-void DNAString::_alloc(const char* pData, size_t l)
+void DNAString::assign(const DNAString& other, Arena* pArena)
+{
+    if(&other == this)
+        return;
+
+    size_t n = _getNumBytes(other.m_len, other.m_isPacked);
+    _dealloc();
+    _allocBytes(n, pArena);
+    if(n > 0)
+        memcpy(m_pData, other.m_pData, n);
+    m_len = other.m_len;
+    m_isPacked = other.m_isPacked;
+}
+
+// Store the l bases of pData, packing them if they are all ACGT
+void DNAString::_alloc(const char* pData, size_t l, Arena* pArena)
 {
+    bool isPacked = true;
+    for(size_t i = 0; i < l && isPacked; ++i)
+        isPacked = pData[i] == 'A' || pData[i] == 'C' || pData[i] == 'G' || pData[i] == 'T';
+
+    m_pData = NULL;
+    _allocBytes(_getNumBytes(l, isPacked), pArena);
     m_len = l;
-    size_t alloc_len = m_len + 1;
-    m_data = new char[alloc_len];
-    strncpy(m_data, pData, m_len);
-    m_data[m_len] = '\0';
+    m_isPacked = isPacked;
+    if(isPacked)
+    {
+        for(size_t i = 0; i < l; ++i)
+            _store(i, pData[i]);
+    }
+    else if(l > 0)
+    {
+        memcpy(m_pData, pData, l);
+    }
+}
+
+// Allocate n zeroed bytes of storage. Small blocks come from pArena if it is not NULL
+void DNAString::_allocBytes(size_t n, Arena* pArena)
+{
+    m_len = 0;
+    m_isPacked = false;
+    m_inArena = false;
+    m_pData = NULL;
+    if(n == 0)
+        return;
+
+    if(pArena != NULL && n <= Arena::MAX_OBJECT_SIZE)
+    {
+        m_pData = (char*)pArena->alloc(n);
+        memset(m_pData, 0, n);
+        m_inArena = true;
+    }
+    else
+    {
+        m_pData = new char[n](); // This zeros the memory
+    }
 }
 
 //
 void DNAString::_dealloc()
 {
-    if(m_data != NULL)
-        delete [] m_data;
-    m_data = 0;
+    if(m_pData != NULL)
+    {
+        if(m_inArena)
+            Arena::dealloc(m_pData);
+        else
+            delete [] m_pData;
+    }
+    m_pData = 0;
     m_len = 0;
+    m_isPacked = false;
+    m_inArena = false;
+}
+
+// Set the base at position idx of a packed string
+void DNAString::_store(size_t idx, char b)
+{
+    assert(m_isPacked && idx < m_len);
+    uint8_t code = b == 'A' ? 0 : (b == 'C' ? 1 : (b == 'G' ? 2 : 3));
+    uint8_t shift = 2 * (3 - (idx & 3));
+    uint8_t& unit = (uint8_t&)m_pData[idx >> 2];
+    unit = (unit & ~(3 << shift)) | (code << shift);
 }
 
 //
@@ -84,39 +180,61 @@ void DNAString::reverse()
     for(size_t idx = 0; idx < half; ++idx)
     {
         size_t opp = m_len - idx - 1;
-        char tmp = m_data[opp];
-        m_data[opp] = m_data[idx];
-        m_data[idx] = tmp;
+        if(m_isPacked)
+        {
+            char tmp = get(opp);
+            _store(opp, get(idx));
+            _store(idx, tmp);
+        }
+        else
+        {
+            char tmp = m_pData[opp];
+            m_pData[opp] = m_pData[idx];
+            m_pData[idx] = tmp;
+        }
     }
 }
 
+// The complement of a packed string is also packed
 void DNAString::reverseComplement()
 {
     this->reverse();
-    for(size_t idx = 0; idx < m_len; ++idx) m_data[idx] = complement(m_data[idx]);    
+    for(size_t idx = 0; idx < m_len; ++idx)
+    {
+        if(m_isPacked)
+            _store(idx, complement(get(idx)));
+        else
+            m_pData[idx] = complement(m_pData[idx]);
+    }
 }
 
-
+// A packed string has no N bases. Otherwise the string
+// is rebuilt, so it is packed if it only has ACGT left.
 void DNAString::disambiguate()
 {
-    if(m_len == 0)
+    if(m_len == 0 || m_isPacked)
         return;
-    
+
+    std::string str = toString();
     for(size_t idx = 0; idx < m_len; ++idx)
     {
-        if(m_data[idx] == 'N')
-        {
-            m_data[idx] = randomBase();
-        }
+        if(str[idx] == 'N')
+            str[idx] = randomBase();
     }
+
+    Arena* pArena = m_inArena ? Arena::getOwner(m_pData) : NULL;
+    _dealloc();
+    _alloc(str.c_str(), str.length(), pArena);
 }
 
 //
 std::string DNAString::getSuffixString(size_t idx) const
 {
     std::string str;
-    str.reserve(getSuffixLength(idx) + 1);
-    str += getSuffix(idx);
+    size_t n = getSuffixLength(idx);
+    str.reserve(n + 1);
+    if(n > 0)
+        str += substr(idx, n);
     str += "$";
     return str;
 }
@@ -124,5 +242,13 @@ std::string DNAString::getSuffixString(size_t idx) const
 //
 std::string DNAString::toString() const
 {
-    return std::string(m_data, m_len);
+    if(m_len == 0)
+        return std::string();
+    return substr(0, m_len);
+}
+
+//
+size_t DNAString::getMemSize() const
+{
+    return sizeof(*this) + _getNumBytes(m_len, m_isPacked);
 }
@@ -4,20 +4,28 @@
 // Released under the GPL license
 //-----------------------------------------------
 //
-// DNAString - Wrapper for c-string for DNA sequences
-// It is tailored for fast suffix operations
+// DNAString - String of DNA bases
+//
+// A string of only A, C, G and T is stored with
+// 2 bits per base, in the layout used by DNACodec.
+// Any other string, for example a reference with
+// N bases, is stored with one byte per base.
+// The storage is taken from the heap or, if one
+// is given, from an Arena.
 //
 
 #ifndef DNASTRING_H
 #define DNASTRING_H
 #include <string.h>
 #include <string>
-#include <assert.h> 
+#include <assert.h>
+#include <stdint.h>
+#include "Arena.h"
 
 class DNAString
 {
     public:
-        
+
         // Constructors/Destructors
         DNAString();
         DNAString(const DNAString& other);
@@ -29,6 +37,31 @@ class DNAString
         DNAString& operator=(const std::string& str);
         bool operator==(const DNAString& other);
 
+        // Replace the contents with a copy of other, storing it
+        // in pArena if it is not NULL
+        void assign(const DNAString& other, Arena* pArena);
+
+        // Swap the contents with another string without copying
+        void swap(DNAString& other)
+        {
+            size_t tmp;
+            tmp = other.m_len;
+            other.m_len = m_len;
+            m_len = tmp;
+
+            tmp = other.m_isPacked;
+            other.m_isPacked = m_isPacked;
+            m_isPacked = tmp;
+
+            tmp = other.m_inArena;
+            other.m_inArena = m_inArena;
+            m_inArena = tmp;
+
+            char* pTmp = other.m_pData;
+            other.m_pData = m_pData;
+            m_pData = pTmp;
+        }
+
         size_t length() const
         {
             return m_len;
@@ -36,19 +69,9 @@ class DNAString
 
         bool empty() const
         {
-            return m_len == 0 || m_data[0] == '\0';
+            return m_len == 0;
         }
 
-        inline const char* getSuffix(size_t idx) const
-        {
-            assert(m_len > 0);
-            // Force the suffix to point to the empty string if out of bounds
-            if(idx <= m_len)
-                return m_data + idx;
-            else
-                return m_data + m_len;
-        }
-        
         // Return the length of the suffix (not including $) starting at idx
         size_t getSuffixLength(size_t idx) const
         {
@@ -59,25 +82,28 @@ class DNAString
                 return 0;
         }
 
-        // Get the character at the given position
+        // Get the character at the given position.
+        // Position length() holds the terminating '\0'
         inline char get(size_t idx) const
         {
             assert(idx < m_len + 1);
-            return m_data[idx];
-        }
-
-        // Set the character at the given position
-        inline void set(size_t idx, char b) const
-        {
-            assert(idx < m_len + 1);
-            m_data[idx] = b;
+            if(idx == m_len)
+                return '\0';
+            if(!m_isPacked)
+                return m_pData[idx];
+            return s_unpackLUT[idx & 3][(uint8_t)m_pData[idx >> 2]];
         }
 
         // Get the substring of length n starting at position pos
         std::string substr(size_t pos, size_t n) const
         {
-            assert(m_data != NULL && pos < m_len && pos + n <= m_len);
-            return std::string(m_data + pos, n);
+            assert(m_pData != NULL && pos < m_len && pos + n <= m_len);
+            if(!m_isPacked)
+                return std::string(m_pData + pos, n);
+            std::string out(n, 'A');
+            for(size_t i = 0; i < n; ++i)
+                out[i] = get(pos + i);
+            return out;
         }
 
         // randomly change the 'N' bases to one of ACGT so that the string is not ambiguous
@@ -88,15 +114,31 @@ class DNAString
         std::string getSuffixString(size_t idx) const;
         std::string toString() const;
 
+        // Return the amount of space this string is using
+        size_t getMemSize() const;
+
     private:
 
         // functions
-        void _alloc(const char* pData, size_t l);
+        void _alloc(const char* pData, size_t l, Arena* pArena);
+        void _allocBytes(size_t n, Arena* pArena);
         void _dealloc();
+        void _store(size_t idx, char b);
+
+        static size_t _getNumBytes(size_t l, bool isPacked)
+        {
+            return isPacked ? (l + 3) / 4 : l;
+        }
+
+        // The base at each offset of every packed byte. The rows are
+        // string literals so each one has a trailing '\0' that is never read
+        static const char s_unpackLUT[4][257];
 
         // data
-        size_t m_len;
-        char* m_data;
+        size_t m_isPacked:1; // true if the bases are stored with 2 bits each
+        size_t m_inArena:1; // true if m_pData was allocated from an arena
+        size_t m_len:62; // the length of the string
+        char* m_pData;
 };
 
 #endif
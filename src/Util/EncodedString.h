@@ -15,6 +15,12 @@
 // encodings like the 3-bit BWT this could be a larger
 // structure like uint16_t
 //
+// Short strings are stored inside the object, in the
+// bytes otherwise used for the heap pointer and capacity,
+// so the object is no larger than a plain pointer-based
+// string. Longer strings are stored on the heap or, if one
+// is given, in an Arena.
+//
 #ifndef ENCODEDSTRING_H
 #define ENCODEDSTRING_H
 #include <string.h>
@@ -24,22 +30,37 @@
 #include "BWTCodec.h"
 #include "BWT4Codec.h"
 #include "NoCodec.h"
+#include "Arena.h"
 
 template<class Codec>
 class EncodedString
 {
     typedef typename Codec::UNIT_TYPE StorageUnit;
 
+    // The storage of a string that does not fit in the object
+    struct HeapStorage
+    {
+        StorageUnit* pData;
+        size_t capacity; // the maximum length of the string that can be stored
+    };
+
+    // The inline units share the bytes of the heap storage. A
+    // DNAEncodedString holds up to 64 bases without allocating.
+    static const size_t INLINE_UNITS = sizeof(HeapStorage) / sizeof(StorageUnit);
+
     public:
         
         // Constructors/Destructors
-        EncodedString() : m_len(0), m_capacity(0), m_data(0) {}
+        EncodedString()
+        {
+            _initInline();
+        }
 
         //
         EncodedString(const EncodedString& other)
         {
             // deep copy
-            _alloc(other.m_len);
+            _alloc(other.m_len, NULL);
             _copy(other);
         }
 
@@ -47,7 +68,16 @@ class EncodedString
         EncodedString(const std::string& seq)
         {
             size_t n = seq.length();
-            _alloc(n);
+            _alloc(n, NULL);
+            _copy(seq.c_str(), n);
+        }
+
+        // Construct the string, storing it in pArena if it
+        // does not fit in the object
+        EncodedString(const std::string& seq, Arena* pArena)
+        {
+            size_t n = seq.length();
+            _alloc(n, pArena);
             _copy(seq.c_str(), n);
         }
 
@@ -63,8 +93,12 @@ class EncodedString
             if(&other == this)
                 return *this; // self-assign
 
-            _dealloc();
-            _alloc(other.m_len);
+            // Reuse the current storage if it is large enough
+            if(other.m_len > capacity())
+            {
+                _dealloc();
+                _alloc(other.m_len, NULL);
+            }
             _copy(other);
             return *this;
         }
@@ -73,8 +107,11 @@ class EncodedString
         EncodedString& operator=(const std::string& str)
         {
             size_t n = str.length();
-            _dealloc();
-            _alloc(n);
+            if(n > capacity())
+            {
+                _dealloc();
+                _alloc(n, NULL);
+            }
             _copy(str.c_str(), n);
             return *this;
         }
@@ -83,7 +120,7 @@ class EncodedString
         // new entries to the default value
         void resize(size_t n)
         {
-            if(n > m_capacity)
+            if(n > capacity())
                 _realloc(n);
             m_len = n;
         }
@@ -93,7 +130,7 @@ class EncodedString
         {
             size_t n = str.length();
             size_t num_total = m_len + n;
-            if(num_total > m_capacity)
+            if(num_total > capacity())
                 _realloc(num_total);
             _append(str.c_str(), n);
         }
@@ -103,12 +140,14 @@ class EncodedString
         {
             size_t n = other.length();
             size_t num_total = m_len + n;
-            if(num_total > m_capacity)
+            if(num_total > capacity())
                 _realloc(num_total);
             _append(other);
         }
 
-        // Swap the contents with another encoded string
+        // Swap the contents with another encoded string.
+        // This is the cheap way to transfer a string
+        // without copying its storage.
         void swap(EncodedString& other)
         {
             size_t tmp;
@@ -116,13 +155,19 @@ class EncodedString
             other.m_len = m_len;
             m_len = tmp;
 
-            tmp = other.m_capacity;
-            other.m_capacity = m_capacity;
-            m_capacity = tmp;
+            tmp = other.m_isHeap;
+            other.m_isHeap = m_isHeap;
+            m_isHeap = tmp;
 
-            StorageUnit* pTmp = other.m_data;
-            other.m_data = m_data;
-            m_data = pTmp;
+            tmp = other.m_inArena;
+            other.m_inArena = m_inArena;
+            m_inArena = tmp;
+
+            // The inline units and the heap storage share the same bytes
+            StorageUnit tmpUnits[INLINE_UNITS];
+            memcpy(tmpUnits, other.m_inline, sizeof(tmpUnits));
+            memcpy(other.m_inline, m_inline, sizeof(tmpUnits));
+            memcpy(m_inline, tmpUnits, sizeof(tmpUnits));
         }
 
         //
@@ -134,7 +179,7 @@ class EncodedString
         //
         size_t capacity() const
         {
-            return m_capacity;
+            return m_isHeap ? m_heap.capacity : _getInlineCapacity();
         }
 
         //
@@ -147,22 +192,23 @@ class EncodedString
         inline char get(size_t idx) const
         {
             assert(idx < m_len);
-            return s_codec.get(m_data, idx);
+            return s_codec.get(_data(), idx);
         }
 
         // Set the character at idx
         inline void set(size_t idx, char b)
         {
             assert(idx < m_len);
-            s_codec.store(m_data, idx, b);
+            s_codec.store(_data(), idx, b);
         }
 
         //
         std::string toString() const
         {
+            const StorageUnit* pData = _data();
             std::string out(m_len, 'A');
             for(size_t i = 0; i < m_len; ++i)
-                out[i] = s_codec.get(m_data, i);
+                out[i] = s_codec.get(pData, i);
             return out;
         }
 
@@ -170,9 +216,10 @@ class EncodedString
         std::string substr(size_t start) const
         {
             assert(start < m_len);
+            const StorageUnit* pData = _data();
             std::string out(m_len - start, 'A');
             for(size_t i = start; i < m_len; ++i)
-                out[i - start] = s_codec.get(m_data, i);
+                out[i - start] = s_codec.get(pData, i);
             return out;
         }
 
@@ -181,9 +228,10 @@ class EncodedString
         {
             assert(start < m_len);
             assert(start + len <= m_len);
+            const StorageUnit* pData = _data();
             std::string out(len, 'C');
             for(size_t i = 0; i < len; ++i)
-                out[i] = s_codec.get(m_data, i + start);
+                out[i] = s_codec.get(pData, i + start);
             return out;
         }
 
@@ -213,19 +261,46 @@ class EncodedString
         // Return the amount of space this string is using
         size_t getMemSize() const
         {
-            return sizeof(*this) + sizeof(StorageUnit) * s_codec.getRequiredUnits(m_capacity);
+            if(!m_isHeap)
+                return sizeof(*this);
+            return sizeof(*this) + sizeof(StorageUnit) * s_codec.getRequiredUnits(m_heap.capacity);
         }
 
     private:
 
         // functions
+        static size_t _getInlineCapacity()
+        {
+            return s_codec.getCapacity(INLINE_UNITS);
+        }
+
+        StorageUnit* _data()
+        {
+            return m_isHeap ? m_heap.pData : m_inline;
+        }
+
+        const StorageUnit* _data() const
+        {
+            return m_isHeap ? m_heap.pData : m_inline;
+        }
+
+        // 
+        void _initInline()
+        {
+            m_len = 0;
+            m_isHeap = false;
+            m_inArena = false;
+            memset(m_inline, 0, sizeof(m_inline));
+        }
+
         void _copy(const char* pData, size_t n)
         {
             // this assumes that storage for n characters has been 
             // allocated
-            assert(m_capacity >= n);
+            assert(capacity() >= n);
+            StorageUnit* pDst = _data();
             for(size_t i = 0; i < n; ++i)
-                s_codec.store(m_data, i, pData[i]);
+                s_codec.store(pDst, i, pData[i]);
             m_len = n;
         }
         
@@ -233,26 +308,28 @@ class EncodedString
         void _copy(const EncodedString& other)
         {
             // storage should have been allocated already
-            assert(m_capacity = other.m_capacity);
-            size_t num_units = s_codec.getRequiredUnits(other.m_capacity);
-            _copyUnitData(other.m_data, num_units);
+            assert(capacity() >= other.m_len);
+            size_t num_units = s_codec.getRequiredUnits(other.m_len);
+            _copyUnitData(other._data(), num_units);
             m_len = other.m_len;
         }
 
         // Copy num_units from pData into the internal storage
-        void _copyUnitData(StorageUnit* pData, size_t num_units)
+        void _copyUnitData(const StorageUnit* pData, size_t num_units)
         {
-            assert(s_codec.getRequiredUnits(m_capacity) >= num_units);
+            assert(s_codec.getRequiredUnits(capacity()) >= num_units);
+            StorageUnit* pDst = _data();
             for(size_t i = 0; i < num_units; ++i)
-                m_data[i] = pData[i];
+                pDst[i] = pData[i];
         }
 
         // append n symbols from pData into the buffer
         void _append(const char* pData, size_t n)
         {
-            assert(m_len + n <= m_capacity);
+            assert(m_len + n <= capacity());
+            StorageUnit* pDst = _data();
             for(size_t i = 0; i < n; ++i)
-                s_codec.store(m_data, m_len + i, pData[i]);
+                s_codec.store(pDst, m_len + i, pData[i]);
             m_len += n;
         }
 
@@ -260,49 +337,76 @@ class EncodedString
         void _append(const EncodedString& other)
         {
             size_t n = other.m_len;
-            assert(m_len + n <= m_capacity);
+            assert(m_len + n <= capacity());
+            StorageUnit* pDst = _data();
             for(size_t i = 0; i < n; ++i)
-                s_codec.store(m_data, m_len + i, other.get(i));
+                s_codec.store(pDst, m_len + i, other.get(i));
             m_len += n;
         }
 
-        // allocate storage for n symbols
-        void _alloc(size_t n)
+        // allocate storage for n symbols, from pArena if it is not NULL
+        void _alloc(size_t n, Arena* pArena)
         {
+            _initInline();
+            if(n <= _getInlineCapacity())
+                return;
+
             // Get the number of units that need to be allocated from the codec
             size_t n_units = s_codec.getRequiredUnits(n);
-            m_data = new StorageUnit[n_units](); // This zeros the memory
-            m_capacity = s_codec.getCapacity(n_units);
+            size_t n_bytes = n_units * sizeof(StorageUnit);
+            if(pArena != NULL && n_bytes <= Arena::MAX_OBJECT_SIZE)
+            {
+                m_heap.pData = (StorageUnit*)pArena->alloc(n_bytes);
+                memset(m_heap.pData, 0, n_bytes);
+                m_inArena = true;
+            }
+            else
+            {
+                m_heap.pData = new StorageUnit[n_units](); // This zeros the memory
+            }
+            m_heap.capacity = s_codec.getCapacity(n_units);
+            m_isHeap = true;
         }
 
         // reallocate the storage so that the capacity is at least n symbols
-        // m_len is not changed
+        // m_len is not changed. Storage from an arena is reallocated from the same arena.
         void _realloc(size_t n)
         {
-            StorageUnit* oldData = m_data;
-            size_t old_units = s_codec.getRequiredUnits(m_len);
-            _alloc(n);
-            assert(m_capacity >= n);
-
-            _copyUnitData(oldData, old_units);
-            delete [] oldData;
+            Arena* pArena = m_inArena ? Arena::getOwner(m_heap.pData) : NULL;
+            EncodedString tmp;
+            tmp._alloc(n, pArena);
+            assert(tmp.capacity() >= n);
+
+            tmp._copyUnitData(_data(), s_codec.getRequiredUnits(m_len));
+            tmp.m_len = m_len;
+            swap(tmp);
         }
 
         // deallocate storage
         void _dealloc()
         {
-            if(m_data != NULL)
-                delete [] m_data;
-            m_data = 0;
-            m_len = 0;
-            m_capacity = 0;
+            if(m_isHeap)
+            {
+                if(m_inArena)
+                    Arena::dealloc(m_heap.pData);
+                else
+                    delete [] m_heap.pData;
+            }
+            _initInline();
         }
 
         // data
         static Codec s_codec;
-        size_t m_len; // the length of the string
-        size_t m_capacity; // the maximum length of the string that can be stored
-        StorageUnit* m_data;
+        size_t m_len:62; // the length of the string
+        size_t m_isHeap:1; // true if the string is stored in m_heap
+        size_t m_inArena:1; // true if m_heap.pData was allocated from an arena
+
+        // Short strings are stored in m_inline, otherwise m_heap describes the storage
+        union
+        {
+            HeapStorage m_heap;
+            StorageUnit m_inline[INLINE_UNITS];
+        };
 };
 
 // Initialize the static member
@@ -0,0 +1,233 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// HardwareCounters - Per-thread access to the CPU
+// performance counters through perf_event_open.
+//
+#include <string.h>
+#include "HardwareCounters.h"
+#include "config.h"
+
+#if HAVE_LINUX_PERF_EVENT_H
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace HardwareCounters
+{
+
+static const char* COUNTER_NAMES[NUM_COUNTERS] = { "cycles", "instructions", "llc_misses", "dtlb_misses" };
+static bool s_available[NUM_COUNTERS] = { false, false, false, false };
+
+//
+bool isAvailable(int counter)
+{
+    return s_available[counter];
+}
+
+//
+const char* getName(int counter)
+{
+    return COUNTER_NAMES[counter];
+}
+
+#if HAVE_LINUX_PERF_EVENT_H
+
+// The counters of a thread are opened as a single group so they
+// are scheduled together and can be read with one system call.
+// The group leader is the first counter that could be opened and
+// position maps each counter to its slot in the group, or -1.
+struct ThreadCounters
+{
+    int groupFd;
+    int numOpen;
+    int fds[NUM_COUNTERS];
+    int position[NUM_COUNTERS];
+};
+
+// The descriptors are closed by the key destructor when the thread
+// exits, or by shutdown(). After that the thread reads zeros.
+static __thread bool t_opened = false;
+static __thread ThreadCounters* t_pCounters = NULL;
+static pthread_key_t s_threadKey;
+static pthread_once_t s_threadKeyOnce = PTHREAD_ONCE_INIT;
+
+//
+static int openCounter(int counter, int groupFd)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch(counter)
+    {
+        case HC_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case HC_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case HC_LLC_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case HC_DTLB_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        default:
+            return -1;
+    }
+    return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+// Close the descriptors of one thread. The members of the group
+// are closed before the leader.
+static void closeThreadCounters(void* pArg)
+{
+    ThreadCounters* pCounters = (ThreadCounters*)pArg;
+    for(int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        if(pCounters->fds[i] >= 0 && pCounters->fds[i] != pCounters->groupFd)
+            close(pCounters->fds[i]);
+    }
+
+    if(pCounters->groupFd >= 0)
+        close(pCounters->groupFd);
+    delete pCounters;
+
+    if(t_pCounters == pCounters)
+        t_pCounters = NULL;
+}
+
+//
+static void createThreadKey()
+{
+    pthread_key_create(&s_threadKey, closeThreadCounters);
+}
+
+// Open the counters for the calling thread. If onlyAvailable is
+// true, the counters that could not be opened by initialize() are skipped
+static void openThreadCounters(bool onlyAvailable)
+{
+    t_opened = true;
+
+    ThreadCounters* pCounters = new ThreadCounters;
+    pCounters->groupFd = -1;
+    pCounters->numOpen = 0;
+    for(int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        pCounters->fds[i] = -1;
+        pCounters->position[i] = -1;
+        if(onlyAvailable && !s_available[i])
+            continue;
+
+        int fd = openCounter(i, pCounters->groupFd);
+        if(fd < 0)
+            continue;
+
+        if(pCounters->groupFd < 0)
+            pCounters->groupFd = fd;
+        pCounters->fds[i] = fd;
+        pCounters->position[i] = pCounters->numOpen++;
+    }
+
+    if(pCounters->groupFd < 0)
+    {
+        delete pCounters;
+        return;
+    }
+
+    pthread_once(&s_threadKeyOnce, createThreadKey);
+    pthread_setspecific(s_threadKey, pCounters);
+    t_pCounters = pCounters;
+}
+
+//
+bool initialize()
+{
+    openThreadCounters(false);
+    bool any = false;
+    for(int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        s_available[i] = t_pCounters != NULL && t_pCounters->position[i] >= 0;
+        any = any || s_available[i];
+    }
+    return any;
+}
+
+//
+void shutdown()
+{
+    t_opened = true;
+    if(t_pCounters == NULL)
+        return;
+
+    pthread_setspecific(s_threadKey, NULL);
+    closeThreadCounters(t_pCounters);
+}
+
+//
+void read(uint64_t values[NUM_COUNTERS])
+{
+    memset(values, 0, sizeof(uint64_t) * NUM_COUNTERS);
+    if(!t_opened)
+        openThreadCounters(true);
+
+    const ThreadCounters* pCounters = t_pCounters;
+    if(pCounters == NULL)
+        return;
+
+    // The group layout is the number of counters, the time enabled,
+    // the time running, then one value per counter
+    uint64_t buffer[3 + NUM_COUNTERS];
+    ssize_t bytes = ::read(pCounters->groupFd, buffer, sizeof(buffer));
+    if(bytes < (ssize_t)(sizeof(uint64_t) * (3 + pCounters->numOpen)))
+        return;
+
+    double scale = 1.0;
+    if(buffer[2] > 0 && buffer[2] < buffer[1])
+        scale = (double)buffer[1] / buffer[2];
+
+    for(int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        if(pCounters->position[i] >= 0)
+            values[i] = (uint64_t)(buffer[3 + pCounters->position[i]] * scale);
+    }
+}
+
+#else
+
+//
+bool initialize()
+{
+    return false;
+}
+
+//
+void shutdown()
+{
+
+}
+
+//
+void read(uint64_t values[NUM_COUNTERS])
+{
+    memset(values, 0, sizeof(uint64_t) * NUM_COUNTERS);
+}
+
+#endif
+
+};
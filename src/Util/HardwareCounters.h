@@ -0,0 +1,56 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// HardwareCounters - Per-thread access to the CPU
+// performance counters through perf_event_open.
+// Used by the Profiler to attribute cycles, instructions,
+// cache and TLB misses to the instrumented scopes.
+//
+// The counters are optional. If the kernel interface
+// is missing or access is denied (see
+// /proc/sys/kernel/perf_event_paranoid) the unavailable
+// counters always read as zero.
+//
+#ifndef HARDWARECOUNTERS_H
+#define HARDWARECOUNTERS_H
+
+#include <stdint.h>
+
+namespace HardwareCounters
+{
+
+enum CounterType
+{
+    HC_CYCLES,
+    HC_INSTRUCTIONS,
+    HC_LLC_MISSES,
+    HC_DTLB_MISSES,
+    NUM_COUNTERS
+};
+
+// Probe which counters can be opened on this system, from the
+// calling thread. Returns true if at least one is available.
+bool initialize();
+
+// Close the counters of the calling thread. The counters of the
+// other threads are closed when those threads exit. After this
+// call the calling thread reads zeros.
+void shutdown();
+
+// Returns true if the counter could be opened by initialize()
+bool isAvailable(int counter);
+
+// Returns the name of the counter, as used in the JSON output
+const char* getName(int counter);
+
+// Read the current values of the counters for the calling thread,
+// opening them on first use. The values are scaled to account for
+// the time the kernel multiplexed the counters off the CPU.
+void read(uint64_t values[NUM_COUNTERS]);
+
+};
+
+#endif
@@ -0,0 +1,304 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// MemoryPolicy - Placement of the large, read-mostly
+// arrays of the FM-index and of the worker threads.
+//
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "MemoryPolicy.h"
+#include "Profiler.h"
+#include "config.h"
+
+#if HAVE_LINUX_MEMPOLICY_H
+#include <linux/mempolicy.h>
+#endif
+
+namespace MemoryPolicy
+{
+
+static HugePagePolicy s_hugePagePolicy = HPP_NONE;
+static NUMAPolicy s_numaPolicy = NUMA_LOCAL;
+static bool s_pinThreads = false;
+
+// The processors the process may run on, for pinning
+static std::vector<int> s_cpus;
+
+// Bitmask of the online NUMA nodes, for interleaving
+static const int MAX_NUMA_NODES = 1024;
+static unsigned long s_nodeMask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+static int s_numNodes = 0;
+
+// Each warning is only printed once
+static int s_warnedHugeTLB = 0;
+static int s_warnedInterleave = 0;
+static int s_warnedPin = 0;
+
+//
+bool parseHugePagePolicy(const std::string& name, HugePagePolicy& outPolicy)
+{
+    if(name == "none")
+        outPolicy = HPP_NONE;
+    else if(name == "transparent")
+        outPolicy = HPP_TRANSPARENT;
+    else if(name == "explicit")
+        outPolicy = HPP_EXPLICIT;
+    else
+        return false;
+    return true;
+}
+
+//
+bool parseNUMAPolicy(const std::string& name, NUMAPolicy& outPolicy)
+{
+    if(name == "local")
+        outPolicy = NUMA_LOCAL;
+    else if(name == "interleave")
+        outPolicy = NUMA_INTERLEAVE;
+    else
+        return false;
+    return true;
+}
+
+//
+void setHugePagePolicy(HugePagePolicy policy)
+{
+    s_hugePagePolicy = policy;
+}
+
+// Read the online nodes from sysfs. The list is a comma-separated
+// set of ranges, like 0-1,4
+static void readOnlineNodes()
+{
+    memset(s_nodeMask, 0, sizeof(s_nodeMask));
+    s_numNodes = 0;
+
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string line;
+    if(!in || !std::getline(in, line))
+        return;
+
+    std::stringstream parser(line);
+    std::string range;
+    while(std::getline(parser, range, ','))
+    {
+        int first = 0;
+        int last = 0;
+        size_t dash = range.find('-');
+        first = atoi(range.substr(0, dash).c_str());
+        last = dash == std::string::npos ? first : atoi(range.substr(dash + 1).c_str());
+        for(int node = first; node <= last && node < MAX_NUMA_NODES; ++node)
+        {
+            s_nodeMask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            s_numNodes += 1;
+        }
+    }
+}
+
+//
+void setNUMAPolicy(NUMAPolicy policy)
+{
+    s_numaPolicy = policy;
+    if(policy == NUMA_INTERLEAVE)
+    {
+        readOnlineNodes();
+        if(s_numNodes < 2)
+            std::cerr << "Warning: only one NUMA node is online, interleaving has no effect\n";
+    }
+}
+
+//
+void setPinThreads(bool pin)
+{
+    s_pinThreads = pin;
+    s_cpus.clear();
+    if(!pin)
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) != 0)
+    {
+        std::cerr << "Warning: could not get the processor affinity, threads will not be pinned\n";
+        s_pinThreads = false;
+        return;
+    }
+
+    for(int i = 0; i < CPU_SETSIZE; ++i)
+    {
+        if(CPU_ISSET(i, &set))
+            s_cpus.push_back(i);
+    }
+}
+
+//
+HugePagePolicy getHugePagePolicy()
+{
+    return s_hugePagePolicy;
+}
+
+//
+NUMAPolicy getNUMAPolicy()
+{
+    return s_numaPolicy;
+}
+
+//
+bool getPinThreads()
+{
+    return s_pinThreads;
+}
+
+//
+std::string getDescription()
+{
+    static const char* HUGE_PAGE_NAMES[] = { "none", "transparent", "explicit" };
+    static const char* NUMA_NAMES[] = { "local", "interleave" };
+    std::stringstream ss;
+    ss << "hugepages=" << HUGE_PAGE_NAMES[s_hugePagePolicy];
+    ss << " numa=" << NUMA_NAMES[s_numaPolicy];
+    ss << " pin-threads=" << (s_pinThreads ? "yes" : "no");
+    return ss.str();
+}
+
+// Returns true if an allocation of this size is mapped directly
+static bool isMapped(size_t bytes)
+{
+    return bytes >= MIN_MAPPED_BYTES && (s_hugePagePolicy != HPP_NONE || s_numaPolicy != NUMA_LOCAL);
+}
+
+// The length of the mapping for an allocation
+static size_t getMappedLength(size_t bytes)
+{
+    return (bytes + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1);
+}
+
+// Map length bytes aligned to a huge page boundary, so
+// that the whole range is eligible for huge pages
+static void* mapAligned(size_t length)
+{
+    size_t padded = length + HUGE_PAGE_BYTES;
+    void* p = mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p == MAP_FAILED)
+        return NULL;
+
+    // Unmap the unaligned head and the tail of the mapping
+    uintptr_t start = (uintptr_t)p;
+    uintptr_t aligned = (start + HUGE_PAGE_BYTES - 1) & ~(uintptr_t)(HUGE_PAGE_BYTES - 1);
+    if(aligned > start)
+        munmap(p, aligned - start);
+    uintptr_t end = start + padded;
+    if(end > aligned + length)
+        munmap((void*)(aligned + length), end - (aligned + length));
+    return (void*)aligned;
+}
+
+//
+static void interleavePages(void* p, size_t length)
+{
+#if HAVE_LINUX_MEMPOLICY_H && defined(SYS_mbind)
+    if(s_numNodes < 2)
+        return;
+
+    long ret = syscall(SYS_mbind, p, length, MPOL_INTERLEAVE, s_nodeMask, (unsigned long)MAX_NUMA_NODES, 0);
+    if(ret != 0 && __sync_bool_compare_and_swap(&s_warnedInterleave, 0, 1))
+        std::cerr << "Warning: could not interleave memory across the NUMA nodes\n";
+#else
+    (void)p;
+    (void)length;
+    if(__sync_bool_compare_and_swap(&s_warnedInterleave, 0, 1))
+        std::cerr << "Warning: NUMA interleaving is not supported on this system\n";
+#endif
+}
+
+//
+void* allocate(size_t bytes)
+{
+    if(!isMapped(bytes))
+    {
+        void* p = malloc(bytes);
+        if(p == NULL && bytes > 0)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    size_t length = getMappedLength(bytes);
+    void* p = NULL;
+    bool isHugeTLB = false;
+
+#ifdef MAP_HUGETLB
+    if(s_hugePagePolicy == HPP_EXPLICIT)
+    {
+        p = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(p == MAP_FAILED)
+            p = NULL;
+        isHugeTLB = p != NULL;
+    }
+#endif
+
+    if(s_hugePagePolicy == HPP_EXPLICIT && !isHugeTLB && __sync_bool_compare_and_swap(&s_warnedHugeTLB, 0, 1))
+        std::cerr << "Warning: the reserved huge page pool is exhausted or unavailable, using transparent huge pages\n";
+
+    if(p == NULL)
+        p = mapAligned(length);
+    if(p == NULL)
+        throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+    if(s_hugePagePolicy != HPP_NONE && !isHugeTLB)
+        madvise(p, length, MADV_HUGEPAGE);
+#endif
+
+    // The policy must be applied before the pages are first touched
+    if(s_numaPolicy == NUMA_INTERLEAVE)
+        interleavePages(p, length);
+
+    PROFILE_MEMORY("MemoryPolicy::mapped", (int64_t)length);
+    return p;
+}
+
+//
+void deallocate(void* ptr, size_t bytes)
+{
+    if(ptr == NULL)
+        return;
+
+    if(!isMapped(bytes))
+    {
+        free(ptr);
+        return;
+    }
+
+    size_t length = getMappedLength(bytes);
+    munmap(ptr, length);
+    PROFILE_MEMORY("MemoryPolicy::mapped", -(int64_t)length);
+}
+
+//
+void pinThread(int idx)
+{
+    if(!s_pinThreads || idx < 0 || s_cpus.empty())
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(s_cpus[idx % s_cpus.size()], &set);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if(ret != 0 && __sync_bool_compare_and_swap(&s_warnedPin, 0, 1))
+        std::cerr << "Warning: could not pin thread " << idx << " to processor " << s_cpus[idx % s_cpus.size()] << "\n";
+}
+
+};
@@ -0,0 +1,131 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// MemoryPolicy - Placement of the large, read-mostly
+// arrays of the FM-index (the run-length BWT string,
+// the occurrence markers, the sampled suffix array and
+// the interval cache) and of the worker threads.
+//
+// The rank queries made during the FM-index searches
+// touch these arrays at random, so on large indices
+// nearly every access misses the TLB. Backing the arrays
+// with huge pages reduces these misses. On multi-socket
+// machines the arrays are otherwise placed on the node
+// of the thread that loaded them; interleaving the pages
+// across the nodes spreads the load over all the memory
+// controllers.
+//
+// The policy must be set before any index is loaded, as
+// memory is released according to the policy in effect.
+// With the default policy the arrays are allocated with
+// malloc, as with std::allocator.
+//
+#ifndef MEMORYPOLICY_H
+#define MEMORYPOLICY_H
+
+#include <stddef.h>
+#include <string>
+#include <new>
+
+namespace MemoryPolicy
+{
+
+enum HugePagePolicy
+{
+    HPP_NONE,        // regular pages
+    HPP_TRANSPARENT, // request transparent huge pages with madvise
+    HPP_EXPLICIT     // use the reserved huge page pool (MAP_HUGETLB), falling back to transparent huge pages
+};
+
+enum NUMAPolicy
+{
+    NUMA_LOCAL,     // pages are placed on the node that first touches them
+    NUMA_INTERLEAVE // pages are interleaved across all the nodes
+};
+
+// Allocations smaller than this are made with malloc regardless of the policy
+static const size_t MIN_MAPPED_BYTES = 4 * 1024 * 1024;
+
+// The size and alignment of the memory mappings
+static const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+// Parse the name of a policy, returning false if it is not recognized
+bool parseHugePagePolicy(const std::string& name, HugePagePolicy& outPolicy);
+bool parseNUMAPolicy(const std::string& name, NUMAPolicy& outPolicy);
+
+//
+void setHugePagePolicy(HugePagePolicy policy);
+void setNUMAPolicy(NUMAPolicy policy);
+void setPinThreads(bool pin);
+
+//
+HugePagePolicy getHugePagePolicy();
+NUMAPolicy getNUMAPolicy();
+bool getPinThreads();
+
+// Returns a description of the current settings
+std::string getDescription();
+
+// Allocate and free memory according to the current policy
+void* allocate(size_t bytes);
+void deallocate(void* ptr, size_t bytes);
+
+// Pin the calling thread to the idx-th processor the process is
+// allowed to run on, wrapping around if there are more threads
+// than processors. Does nothing if pinning is disabled or idx < 0.
+void pinThread(int idx);
+
+// STL allocator for the index arrays
+template<typename T>
+class IndexAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef IndexAllocator<U> other;
+        };
+
+        IndexAllocator() {}
+        IndexAllocator(const IndexAllocator&) {}
+        template<typename U> IndexAllocator(const IndexAllocator<U>&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void* = 0)
+        {
+            return static_cast<pointer>(MemoryPolicy::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            MemoryPolicy::deallocate(p, n * sizeof(T));
+        }
+
+        size_type max_size() const { return (size_type)-1 / sizeof(T); }
+        void construct(pointer p, const T& val) { new(p) T(val); }
+        void destroy(pointer p) { p->~T(); }
+};
+
+// All allocators share the same policy so memory from one can be freed by any other
+template<typename T, typename U>
+inline bool operator==(const IndexAllocator<T>&, const IndexAllocator<U>&) { return true; }
+
+template<typename T, typename U>
+inline bool operator!=(const IndexAllocator<T>&, const IndexAllocator<U>&) { return false; }
+
+};
+
+#endif
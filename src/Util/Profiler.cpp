@@ -0,0 +1,418 @@
+///----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL
+//-----------------------------------------------
+//
+// Profiler.cpp -- Lightweight registry of named counters,
+// histograms and scoped timers.
+//
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "Profiler.h"
+
+namespace Profiler
+{
+
+// A registered metric
+struct MetricInfo
+{
+    std::string name;
+    MetricType type;
+};
+
+// Global registry state. The lock protects the metric table and the
+// list of thread storage; the metric values themselves are only written
+// by the thread that owns them.
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static MetricInfo s_metrics[MAX_METRICS];
+static int s_numMetrics = 0;
+static std::vector<ThreadData*>* s_pThreadData = NULL;
+static ThreadData* s_pExitedData = NULL;
+static pthread_key_t s_threadKey;
+static pthread_once_t s_threadKeyOnce = PTHREAD_ONCE_INIT;
+static volatile int64_t s_memoryCurrent[MAX_METRICS];
+static volatile int64_t s_memoryPeak[MAX_METRICS];
+static std::string s_outFile;
+
+__thread ThreadData* t_pThreadData = NULL;
+volatile int g_dumpRequested = 0;
+bool g_enabled = false;
+bool g_countersEnabled = false;
+
+//
+int registerMetric(const std::string& name, MetricType type)
+{
+    pthread_mutex_lock(&s_lock);
+    int id = -1;
+    for(int i = 0; i < s_numMetrics; ++i)
+    {
+        if(s_metrics[i].name == name)
+        {
+            id = i;
+            break;
+        }
+    }
+
+    if(id == -1)
+    {
+        if(s_numMetrics == MAX_METRICS)
+        {
+            std::cerr << "Error: too many profiler metrics registered, increase Profiler::MAX_METRICS\n";
+            exit(EXIT_FAILURE);
+        }
+        id = s_numMetrics++;
+        s_metrics[id].name = name;
+        s_metrics[id].type = type;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return id;
+}
+
+// Add the values of one thread to a total
+static void accumulateMetric(MetricData& total, const MetricData& m)
+{
+    if(m.count == 0)
+        return;
+    if(total.count == 0 || m.min < total.min)
+        total.min = m.min;
+    if(m.max > total.max)
+        total.max = m.max;
+    total.count += m.count;
+    total.sum += m.sum;
+    for(int k = 0; k < NUM_HISTOGRAM_BINS; ++k)
+        total.bins[k] += m.bins[k];
+    for(int k = 0; k < HardwareCounters::NUM_COUNTERS; ++k)
+        total.counters[k] += m.counters[k];
+}
+
+// Called when a thread that allocated storage exits. Its values are
+// moved to the exited thread total so they are kept in the output
+static void releaseThreadData(void* pArg)
+{
+    ThreadData* pData = (ThreadData*)pArg;
+
+    pthread_mutex_lock(&s_lock);
+    if(s_pExitedData == NULL)
+        s_pExitedData = (ThreadData*)calloc(1, sizeof(ThreadData));
+
+    if(s_pExitedData != NULL)
+    {
+        for(int i = 0; i < s_numMetrics; ++i)
+            accumulateMetric(s_pExitedData->metrics[i], pData->metrics[i]);
+    }
+
+    std::vector<ThreadData*>::iterator iter = std::find(s_pThreadData->begin(), s_pThreadData->end(), pData);
+    if(iter != s_pThreadData->end())
+        s_pThreadData->erase(iter);
+    pthread_mutex_unlock(&s_lock);
+
+    t_pThreadData = NULL;
+    free(pData);
+}
+
+//
+static void createThreadKey()
+{
+    pthread_key_create(&s_threadKey, releaseThreadData);
+}
+
+//
+ThreadData* allocateThreadData()
+{
+    ThreadData* pData = (ThreadData*)calloc(1, sizeof(ThreadData));
+    if(pData == NULL)
+    {
+        std::cerr << "Error: could not allocate profiler storage\n";
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if(s_pThreadData == NULL)
+        s_pThreadData = new std::vector<ThreadData*>;
+    s_pThreadData->push_back(pData);
+    pthread_mutex_unlock(&s_lock);
+
+    pthread_once(&s_threadKeyOnce, createThreadKey);
+    pthread_setspecific(s_threadKey, pData);
+    t_pThreadData = pData;
+    return pData;
+}
+
+//
+void addMemory(int id, int64_t delta)
+{
+    int64_t current = __sync_add_and_fetch(&s_memoryCurrent[id], delta);
+    int64_t peak = s_memoryPeak[id];
+    while(current > peak && !__sync_bool_compare_and_swap(&s_memoryPeak[id], peak, current))
+        peak = s_memoryPeak[id];
+}
+
+//
+void addCounters(int id, const uint64_t start[HardwareCounters::NUM_COUNTERS])
+{
+    uint64_t end[HardwareCounters::NUM_COUNTERS];
+    HardwareCounters::read(end);
+
+    // The scaling of multiplexed counters is an estimate so
+    // successive readings are not guaranteed to increase
+    MetricData& m = getThreadData()->metrics[id];
+    for(int k = 0; k < HardwareCounters::NUM_COUNTERS; ++k)
+    {
+        if(end[k] > start[k])
+            m.counters[k] += end[k] - start[k];
+    }
+}
+
+// Sum the values of metric i over all threads. Must be called with the lock held
+static void sumMetric(int i, MetricData& total)
+{
+    memset(&total, 0, sizeof(total));
+    size_t numThreads = s_pThreadData != NULL ? s_pThreadData->size() : 0;
+    for(size_t j = 0; j < numThreads; ++j)
+        accumulateMetric(total, (*s_pThreadData)[j]->metrics[i]);
+    if(s_pExitedData != NULL)
+        accumulateMetric(total, s_pExitedData->metrics[i]);
+}
+
+//
+bool getTotal(const std::string& name, uint64_t& outValue)
+{
+    bool found = false;
+    pthread_mutex_lock(&s_lock);
+    for(int i = 0; i < s_numMetrics; ++i)
+    {
+        if(s_metrics[i].name != name)
+            continue;
+
+        if(s_metrics[i].type == MT_MEMORY)
+        {
+            outValue = s_memoryPeak[i];
+        }
+        else
+        {
+            MetricData total;
+            sumMetric(i, total);
+            outValue = total.sum;
+        }
+        found = true;
+        break;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return found;
+}
+
+//
+uint64_t getTimeNS()
+{
+#if HAVE_CLOCK_GETTIME
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#else
+    timeval now;
+    gettimeofday(&now, NULL);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_usec * 1000;
+#endif
+}
+
+// Write a string as a JSON string literal
+static void writeJSONString(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for(size_t i = 0; i < str.size(); ++i)
+    {
+        if(str[i] == '"' || str[i] == '\\')
+            out << '\\';
+        out << str[i];
+    }
+    out << '"';
+}
+
+// Write the available hardware counters of a metric as JSON fields
+static void writeCounters(std::ostream& out, const MetricData& m)
+{
+    bool first = true;
+    for(int k = 0; k < HardwareCounters::NUM_COUNTERS; ++k)
+    {
+        if(!HardwareCounters::isAvailable(k))
+            continue;
+        out << (first ? "" : ", ") << "\"" << HardwareCounters::getName(k) << "\": " << m.counters[k];
+        first = false;
+    }
+
+    uint64_t cycles = m.counters[HardwareCounters::HC_CYCLES];
+    if(HardwareCounters::isAvailable(HardwareCounters::HC_INSTRUCTIONS) && cycles > 0)
+        out << ", \"ipc\": " << (double)m.counters[HardwareCounters::HC_INSTRUCTIONS] / cycles;
+}
+
+//
+void writeJSON(std::ostream& out)
+{
+    static const char* TYPE_NAMES[] = { "counter", "histogram", "timer", "memory" };
+
+    pthread_mutex_lock(&s_lock);
+    out << "{\n";
+    if(g_countersEnabled)
+    {
+        out << "  \"hardware_counters\": [";
+        bool first = true;
+        for(int k = 0; k < HardwareCounters::NUM_COUNTERS; ++k)
+        {
+            if(!HardwareCounters::isAvailable(k))
+                continue;
+            out << (first ? "" : ", ") << "\"" << HardwareCounters::getName(k) << "\"";
+            first = false;
+        }
+        out << "],\n";
+    }
+
+    out << "  \"metrics\": {";
+    for(int i = 0; i < s_numMetrics; ++i)
+    {
+        // Sum the values over all threads
+        MetricData total;
+        sumMetric(i, total);
+
+        out << (i > 0 ? ",\n    " : "\n    ");
+        writeJSONString(out, s_metrics[i].name);
+        out << ": { \"type\": \"" << TYPE_NAMES[s_metrics[i].type] << "\", ";
+        if(s_metrics[i].type == MT_MEMORY)
+        {
+            out << "\"current_bytes\": " << s_memoryCurrent[i] << ", \"peak_bytes\": " << s_memoryPeak[i] << " }";
+            continue;
+        }
+
+        if(s_metrics[i].type == MT_COUNTER)
+        {
+            out << "\"updates\": " << total.count << ", \"value\": " << total.sum << " }";
+            continue;
+        }
+
+        // Timers are recorded in nanoseconds
+        const char* suffix = s_metrics[i].type == MT_TIMER ? "_ns" : "";
+        double mean = total.count > 0 ? (double)total.sum / total.count : 0.0;
+        out << "\"count\": " << total.count << ", ";
+        out << "\"total" << suffix << "\": " << total.sum << ", ";
+        out << "\"min" << suffix << "\": " << total.min << ", ";
+        out << "\"max" << suffix << "\": " << total.max << ", ";
+        out << "\"mean" << suffix << "\": " << mean << ", ";
+
+        // Write the non-empty bins as [lower bound, count] pairs
+        out << "\"histogram\": [";
+        bool first = true;
+        for(int k = 0; k < NUM_HISTOGRAM_BINS; ++k)
+        {
+            if(total.bins[k] == 0)
+                continue;
+            uint64_t lower = k == 0 ? 0 : (uint64_t)1 << (k - 1);
+            out << (first ? "" : ", ") << "[" << lower << ", " << total.bins[k] << "]";
+            first = false;
+        }
+        out << "]";
+
+        // The hardware counters are reported in total and for each thread that ran the scope
+        if(s_metrics[i].type == MT_TIMER && g_countersEnabled)
+        {
+            out << ", \"hardware\": { ";
+            writeCounters(out, total);
+            out << ", \"per_thread\": [";
+            first = true;
+            for(size_t j = 0; s_pThreadData != NULL && j < s_pThreadData->size(); ++j)
+            {
+                const MetricData& m = (*s_pThreadData)[j]->metrics[i];
+                if(m.count == 0)
+                    continue;
+                out << (first ? "" : ", ") << "{ \"thread\": " << j << ", \"count\": " << m.count << ", ";
+                writeCounters(out, m);
+                out << " }";
+                first = false;
+            }
+
+            // The threads that have exited are reported together
+            if(s_pExitedData != NULL && s_pExitedData->metrics[i].count > 0)
+            {
+                const MetricData& m = s_pExitedData->metrics[i];
+                out << (first ? "" : ", ") << "{ \"thread\": \"exited\", \"count\": " << m.count << ", ";
+                writeCounters(out, m);
+                out << " }";
+            }
+            out << "] }";
+        }
+        out << " }";
+    }
+    out << "\n  }\n}\n";
+    pthread_mutex_unlock(&s_lock);
+}
+
+//
+void writeJSON(const std::string& filename)
+{
+    std::ofstream out(filename.c_str());
+    if(!out)
+    {
+        std::cerr << "Warning: could not write profile to " << filename << "\n";
+        return;
+    }
+    writeJSON(out);
+}
+
+//
+void handleDumpRequest()
+{
+    // Only one thread writes the requested dump
+    if(__sync_bool_compare_and_swap(&g_dumpRequested, 1, 0) && !s_outFile.empty())
+        writeJSON(s_outFile);
+}
+
+//
+static void dumpSignalHandler(int)
+{
+    g_dumpRequested = 1;
+}
+
+//
+static void dumpAtExit()
+{
+    writeJSON(s_outFile);
+}
+
+//
+void enable()
+{
+    g_enabled = true;
+}
+
+//
+void initialize()
+{
+    const char* counters = getenv("SGA_PROFILE_COUNTERS");
+    if(counters != NULL && counters[0] != '\0' && strcmp(counters, "0") != 0)
+    {
+        g_countersEnabled = HardwareCounters::initialize();
+        if(g_countersEnabled)
+            atexit(HardwareCounters::shutdown);
+        else
+            std::cerr << "Warning: hardware performance counters are not available, check /proc/sys/kernel/perf_event_paranoid\n";
+    }
+
+    const char* filename = getenv("SGA_PROFILE_FILE");
+    if(filename == NULL || filename[0] == '\0')
+        return;
+
+    enable();
+    s_outFile = filename;
+    atexit(dumpAtExit);
+    signal(SIGUSR1, dumpSignalHandler);
+}
+
+};
@@ -4,67 +4,205 @@
 // Released under the GPL
 //-----------------------------------------------
 //
-// Profiler.h -- Lightweight macro-based function profiler.
+// Profiler.h -- Lightweight registry of named counters,
+// histograms and scoped timers.
+//
+// Each metric is registered once by name and identified by
+// a small integer. Updates go to storage owned by the calling
+// thread so they do not need atomics or locks. The per-thread
+// values are summed when the registry is written out as JSON.
+// Memory metrics are the exception, as structures may be freed
+// by a different thread than allocated them. These are updated
+// atomically and should only be used for infrequent events.
+//
+// The metrics are only recorded when profiling has been enabled,
+// either by setting SGA_PROFILE_FILE=FILE in the environment or by
+// the --report-json option. Otherwise each macro costs a test of a
+// global flag. SGA_PROFILE_FILE writes the metrics to FILE at exit
+// and whenever the process receives SIGUSR1.
+// Setting SGA_PROFILE_COUNTERS=1 additionally records the hardware
+// performance counters (see HardwareCounters.h) over each timed scope.
+// This costs a system call at both ends of the scope, so it should
+// only be enabled when investigating the kernels themselves.
 //
 #ifndef PROFILER_H
 #define PROFILER_H
 
-#include <time.h>
-#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <ostream>
 #include "config.h"
+#include "HardwareCounters.h"
+
+namespace Profiler
+{
+
+// The maximum number of distinct metrics that can be registered
+static const int MAX_METRICS = 256;
+
+// Histogram values are binned by their base-2 magnitude. Bin i
+// holds the values in [2^(i-1), 2^i) and bin 0 holds zeros
+static const int NUM_HISTOGRAM_BINS = 65;
+
+enum MetricType
+{
+    MT_COUNTER,
+    MT_HISTOGRAM,
+    MT_TIMER,
+    MT_MEMORY
+};
+
+// The accumulated values of one metric in one thread
+struct MetricData
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t bins[NUM_HISTOGRAM_BINS];
+    uint64_t counters[HardwareCounters::NUM_COUNTERS];
+};
+
+// The storage for all the metrics updated by one thread
+struct ThreadData
+{
+    MetricData metrics[MAX_METRICS];
+};
 
-//#define USE_PROFILER 1
-#if defined(HAVE_CLOCK_GETTIME) && defined(USE_PROFILER)
+// Register a metric, returning its identifier. Registering an
+// existing name returns the identifier of the existing metric.
+int registerMetric(const std::string& name, MetricType type);
 
-// Change this to determine how often the profile should print
-#define PROFILE_TICKS_BEFORE_PRINT 1000
+// Allocate and register the storage for the calling thread. The
+// storage is released when the thread exits, after its values
+// have been added to the total of the exited threads.
+ThreadData* allocateThreadData();
 
-// This class writes the lifespan of the object
-// to the output variable, in nanoseconds
-class TimeTracker
+// Get the storage for the calling thread, allocating it on first use
+extern __thread ThreadData* t_pThreadData;
+inline ThreadData* getThreadData()
+{
+    ThreadData* pData = t_pThreadData;
+    return pData != NULL ? pData : allocateThreadData();
+}
+
+// Returns the current value of a monotonic clock, in nanoseconds
+uint64_t getTimeNS();
+
+// Set when a dump has been requested by a signal. The dump is written by the next
+// scoped timer to finish, as the signal handler itself cannot safely do I/O
+extern volatile int g_dumpRequested;
+void handleDumpRequest();
+
+// Set when the metrics are recorded
+extern bool g_enabled;
+
+// Set when the hardware counters are recorded for the timed scopes
+extern bool g_countersEnabled;
+
+// Add the change in the hardware counters of the calling thread
+// since the start values were read to the timer
+void addCounters(int id, const uint64_t start[HardwareCounters::NUM_COUNTERS]);
+
+// Add n to a counter
+inline void addCount(int id, uint64_t n)
+{
+    MetricData& m = getThreadData()->metrics[id];
+    m.count += 1;
+    m.sum += n;
+}
+
+// Record a value in a histogram
+inline void addValue(int id, uint64_t value)
+{
+    MetricData& m = getThreadData()->metrics[id];
+    if(m.count == 0 || value < m.min)
+        m.min = value;
+    if(value > m.max)
+        m.max = value;
+    m.count += 1;
+    m.sum += value;
+    m.bins[value == 0 ? 0 : 64 - __builtin_clzll(value)] += 1;
+}
+
+// Add delta bytes to a memory metric, updating its peak
+void addMemory(int id, int64_t delta);
+
+// Sum the value of a metric over all threads. For counters and timers
+// this is the total, for memory metrics the peak. Returns false if no
+// metric with this name has been registered.
+bool getTotal(const std::string& name, uint64_t& outValue);
+
+// Record the lifespan of this object in a timer metric
+class ScopedTimer
 {
     public:
-        TimeTracker(size_t & output) : m_output(output)
+        ScopedTimer(int id) : m_id(g_enabled ? id : -1)
         {
-             timespec start;
-             clock_gettime(CLOCK_REALTIME, &start);
-             m_start_ns = start.tv_sec * 1000000000 + start.tv_nsec;
+            if(m_id < 0)
+                return;
+            if(g_countersEnabled)
+                HardwareCounters::read(m_counters);
+            m_start = getTimeNS();
         }
 
-        ~TimeTracker()
+        ~ScopedTimer()
         {
-             timespec end;
-             clock_gettime(CLOCK_REALTIME, &end);
-             size_t end_ns = end.tv_sec * 1000000000 + end.tv_nsec;
-
-             // Update the result using an atomic compare and swap
-             size_t diff = end_ns - m_start_ns;
-             while(!__sync_bool_compare_and_swap(&m_output, m_output, m_output + diff)) {}
+            if(m_id < 0)
+                return;
+            addValue(m_id, getTimeNS() - m_start);
+            if(g_countersEnabled)
+                addCounters(m_id, m_counters);
+            if(g_dumpRequested)
+                handleDumpRequest();
         }
 
     private:
-        size_t m_start_ns;
-        size_t& m_output;
+        int m_id;
+        uint64_t m_start;
+        uint64_t m_counters[HardwareCounters::NUM_COUNTERS];
 };
 
-// Place this macros at the start of the function you wish the profile
-// The static variable updates are done via atomic compare and swaps so
-// the profiling should be threadsafe
-#define PROFILE_FUNC(x) static std::string __profile_name = x; \
-                        static size_t __profile_iterations = 0; \
-                        static size_t __profile_total_nanoseconds = 0; \
-                        double milli_seconds = (double)__profile_total_nanoseconds / 1000000.0f; \
-                        double avg_per_iteration = milli_seconds / __profile_iterations; \
-                        while(!__sync_bool_compare_and_swap(&__profile_iterations, __profile_iterations, __profile_iterations + 1)) { } \
-                        if(__profile_iterations % PROFILE_TICKS_BEFORE_PRINT == 0) \
-                            printf("[Profile] count: %zu time: %.0lf ms avg: %.0lf ms func: %s\n", __profile_iterations, milli_seconds, avg_per_iteration, __profile_name.c_str()); \
-                        TimeTracker __profile_timer(__profile_total_nanoseconds);
-                         
-#else
-
-// Eliminate the macro
-#define PROFILE_FUNC(x)
-
-#endif // #ifdef HAVE_CLOCK_GETTIME
+// Write the metrics, summed over all threads, as a JSON object
+void writeJSON(std::ostream& out);
+
+// Write the metrics to the named file
+void writeJSON(const std::string& filename);
+
+// Start recording the metrics. This must be called before
+// the first metric is updated.
+void enable();
+
+// Read SGA_PROFILE_FILE from the environment. If it is set, enable
+// profiling and install the handlers to write the metrics at exit
+// and on SIGUSR1. If SGA_PROFILE_COUNTERS is also set, enable the
+// hardware counters.
+void initialize();
+
+};
+
+// Helper macros to make the metric identifier unique per call site
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// Place this macro at the start of the function or block you wish to time.
+// The metric is registered once, the first time the line is executed
+#define PROFILE_FUNC(x) static const int PROFILE_CONCAT(__profile_id_, __LINE__) = Profiler::registerMetric(x, Profiler::MT_TIMER); \
+                        Profiler::ScopedTimer PROFILE_CONCAT(__profile_timer_, __LINE__)(PROFILE_CONCAT(__profile_id_, __LINE__));
+
+// Add n to the counter x
+#define PROFILE_COUNT(x, n) do { if(Profiler::g_enabled) { \
+                                     static const int __profile_counter_id = Profiler::registerMetric(x, Profiler::MT_COUNTER); \
+                                     Profiler::addCount(__profile_counter_id, (n)); } } while(0)
+
+// Add delta bytes to the memory metric x. Use a negative delta when the memory is released
+#define PROFILE_MEMORY(x, delta) do { if(Profiler::g_enabled) { \
+                                          static const int __profile_memory_id = Profiler::registerMetric(x, Profiler::MT_MEMORY); \
+                                          Profiler::addMemory(__profile_memory_id, (delta)); } } while(0)
+
+// Record the value v in the histogram x
+#define PROFILE_HISTOGRAM(x, v) do { if(Profiler::g_enabled) { \
+                                         static const int __profile_histogram_id = Profiler::registerMetric(x, Profiler::MT_HISTOGRAM); \
+                                         Profiler::addValue(__profile_histogram_id, (v)); } } while(0)
 
 #endif // #ifndef PROFILER_H
@@ -10,22 +10,35 @@
 #include <algorithm>
 #include "ReadTable.h"
 #include "SeqReader.h"
+#include "Profiler.h"
 
 // Read the sequences from a file
 ReadTable::ReadTable(std::string filename, uint32_t reader_flags)
 {
+    PROFILE_FUNC("ReadTable::load")
     m_pIndex = NULL; // not built by default
     SeqReader reader(filename, reader_flags);
     SeqRecord sr;
+    SeqItem item;
     while(reader.get(sr))
     {
-        addRead(sr.toSeqItem());
+        // The record is refilled by the reader so its fields can be taken
+        item.id.swap(sr.id);
+        item.seq.swap(sr.seq);
+        takeRead(item);
     }
+
+    // Estimate the memory used by the table
+    m_profiledBytes = m_table.capacity() * sizeof(SeqItem);
+    for(size_t i = 0; i < m_table.size(); ++i)
+        m_profiledBytes += m_table[i].id.capacity() + 1 + m_table[i].seq.getMemSize() - sizeof(DNAString);
+    PROFILE_MEMORY("ReadTable", m_profiledBytes);
 }
 
 // 
 ReadTable::~ReadTable()
 {
+    PROFILE_MEMORY("ReadTable", -m_profiledBytes);
     if(m_pIndex != NULL)
         delete m_pIndex;
 }
@@ -39,7 +52,7 @@ void ReadTable::initializeReverse(const ReadTable* pRT)
     {
         SeqItem read = pRT->getRead(i);
         read.seq.reverse();
-        addRead(read);
+        takeRead(read);
     }
 }
 
@@ -53,7 +66,34 @@ void ReadTable::reverseAll()
 //
 void ReadTable::addRead(const SeqItem& r)
 {
-    m_table.push_back(r);
+    reserveForAppend();
+    m_table.push_back(SeqItem());
+    m_table.back().id = r.id;
+    m_table.back().seq.assign(r.seq, &m_arena);
+}
+
+//
+void ReadTable::takeRead(SeqItem& r)
+{
+    reserveForAppend();
+    m_table.push_back(SeqItem());
+    m_table.back().id.swap(r.id);
+    m_table.back().seq.assign(r.seq, &m_arena);
+    DNAString().swap(r.seq);
+}
+
+//
+void ReadTable::reserveForAppend()
+{
+    if(m_table.size() < m_table.capacity())
+        return;
+
+    ReadVector grown;
+    grown.reserve(m_table.empty() ? 1024 : 2 * m_table.capacity());
+    grown.resize(m_table.size());
+    for(size_t i = 0; i < m_table.size(); ++i)
+        grown[i].swap(m_table[i]);
+    m_table.swap(grown);
 }
 
 //
@@ -127,6 +167,8 @@ size_t ReadTable::countSumLengths() const
 //
 void ReadTable::clear()
 {
+    PROFILE_MEMORY("ReadTable", -m_profiledBytes);
+    m_profiledBytes = 0;
     m_table.clear();
 
     if(m_pIndex != NULL)
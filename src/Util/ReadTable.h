@@ -10,6 +10,7 @@
 #define READTABLE_H
 #include "Util.h"
 #include "SeqReader.h"
+#include "Arena.h"
 #include <map>
 
 typedef std::vector<SeqItem> ReadVector;
@@ -19,7 +20,7 @@ class ReadTable
 {
     public:
         //
-        ReadTable() : m_pIndex(NULL) {}
+        ReadTable() : m_pIndex(NULL), m_profiledBytes(0) {}
         ReadTable(std::string filename, uint32_t reader_flags = 0);
         ~ReadTable();
 
@@ -34,6 +35,11 @@ class ReadTable
 
         //
         void addRead(const SeqItem& r);
+
+        // Add a read by swapping its id into the table and moving its
+        // sequence into the arena of the table, leaving r empty
+        void takeRead(SeqItem& r);
+
         const SeqItem& getRead(size_t idx) const;
         const SeqItem& getRead(const std::string& id) const;
         size_t getReadLength(size_t idx) const;
@@ -53,10 +59,22 @@ class ReadTable
 
 
     private:
+
+        // Make room for one more read. The table is grown by swapping
+        // the reads into the new storage so they are not deep-copied.
+        void reserveForAppend();
+
+        // The sequences of the reads are stored in this arena. It is
+        // declared before m_table so it outlives the reads
+        Arena m_arena;
+
         ReadVector m_table;
         // Index of readid -> SeqItem
         // It is not build be default to save memory
         ReadIndex* m_pIndex; 
+
+        // The memory reported to the Profiler for the reads loaded from a file
+        int64_t m_profiledBytes;
 };
 
 #endif
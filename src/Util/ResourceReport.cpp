@@ -0,0 +1,148 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// ResourceReport - Machine-readable summary of the
+// resources used by a run of a subprogram
+//
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "ResourceReport.h"
+#include "Profiler.h"
+
+namespace ResourceReport
+{
+
+static std::string s_filename;
+static std::vector<std::string> s_arguments;
+static uint64_t s_startNS = 0;
+
+// Write a string as a JSON string literal
+static void writeJSONString(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for(size_t i = 0; i < str.size(); ++i)
+    {
+        if(str[i] == '"' || str[i] == '\\')
+            out << '\\';
+        out << str[i];
+    }
+    out << '"';
+}
+
+// Read the I/O counters of this process from /proc. Returns
+// false if they are not available on this system.
+static bool readProcIO(uint64_t& rchar, uint64_t& wchar, uint64_t& readBytes, uint64_t& writeBytes)
+{
+    std::ifstream in("/proc/self/io");
+    if(!in)
+        return false;
+
+    int found = 0;
+    std::string key;
+    uint64_t value;
+    while(in >> key >> value)
+    {
+        if(key == "rchar:") { rchar = value; found++; }
+        else if(key == "wchar:") { wchar = value; found++; }
+        else if(key == "read_bytes:") { readBytes = value; found++; }
+        else if(key == "write_bytes:") { writeBytes = value; found++; }
+    }
+    return found == 4;
+}
+
+//
+static double toSeconds(const timeval& tv)
+{
+    return tv.tv_sec + (double)tv.tv_usec / 1000000;
+}
+
+//
+void write(std::ostream& out)
+{
+    double wallTime = (double)(Profiler::getTimeNS() - s_startNS) / 1000000000;
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double userTime = toSeconds(usage.ru_utime);
+    double systemTime = toSeconds(usage.ru_stime);
+
+    out << "{\n";
+    out << "  \"command\": ";
+    writeJSONString(out, s_arguments.empty() ? "" : s_arguments.front());
+    out << ",\n  \"arguments\": [";
+    for(size_t i = 1; i < s_arguments.size(); ++i)
+    {
+        out << (i > 1 ? ", " : "");
+        writeJSONString(out, s_arguments[i]);
+    }
+    out << "],\n";
+
+    // The CPU utilization is the average number of busy threads
+    out << "  \"wall_time_s\": " << wallTime << ",\n";
+    out << "  \"user_time_s\": " << userTime << ",\n";
+    out << "  \"system_time_s\": " << systemTime << ",\n";
+    out << "  \"cpu_utilization\": " << (wallTime > 0 ? (userTime + systemTime) / wallTime : 0.0) << ",\n";
+
+    // ru_maxrss is in kilobytes on linux
+    out << "  \"peak_rss_bytes\": " << (uint64_t)usage.ru_maxrss * 1024 << ",\n";
+
+    uint64_t rchar = 0, wchar = 0, readBytes = 0, writeBytes = 0;
+    if(readProcIO(rchar, wchar, readBytes, writeBytes))
+    {
+        out << "  \"io\": { \"read_bytes\": " << rchar << ", \"write_bytes\": " << wchar << 
+               ", \"storage_read_bytes\": " << readBytes << ", \"storage_write_bytes\": " << writeBytes << " },\n";
+    }
+    else
+    {
+        // Fall back to the block counts, which are in units of 512 bytes
+        out << "  \"io\": { \"storage_read_bytes\": " << (uint64_t)usage.ru_inblock * 512 << 
+               ", \"storage_write_bytes\": " << (uint64_t)usage.ru_oublock * 512 << " },\n";
+    }
+
+    // Throughput of the subprograms that use the SequenceProcessFramework
+    uint64_t numSequences = 0;
+    uint64_t processNS = 0;
+    if(Profiler::getTotal("SequenceProcessFramework::sequences", numSequences) &&
+       Profiler::getTotal("SequenceProcessFramework::process", processNS) && processNS > 0)
+    {
+        out << "  \"throughput\": { \"sequences\": " << numSequences << 
+               ", \"sequences_per_s\": " << (double)numSequences / ((double)processNS / 1000000000) << " },\n";
+    }
+
+    out << "  \"profile\": ";
+    Profiler::writeJSON(out);
+    out << "}\n";
+}
+
+//
+static void writeAtExit()
+{
+    std::ofstream out(s_filename.c_str());
+    if(!out)
+    {
+        std::cerr << "Warning: could not write the resource report to " << s_filename << "\n";
+        return;
+    }
+    write(out);
+}
+
+//
+void start(const std::string& filename, int argc, char** argv)
+{
+    Profiler::enable();
+    s_filename = filename;
+    s_startNS = Profiler::getTimeNS();
+    for(int i = 0; i < argc; ++i)
+        s_arguments.push_back(argv[i]);
+    atexit(writeAtExit);
+}
+
+};
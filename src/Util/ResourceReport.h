@@ -0,0 +1,31 @@
+//-----------------------------------------------
+// Copyright 2026 agent
+// Written by agent (agent@local)
+// Released under the GPL license
+//-----------------------------------------------
+//
+// ResourceReport - Machine-readable summary of the
+// resources used by a run of a subprogram: wall and CPU
+// time, peak memory, I/O and the Profiler metrics,
+// which include the per-phase timings and the memory
+// used by the major data structures. 
+//
+#ifndef RESOURCEREPORT_H
+#define RESOURCEREPORT_H
+
+#include <string>
+#include <ostream>
+
+namespace ResourceReport
+{
+
+// Start measuring the run of the subprogram command. The report is
+// written to filename when the process exits
+void start(const std::string& filename, int argc, char** argv);
+
+// Write the report for the resources used so far
+void write(std::ostream& out);
+
+};
+
+#endif
@@ -52,6 +52,13 @@ struct SeqItem
     std::string id;
     DNAString seq;
 
+    // Exchange the contents with other without copying
+    void swap(SeqItem& other)
+    {
+        id.swap(other.id);
+        seq.swap(other.seq);
+    }
+
     void write(std::ostream& out, const std::string& meta = "") const
     {
         out << ">" << id << (meta.empty() ? "" : " ") << meta << "\n";
@@ -12,12 +12,26 @@
 #include <assert.h>
 #include "VariantIndex.h"
 
-VariantIndex::VariantIndex(const std::string& filename, const ReadTable& refTable)
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
+// Order records by position, the records being sorted all belong to one contig
+struct VariantRecordPositionCompare
+{
+    bool operator()(const VariantRecord& a, const VariantRecord& b) const
+    {
+        return a.position < b.position;
+    }
+};
+
+VariantIndex::VariantIndex(const std::string& filename, const ReadTable& refTable, int numThreads)
 {
     std::ifstream input(filename.c_str());
     std::string line;
 
-    // Parse the VCF file
+    // Read the records, they are parsed in parallel while building the index
+    StringVector lines;
     while(getline(input, line))
     {
         if(line.empty())
@@ -26,71 +40,121 @@ VariantIndex::VariantIndex(const std::string& filename, const ReadTable& refTabl
         if(line[0] == '#')
             continue;
         
-        VCFRecord record(line);
-
-        // Do not allow multi-allelic records
-        if(record.isMultiAllelic())
-        {
-            std::cerr << "Error: multi-allelic Variant found, please run vcfbreakmulti\n";
-            exit(EXIT_FAILURE);
-        }
-
-        // Convert to a minimal representation of the change
-        VariantRecord mvf = { record.refName, record.refStr, record.varStr, record.refPosition };
-        m_records.push_back(mvf);
+        lines.push_back(line);
     }
 
-    buildIndex(refTable);
+    buildIndex(refTable, lines, numThreads);
 }
 
-void VariantIndex::buildIndex(const ReadTable& refTable)
+void VariantIndex::buildIndex(const ReadTable& refTable, const StringVector& lines, int numThreads)
 {
+    // Number the contigs in the order of the reference
+    m_contigNames.resize(refTable.getCount());
     for(size_t i = 0; i < refTable.getCount(); ++i)
     {
-        const SeqItem& seq_record = refTable.getRead(i);
-        std::string chromosome = seq_record.id;
-        size_t length = seq_record.seq.length();
-        int buckets = (length / BUCKET_SIZE) + 1;
-
-        m_map[chromosome].resize(buckets);
+        m_contigNames[i] = refTable.getRead(i).id;
+        m_contigIDs[m_contigNames[i]] = i;
     }
 
-    for(size_t i = 0; i < m_records.size(); ++i)
+    // Convert to a minimal representation of the change
+    VariantRecordVector parsed(lines.size());
+    bool foundMultiAllelic = false;
+    bool foundUnknownContig = false;
+
+#if HAVE_OPENMP
+    #pragma omp parallel for num_threads(numThreads) reduction(||:foundMultiAllelic,foundUnknownContig)
+#else
+    (void)numThreads;
+#endif
+    for(int64_t i = 0; i < (int64_t)lines.size(); ++i)
     {
-        VariantIndexMap::iterator iter = m_map.find(m_records[i].reference);
-        assert(iter != m_map.end());
+        VCFRecord record(lines[i]);
 
-        int bucket_id = m_records[i].position / BUCKET_SIZE;
-        assert(bucket_id < (int)iter->second.size());
-        IntVector& bucket = iter->second[bucket_id];
-        bucket.push_back(i);
+        // Do not allow multi-allelic records
+        if(record.isMultiAllelic())
+            foundMultiAllelic = true;
+
+        parsed[i].contig_id = getContigID(record.refName);
+        if(parsed[i].contig_id < 0)
+            foundUnknownContig = true;
+        parsed[i].ref_sequence.swap(record.refStr);
+        parsed[i].alt_sequence.swap(record.varStr);
+        parsed[i].position = record.refPosition;
     }
-}
 
-VariantRecordVector VariantIndex::getNearVariants(const std::string& reference,
-                                                  int position,
-                                                  int distance) const
-{
-    VariantRecordVector out;
+    if(foundMultiAllelic)
+    {
+        std::cerr << "Error: multi-allelic Variant found, please run vcfbreakmulti\n";
+        exit(EXIT_FAILURE);
+    }
 
-    VariantIndexMap::const_iterator iter = m_map.find(reference);
-    assert(iter != m_map.end());
-    const IntVectorVector& chr_buckets = iter->second;
+    if(foundUnknownContig)
+    {
+        std::cerr << "Error: variant found on a contig that is not in the reference\n";
+        exit(EXIT_FAILURE);
+    }
 
-    int lower_index = std::max(position - distance, 0) / BUCKET_SIZE;
-    int upper_index = std::min((position + distance) / BUCKET_SIZE, (int)chr_buckets.size() - 1);
+    // Place the records into the range of their contig, keeping the input order
+    size_t numContigs = m_contigNames.size();
+    m_contigStart.assign(numContigs + 1, 0);
+    for(size_t i = 0; i < parsed.size(); ++i)
+        m_contigStart[parsed[i].contig_id + 1] += 1;
+    for(size_t i = 0; i < numContigs; ++i)
+        m_contigStart[i + 1] += m_contigStart[i];
+
+    std::vector<size_t> next(m_contigStart.begin(), m_contigStart.end() - 1);
+    m_records.resize(parsed.size());
+    for(size_t i = 0; i < parsed.size(); ++i)
+    {
+        VariantRecord& record = m_records[next[parsed[i].contig_id]++];
+        record.contig_id = parsed[i].contig_id;
+        record.ref_sequence.swap(parsed[i].ref_sequence);
+        record.alt_sequence.swap(parsed[i].alt_sequence);
+        record.position = parsed[i].position;
+    }
 
-    for(int bi = lower_index; bi <= upper_index; ++bi)
+    // Sort each contig by position. Records at the same position stay in input order.
+#if HAVE_OPENMP
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+#endif
+    for(int64_t i = 0; i < (int64_t)numContigs; ++i)
     {
-        const IntVector& bucket = chr_buckets[bi];
-        for(size_t vi = 0; vi < bucket.size(); ++vi)
-        {
-            const VariantRecord& record = m_records[bucket[vi]];
-            if(abs((int)record.position - position) < distance)
-                out.push_back(record);
-        }
+        std::stable_sort(m_records.begin() + m_contigStart[i], 
+                         m_records.begin() + m_contigStart[i + 1], 
+                         VariantRecordPositionCompare());
     }
+}
 
-    return out;
+//
+int VariantIndex::getContigID(const std::string& reference) const
+{
+    ContigIDMap::const_iterator iter = m_contigIDs.find(reference);
+    return iter != m_contigIDs.end() ? iter->second : -1;
+}
+
+VariantRecordSpan VariantIndex::getNearVariants(const std::string& reference,
+                                                int position,
+                                                int distance) const
+{
+    return getNearVariants(getContigID(reference), position, distance);
 }
 
+VariantRecordSpan VariantIndex::getNearVariants(int contigID,
+                                                int position,
+                                                int distance) const
+{
+    if(contigID < 0 || distance <= 0 || m_records.empty())
+        return VariantRecordSpan();
+
+    // Find the records with |record.position - position| < distance
+    VariantRecord lowerKey;
+    lowerKey.position = std::max(position - distance + 1, 0);
+    VariantRecord upperKey;
+    upperKey.position = position + distance - 1;
+
+    const VariantRecord* pContigBegin = &m_records[0] + m_contigStart[contigID];
+    const VariantRecord* pContigEnd = &m_records[0] + m_contigStart[contigID + 1];
+    const VariantRecord* pBegin = std::lower_bound(pContigBegin, pContigEnd, lowerKey, VariantRecordPositionCompare());
+    const VariantRecord* pEnd = std::upper_bound(pBegin, pContigEnd, upperKey, VariantRecordPositionCompare());
+    return VariantRecordSpan(pBegin, pEnd);
+}
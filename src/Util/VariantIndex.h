@@ -7,19 +7,26 @@
 // Data structure for performing proximity queries
 // against a set of variants
 //
+// The variants are stored in a single array sorted
+// by contig and position. The contigs are numbered
+// in the order of the reference so a query is a
+// hash lookup of the contig followed by a binary
+// search within its range of the array. Queries return
+// a span of the array rather than a copy of the records.
+//
 #ifndef VARIANTINDEX_H
 #define VARIANTINDEX_H
 #include "Util.h"
 #include "SeqReader.h"
 #include "VCFUtil.h"
 #include "ReadTable.h"
-#include <map>
+#include "HashMap.h"
 
 // To save space we store a vcf-like record
 // with only the required fields
 struct VariantRecord
 {
-    std::string reference;
+    int contig_id;
     std::string ref_sequence;
     std::string alt_sequence;
     size_t position;
@@ -27,33 +34,62 @@ struct VariantRecord
 
 typedef std::vector<VariantRecord> VariantRecordVector;
 typedef std::vector<int> IntVector;
-typedef std::vector<IntVector> IntVectorVector;
 
-// map from chromosome to a vector of buckets, one every 10kbp
-typedef std::map<std::string, IntVectorVector> VariantIndexMap;
+// A contiguous range of records of the index. The
+// records are owned by the index and are valid
+// for its lifetime.
+struct VariantRecordSpan
+{
+    VariantRecordSpan() : pBegin(NULL), pEnd(NULL) {}
+    VariantRecordSpan(const VariantRecord* b, const VariantRecord* e) : pBegin(b), pEnd(e) {}
+
+    size_t size() const { return pEnd - pBegin; }
+    bool empty() const { return pBegin == pEnd; }
+    const VariantRecord& operator[](size_t i) const { return pBegin[i]; }
+    const VariantRecord* begin() const { return pBegin; }
+    const VariantRecord* end() const { return pEnd; }
+
+    const VariantRecord* pBegin;
+    const VariantRecord* pEnd;
+};
+
+// map from contig name to its index in the reference
+typedef HashMap<std::string, int, StringHasher> ContigIDMap;
 
 class VariantIndex
 {
     public:
-        //
-        VariantIndex(const std::string& filename, const ReadTable& refTable);
+        // The VCF file is parsed using numThreads threads
+        VariantIndex(const std::string& filename, const ReadTable& refTable, int numThreads = 1);
+
+        // Return the variants that are within distance of the position on the reference.
+        // The contig can be given by name or by the ID returned by getContigID.
+        VariantRecordSpan getNearVariants(const std::string& reference,
+                                          int position,
+                                          int distance = 30) const;
+
+        VariantRecordSpan getNearVariants(int contigID,
+                                          int position,
+                                          int distance = 30) const;
 
-        // Return a vector of the variants that are close to the input variant
-        VariantRecordVector getNearVariants(const std::string& reference, 
-                                            int position, 
-                                            int distance = 30) const;
+        // Return the ID of the contig or -1 if it is not in the reference
+        int getContigID(const std::string& reference) const;
+        const std::string& getContigName(int contigID) const { return m_contigNames[contigID]; }
+
+        size_t getNumVariants() const { return m_records.size(); }
 
     private:
-        
-        //
-        void buildIndex(const ReadTable& refTable);
 
         //
+        void buildIndex(const ReadTable& refTable, const StringVector& lines, int numThreads);
+
+        // The records, sorted by contig and position
         VariantRecordVector m_records;
-        VariantIndexMap m_map;
 
-        // 
-        static const int BUCKET_SIZE = 10000;
+        // The records of contig i are in [m_contigStart[i], m_contigStart[i + 1])
+        std::vector<size_t> m_contigStart;
+        StringVector m_contigNames;
+        ContigIDMap m_contigIDs;
 };
 
 #endif
@@ -12,6 +12,10 @@
 // Example code was downloaded from http://www.cs.princeton.edu/~rs/strings/demo.c
 // Modified by JTS to take in a comparator and use a generic type
 //
+// The parallel version splits large jobs with an MSD radix pass
+// over the buckets of the primary sorter, then with mkqs partitioning
+// steps, and balances the jobs between threads by work stealing.
+//
 
 #ifndef MKQS_H
 #define MKQS_H
@@ -20,7 +24,9 @@
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
-#include <queue>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
 #include "MkqsThread.h"
 
 #define mkqs_swap(a, b) { T tmp = x[a]; x[a] = x[b]; x[b] = tmp; }
@@ -63,6 +69,25 @@ T* med3func(T* a, T* b, T* c, int depth, const PrimarySorter& primarySorter)
         : (vb > vc ? b : (va < vc ? a : c ) );
 }
 #define med3(a, b, c) med3func(a, b, c, depth, primarySorter)
+
+// Choose the partitioning element using the pseudo-median of nine
+// for large arrays, as in the original code by Bentley and Sedgewick.
+// This avoids the lock around the state of rand() when sorting in parallel.
+template<typename T, typename PrimarySorter>
+inline T* mkqs_pivot(T* a, int n, int depth, const PrimarySorter& primarySorter)
+{
+    T* pl = a;
+    T* pm = a + (n/2);
+    T* pn = a + (n-1);
+    if(n > 30)
+    {
+        int d = n / 8;
+        pl = med3(pl, pl + d, pl + 2*d);
+        pm = med3(pm - d, pm, pm + d);
+        pn = med3(pn - 2*d, pn - d, pn);
+    }
+    return med3(pl, pm, pn);
+}
 template<typename T, typename PrimarySorter, typename FinalSorter>
 inline void inssort(T* a, int n, int d, const PrimarySorter& primarySorter, const FinalSorter& finalSorter)
 {   
@@ -71,15 +96,11 @@ inline void inssort(T* a, int n, int d, const PrimarySorter& primarySorter, cons
     {
         for (pj = pi; pj > a; pj--) 
         {
-            // Inline strcmp: break if *(pj-1) <= *pj
+            // break if *(pj-1) <= *pj
             T elem_s = *(pj - 1);
             T elem_t = *pj;
-            const char* s = primarySorter.getChrPtr(elem_s);
-            const char* t = primarySorter.getChrPtr(elem_t);
-
-            for (s=s+d, t=t+d; *s==*t && *s!=0; s++, t++)
-                ;
-            if (*s < *t || (*s == *t && finalSorter(elem_s, elem_t)))
+            int r = primarySorter.compareSuffixes(elem_s, elem_t, d);
+            if (r < 0 || (r == 0 && finalSorter(elem_s, elem_t)))
                 break;
             mkqs_swap2(pj, pj-1);
         }
@@ -99,12 +120,7 @@ void mkqs2(T* a, int n, int depth, const PrimarySorter& primarySorter, const Fin
         return;
     }
 
-    pm = a + (n/2);
-    pn = a + (n-1);
-
-    int mid_idx = rand() % n;
-
-    pm = &a[mid_idx];
+    pm = mkqs_pivot(a, n, depth, primarySorter);
     mkqs_swap2(a, pm);
     partval = ptr2char(a);
     pa = pb = a + 1;
@@ -142,134 +158,83 @@ void mkqs2(T* a, int n, int depth, const PrimarySorter& primarySorter, const Fin
         mkqs2(a + n-r, r, depth, primarySorter, finalSorter);
 }
 
-// Parallel multikey quicksort. It performs mkqs but will
-// subdivide the array to sort into sub jobs which can be sorted using threads.
-template<typename T, typename PrimarySorter, typename FinalSorter>
-void parallel_mkqs(T* pData, int n, int numThreads, const PrimarySorter& primarySorter, const FinalSorter& finalSorter)
+// Returns true if a job should be split by a radix pass over the buckets
+// of the primary sorter. The buckets cover the next getBucketLen() symbols
+// so the job must start at a multiple of that length.
+template<typename PrimarySorter>
+inline bool mkqs_use_radix(int n, int depth, const PrimarySorter& primarySorter)
 {
-    typedef MkqsJob<T> Job;
-    typedef std::queue<Job> JobQueue;
-    Job initialJob(pData, n, 0);
-    JobQueue queue;
-    queue.push(initialJob);
-    
-    // Create the mutex that guards the queue
-    pthread_mutex_t queue_mutex;
-    int ret = pthread_mutex_init(&queue_mutex, NULL);
-    if(ret != 0)
-    {
-        std::cerr << "Mutex initialization failed with error " << ret << ", aborting" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-
-    // Calculate the threshold size for performing serial continuation of the sort. Once the chunks 
-    // are below this size, it is better to not subdivide the problem into smaller chunks
-    // to avoid the overhead of locking, adding to the queue, etc. 
-    int threshold_size = n / numThreads;
-
-    // Create the semaphore used to signal that data is ready to be processed
-    // Initial value is 1 as there is one item on the queue to start
-    sem_t queue_sem;
-    ret = sem_init( &queue_sem, PTHREAD_PROCESS_PRIVATE, 1 );
-    if(ret != 0)
-    {
-        std::cerr << "Semaphore initialization failed with error " << ret << "\n";
-        std::cerr << "You are probably running on OSX which does not provide unnamed semaphores\n";
-        exit(EXIT_FAILURE);
-    }
+    return n >= 16 * primarySorter.getNumBuckets() && depth % primarySorter.getBucketLen() == 0;
+}
 
-    // Create the semaphore indicating a thread is finished working.
-    // This semaphore is incremented by the threads in their run loop
-    // before waiting for queue items. If the thread takes an item,
-    // this semaphore is decremented. The main thread checks
-    // this semaphore after confirming the queue is empty. If this 
-    // semaphore value equals the total number of threads, 
-    // no more work can remain the the threads are cleaned up
-    sem_t done_sem;
-    ret = sem_init( &done_sem, PTHREAD_PROCESS_PRIVATE, 0 );
-    if(ret != 0)
-    {
-        std::cerr << "Semaphore initialization failed with error " << ret << "\n";
-        std::cerr << "You are probably running on OSX which does not provide unnamed semaphores\n";
-        exit(EXIT_FAILURE);
-    }
+// Calculate the bucket of each of the n elements of x for the symbols starting at depth.
+// The buckets are cached so the read table is accessed once per element in a radix pass.
+template<typename T, typename PrimarySorter>
+void mkqs_compute_buckets(T* x, int n, int depth, const PrimarySorter& primarySorter, uint32_t* pBuckets)
+{
+    int level = depth / primarySorter.getBucketLen();
+    for(int i = 0; i < n; ++i)
+        pBuckets[i] = primarySorter.getBucket(x[i], level);
+}
 
-    // Create and start the threads
-    MkqsThread<T, PrimarySorter, FinalSorter>* threads[numThreads];
-    for(int i = 0; i < numThreads; ++i)
+// Permute the elements of x in place so they are ordered by their bucket in pBuckets.
+// The number of elements in each bucket is returned in counts.
+template<typename T, typename PrimarySorter>
+void mkqs_radix_partition(T* x, int n, const PrimarySorter& primarySorter, uint32_t* pBuckets, std::vector<int>& counts)
+{
+    int numBuckets = primarySorter.getNumBuckets();
+    counts.assign(numBuckets, 0);
+    for(int i = 0; i < n; ++i)
+        counts[pBuckets[i]]++;
+
+    // The next unsorted position and the end of each bucket
+    std::vector<int> next(numBuckets);
+    std::vector<int> end(numBuckets);
+    int sum = 0;
+    for(int b = 0; b < numBuckets; ++b)
     {
-        threads[i] = new MkqsThread<T, PrimarySorter, FinalSorter>(i, &queue, &queue_mutex, &queue_sem, &done_sem, threshold_size, &primarySorter, &finalSorter);   
-        threads[i]->start();
+        next[b] = sum;
+        sum += counts[b];
+        end[b] = sum;
     }
 
-    // Check for the end condition
-    bool done = false;
-    while(!done)
+    // Cycle the elements into place. The cached buckets move with their elements.
+    for(int b = 0; b < numBuckets; ++b)
     {
-        sleep(1);
-
-        // Check if the queue is empty
-        // If it is and all threads are finished working (all have posted to
-        // the done semaphore), then the threads can be cleaned up.
-        pthread_mutex_lock(&queue_mutex);
-        if(queue.empty())
+        while(next[b] < end[b])
         {
-            int semval;
-            sem_getvalue(&done_sem, &semval);
-            if(semval == numThreads)
-                done = true;
+            int i = next[b];
+            uint32_t displacedBucket = pBuckets[i];
+            if(displacedBucket != (uint32_t)b)
+            {
+                T displaced = x[i];
+                while(displacedBucket != (uint32_t)b)
+                {
+                    int j = next[displacedBucket]++;
+                    std::swap(displaced, x[j]);
+                    std::swap(displacedBucket, pBuckets[j]);
+                }
+                x[i] = displaced;
+                pBuckets[i] = displacedBucket;
+            }
+            next[b]++;
         }
-        pthread_mutex_unlock(&queue_mutex);
-    }
-
-    // Signal all the threads to stop, then post to the semaphore they are waiting on
-    // All threads will pick up the stop request after the posts and call pthread exit
-    for(int i = 0; i < numThreads; ++i)
-    {
-        threads[i]->stop();
-    }
-
-    for(int i = 0; i < numThreads; ++i)
-    {
-        sem_post(&queue_sem);
-    }
-
-    // Join and destroy the threads
-    for(int i = 0; i < numThreads; ++i)
-    {
-        threads[i]->join();
-        delete threads[i];
-    }
-
-    // Destroy the semaphore
-    sem_destroy(&queue_sem);
-    sem_destroy(&done_sem);
-
-    // Destroy the queue mutex
-    ret = pthread_mutex_destroy(&queue_mutex);
-    if(ret != 0)
-    {
-        std::cerr << "Mutex destruction failed with error " << ret << ", aborting" << std::endl;
-        exit(EXIT_FAILURE);
     }
 }
 
-//
-// Perform a partial sort of the data using the mkqs algorithm
-// Iterative sort jobs are created and added to pQueue which is
-// protected by pQueueMutex. After addition, pQueueSem is updated.
-//
+// Perform one partitioning step of the mkqs algorithm on the job.
+// The parts that need further sorting are returned in outJobs, which must
+// have space for 3 jobs. Returns the number of jobs created.
 template<typename T, class PrimarySorter, class FinalSorter>
-void parallel_mkqs_process(MkqsJob<T>& job, 
-                           std::queue<MkqsJob<T> >* pQueue, 
-                           pthread_mutex_t* pQueueMutex, 
-                           sem_t* pQueueSem,
-                           const PrimarySorter& primarySorter, 
-                           const FinalSorter& finalSorter)
+int mkqs_partition(MkqsJob<T>& job, 
+                   MkqsJob<T>* outJobs,
+                   const PrimarySorter& primarySorter, 
+                   const FinalSorter& finalSorter)
 {
     T* a = job.pData;
     int n = job.n;
     int depth = job.depth;
+    int numJobs = 0;
     
     int r, partval;
     T *pa, *pb, *pc, *pd, *pm, *pn, t;
@@ -277,15 +242,10 @@ void parallel_mkqs_process(MkqsJob<T>& job,
     if(n < 10) 
     {
         inssort(a, n, depth, primarySorter, finalSorter);
-        return;
+        return 0;
     }
     
-    pm = a + (n/2);
-    pn = a + (n-1);
-
-    int mid_idx = rand() % n;
-
-    pm = &a[mid_idx];
+    pm = mkqs_pivot(a, n, depth, primarySorter);
     mkqs_swap2(a, pm);
     partval = ptr2char(a);
     pa = pb = a + 1;
@@ -311,22 +271,12 @@ void parallel_mkqs_process(MkqsJob<T>& job,
     r = std::min(pa-a, pb-pa);    vecswap2(a,  pb-r, r);
     r = std::min(pd-pc, pn-pd-1); vecswap2(pb, pn-r, r);
 
-    // Lock the queue and push new items if necessary
-    // If new items are added to the queue, the semaphore is posted to
-    pthread_mutex_lock(pQueueMutex);
-
     if ((r = pb-pa) > 1)
-    {
-        MkqsJob<T> job(a, r, depth);
-        pQueue->push(job);
-        sem_post(pQueueSem);
-    }
+        outJobs[numJobs++] = MkqsJob<T>(a, r, depth);
     
     if (ptr2char(a + r) != 0)
     {
-        MkqsJob<T> job(a + r, pa-a + pn-pd-1, depth + 1);
-        pQueue->push(job);
-        sem_post(pQueueSem);
+        outJobs[numJobs++] = MkqsJob<T>(a + r, pa-a + pn-pd-1, depth + 1);
     }
     else
     {
@@ -336,14 +286,105 @@ void parallel_mkqs_process(MkqsJob<T>& job,
     }
 
     if ((r = pd-pc) > 1)
+        outJobs[numJobs++] = MkqsJob<T>(a + n-r, r, depth);
+    return numJobs;
+}
+
+// Arguments for a thread computing the buckets of a slice of the input
+template<typename T, typename PrimarySorter>
+struct MkqsBucketSlice
+{
+    T* x;
+    int n;
+    const PrimarySorter* pPrimarySorter;
+    uint32_t* pBuckets;
+
+    static void* run(void* obj)
+    {
+        MkqsBucketSlice* pSlice = reinterpret_cast<MkqsBucketSlice*>(obj);
+        mkqs_compute_buckets(pSlice->x, pSlice->n, 0, *pSlice->pPrimarySorter, pSlice->pBuckets);
+        return NULL;
+    }
+};
+
+// Parallel multikey quicksort. The array is first split by a radix pass
+// whose bucket computation is shared between the threads. The buckets are
+// then sorted by the worker threads, which split large jobs further and
+// steal jobs from each other when they run out of work.
+template<typename T, typename PrimarySorter, typename FinalSorter>
+void parallel_mkqs(T* pData, int n, int numThreads, const PrimarySorter& primarySorter, const FinalSorter& finalSorter)
+{
+    typedef MkqsJob<T> Job;
+    typedef MkqsThread<T, PrimarySorter, FinalSorter> Worker;
+
+    // Jobs below this size are sorted serially. The jobs are much smaller
+    // than an equal share of the input so that stealing can balance the load.
+    int threshold_size = std::max(n / (numThreads * 16), 1024);
+
+    MkqsSharedState<T> state(numThreads, threshold_size);
+    std::vector<Worker*> threads(numThreads);
+    for(int i = 0; i < numThreads; ++i)
+        threads[i] = new Worker(i, &state, &primarySorter, &finalSorter);
+
+    if(mkqs_use_radix(n, 0, primarySorter))
     {
-        MkqsJob<T> job(a + n-r, r, depth);
-        pQueue->push(job);
-        sem_post(pQueueSem);
+        // Compute the buckets of the initial radix pass in parallel
+        std::vector<uint32_t> buckets(n);
+        std::vector<MkqsBucketSlice<T, PrimarySorter> > slices(numThreads);
+        std::vector<pthread_t> bucketThreads(numThreads);
+        int sliceSize = (n + numThreads - 1) / numThreads;
+        for(int i = 0; i < numThreads; ++i)
+        {
+            int start = std::min(i * sliceSize, n);
+            slices[i].x = pData + start;
+            slices[i].n = std::min(sliceSize, n - start);
+            slices[i].pPrimarySorter = &primarySorter;
+            slices[i].pBuckets = &buckets[start];
+            int ret = pthread_create(&bucketThreads[i], 0, &MkqsBucketSlice<T, PrimarySorter>::run, &slices[i]);
+            if(ret != 0)
+            {
+                std::cerr << "Thread creation failed with error " << ret << ", aborting" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        for(int i = 0; i < numThreads; ++i)
+            pthread_join(bucketThreads[i], NULL);
+
+        std::vector<int> counts;
+        mkqs_radix_partition(pData, n, primarySorter, &buckets[0], counts);
+
+        // Deal the buckets out to the workers
+        T* pBucket = pData;
+        int nextWorker = 0;
+        for(size_t i = 0; i < counts.size(); ++i)
+        {
+            int count = counts[i];
+            if(count > 1)
+            {
+                if(primarySorter.isBucketDegenerate(i))
+                    std::sort(pBucket, pBucket + count, finalSorter);
+                else
+                    threads[nextWorker++ % numThreads]->push(Job(pBucket, count, primarySorter.getBucketLen()));
+            }
+            pBucket += count;
+        }
     }
+    else if(n > 1)
+    {
+        threads[0]->push(Job(pData, n, 0));
+    }
+
+    // Start the threads and wait for them to sort the jobs
+    for(int i = 0; i < numThreads; ++i)
+        threads[i]->start();
 
-    // Unlock the mutex
-    pthread_mutex_unlock(pQueueMutex);
+    for(int i = 0; i < numThreads; ++i)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    assert(state.numPending == 0);
 }
-#endif
 
+#endif